@@ -1,50 +1,298 @@
 #pragma once
 
+#include "domain/BootSequence.h"
 #include "domain/Clock.h"
+#include "domain/PoiAlert.h"
+#include "domain/PoiIndex.h"
+#include "domain/Route.h"
+#include "domain/RouteMatcher.h"
+#include "domain/TimeZoneIndex.h"
 #include "domain/Trip.h"
+#include "domain/UpdateRatePolicy.h"
+#include "hardware/FlashFileSource.h"
 #include "hardware/Gnss.h"
-#include "hardware/OLED.h"
+#include "hardware/RecordStore.h"
+#include "hardware/Telemetry.h"
+#include "hardware/Trace.h"
+#include "hardware/TripHistory.h"
 #include "ui/Frame.h"
+#include "ui/GraphView.h"
 #include "ui/Input.h"
+#include "ui/Layout.h"
 #include "ui/Mode.h"
 #include "ui/Renderer.h"
+#include "ui/TrackMap.h"
 
 class App {
 private:
-  OLED     oled;
-  Input    input;
-  Gnss     gnss;
-  Mode     mode;
-  Trip     trip;
-  Clock    clock;
-  Renderer renderer;
+  Display          display;
+  Input            input;
+  Gnss             gnss;
+  UpdateRatePolicy ratePolicy;
+  Mode             mode;
+  Trip             trip;
+  Clock            clock;
+  Renderer         renderer;
+  RecordStore      tripStore;
+  TripHistory      history;
+  Telemetry        telemetry;
+  TrackMap         trackMap;
+  GraphView        graphView;
+  BootSequence     boot;
+  Layout           layout;
+
+  FlashFileSource           poiSource;
+  PoiIndex<FlashFileSource> poiIndex;
+  PoiAlert                  poiAlert;
+  Route                     route;
+  RouteMatcher              routeMatcher;
+
+  FlashFileSource                tzSource;
+  TimeZoneIndex<FlashFileSource> tzIndex;
+
+  unsigned long lastRenderMillis  = 0;
+  unsigned long lastSaveMillis    = 0;
+  uint64_t      savedMovingTimeMs = 0;
+  bool          isTotalsDirty     = false; // 保存していない変更がある
+  bool          isSaveUrgent      = false; // リセットした。間隔を待たずに保存する
+
+  uint32_t    historyCursor = 0; // 履歴で何件前を表示しているか
+  RideSummary historyRide;
+  bool        hasHistoryRide = false;
+  uint8_t     layoutPage     = 0;
 
 public:
+  App()
+      : tripStore(Config::Storage::TRIP_PATHS[0], Config::Storage::TRIP_PATHS[1],
+                  Config::Storage::TRIP_VERSION),
+        history(Config::History::DATA_PATH, Config::History::KEY_PATH),
+        poiIndex(poiSource), routeMatcher(route), tzIndex(tzSource) {}
+
+  // 画面だけを用意して起動中の表示を出す。残りの初期化は update() で 1 段階ずつ進める
   void begin() {
-    oled.begin();
-    input.begin();
-    gnss.begin();
-    trip.begin();
+    Serial.begin(Config::Trace::SERIAL_BAUD);
+    Trace::begin();
+    boot.begin(millis());
+    trip.laps.setDefaultAuto(); // RESET でいつでも手動でも区切れる
+    stepBoot();
   }
 
   void update() {
+    TraceScope trace(TraceEvent::APP_UPDATE);
+    if (!boot.isReady()) {
+      handleSerial();
+      stepBoot();
+      return;
+    }
+
     handleInput();
+    handleSerial();
 
-    gnss.update();
-    const SpNavData &navData = gnss.getNavData();
+    const bool       isUpdated = gnss.update();
+    const SpNavData &navData   = gnss.getNavData();
 
-    trip.update(navData, millis());
+    const unsigned long now = millis();
+    Trace::enter(TraceEvent::APP_TRIP);
+    trip.update(navData, now);
     clock.update(navData);
+    if (0 < trip.stopwatch.getMovingTimeMs()) trip.markStart(clock.getEpoch());
+    Trace::leave(TraceEvent::APP_TRIP);
+    if (isUpdated && navData.posFixMode != FixInvalid) {
+      TraceScope navigation(TraceEvent::APP_NAVIGATION);
+      boot.markFix(now);
+      checkPoi(navData, now);
+      routeMatcher.update(navData.latitude, navData.longitude);
+      if (tzIndex.update(navData.latitude, navData.longitude, now)) {
+        clock.setZone(tzIndex.getZone());
+      }
+    }
+
+    const float speedKmh = trip.speedEstimator.get();
+    Trace::enter(TraceEvent::APP_RATE);
+    gnss.setUpdateIntervalMs(ratePolicy.update(speedKmh, trip.speedEstimator.getAccel(), now));
+    Trace::leave(TraceEvent::APP_RATE);
+
+    Trace::enter(TraceEvent::APP_SAVE);
+    saveTotals(now);
+    Trace::leave(TraceEvent::APP_SAVE);
+
+    Trace::enter(TraceEvent::APP_GRAPH);
+    graphView.update(speedKmh, navData.altitude, navData.posFixMode != FixInvalid, now);
+    Trace::leave(TraceEvent::APP_GRAPH);
+
+    Trace::enter(TraceEvent::APP_TELEMETRY);
+    telemetry.update(trip, clock, navData, now);
+    telemetry.pump(Serial);
+    Trace::leave(TraceEvent::APP_TELEMETRY);
 
-    Frame frame(trip, clock, mode.get(), (SpFixMode)navData.posFixMode);
-    renderer.render(oled, frame);
+    if (now - lastRenderMillis < Config::DISPLAY_UPDATE_INTERVAL_MS) return;
+    lastRenderMillis = now;
+
+    TraceScope render(TraceEvent::APP_RENDER);
+    if (mode.get() == Mode::ID::MAP) trackMap.update(trip.breadcrumb);
+    Frame::Views views;
+    views.trackMap     = &trackMap;
+    views.graphView    = &graphView;
+    views.routeMatcher = &routeMatcher;
+    views.ride         = hasHistoryRide ? &historyRide : nullptr;
+    views.rideNumber   = historyCursor + 1;
+    views.layout       = &layout;
+    views.layoutPage   = layoutPage;
+    if (poiAlert.isShowing(now)) views.poiAlert = &poiAlert;
+    Frame frame(trip, clock, mode.get(), (SpFixMode)navData.posFixMode, views);
+    renderer.render(display, frame);
   }
 
 private:
+  // 起動処理を 1 段階進めて起動中の表示を描く。測位を始めた後は、残りの段階の合間に最初の測位を待つ
+  void stepBoot() {
+    const BootSequence::Stage stage = boot.get();
+    const uint16_t            arg   = static_cast<uint16_t>(stage);
+    const unsigned long       start = micros();
+    Trace::enter(TraceEvent::APP_BOOT, arg);
+    const bool isOk = runBootStage(stage);
+    Trace::leave(TraceEvent::APP_BOOT, arg);
+    boot.finish(isOk, micros() - start, millis());
+
+    if (boot.isOk(BootSequence::Stage::GNSS) && gnss.update() &&
+        gnss.getNavData().posFixMode != FixInvalid) {
+      boot.markFix(millis());
+    }
+
+    if (!boot.isOk(BootSequence::Stage::PANEL)) return;
+    Frame frame(boot);
+    renderer.render(display, frame);
+    boot.markFrame(millis());
+  }
+
+  bool runBootStage(BootSequence::Stage stage) {
+    switch (stage) {
+    case BootSequence::Stage::PANEL:
+      return display.begin();
+    case BootSequence::Stage::CLOCK:
+      return clock.begin(); // RTC が時刻を保っていれば、測位を待たずに時計を出せる
+    case BootSequence::Stage::GNSS:
+      return gnss.begin();
+    case BootSequence::Stage::BUTTONS:
+      input.begin();
+      return true;
+    case BootSequence::Stage::TOTALS: {
+      trip.begin();
+      Trip::Totals totals;
+      if (!tripStore.load(totals)) return false; // 保存したものがなければ 0 から数える
+      trip.restore(totals);
+      savedMovingTimeMs = totals.movingTimeMs;
+      return true;
+    }
+    case BootSequence::Stage::HISTORY:
+      return history.begin();
+    case BootSequence::Stage::POI:
+      // 索引がなければ通知しないだけ
+      return poiSource.begin(Config::Poi::PATH) && poiIndex.open();
+    case BootSequence::Stage::ROUTE: {
+      FlashFileSource routeSource;
+      return routeSource.begin(Config::Route::PATH) && route.load(routeSource);
+    }
+    case BootSequence::Stage::TIMEZONE:
+      // 索引がなければ Config::Time::DEFAULT_OFFSET_MIN のまま
+      return tzSource.begin(Config::TimeZone::PATH) && tzIndex.open();
+    case BootSequence::Stage::LAYOUT:
+      return loadLayout();
+    default:
+      return true;
+    }
+  }
+
+  // 画面の定義はここで一度だけ解釈し、描画では解釈済みの表を使う
+  bool loadLayout() {
+    layoutPage = 0;
+    FlashFileSource source;
+    if (source.begin(Config::Layout::PATH)) return layout.load(source);
+    layout.clear();
+    return false;
+  }
+
+  // リセットは電源を切られる前にすぐ保存する。走行中の積算は一定間隔で保存し、
+  // Flash の書き換え回数を抑える。保存に失敗したら次の間隔でやり直す
+  void saveTotals(unsigned long now) {
+    if (!isSaveUrgent && now - lastSaveMillis < Config::Storage::SAVE_INTERVAL_MS) return;
+    isSaveUrgent   = false;
+    lastSaveMillis = now;
+
+    const uint64_t movingTimeMs = trip.stopwatch.getMovingTimeMs();
+    if (movingTimeMs != savedMovingTimeMs) isTotalsDirty = true;
+    if (!isTotalsDirty || !tripStore.save(trip.getTotals())) return;
+    savedMovingTimeMs = movingTimeMs;
+    isTotalsDirty     = false;
+  }
+
+  // 保存する積算値を変えたとき
+  void markTotalsReset() {
+    isTotalsDirty = true;
+    isSaveUrgent  = true;
+  }
+
+  void checkPoi(const SpNavData &navData, unsigned long now) {
+    if (!poiIndex.isReady()) return;
+
+    PoiIndex<FlashFileSource>::Match match = PoiIndex<FlashFileSource>::Match();
+    const bool isFound = poiIndex.findNearest(navData.latitude, navData.longitude,
+                                              Config::Poi::REARM_RADIUS_M, match);
+    poiAlert.update(isFound, match.index, match.record, match.distanceM, now);
+  }
+
+  // 走行をリセットする前に、その要約を履歴に残す
+  void archiveTrip() {
+    if (trip.odometer.getTotalMm() == 0) return;
+    history.append(trip.getSummary());
+  }
+
+  void showHistory(uint32_t cursor) {
+    historyCursor  = cursor;
+    hasHistoryRide = history.getRecent(cursor, historyRide);
+  }
+
+  // シリアルで DUMP_COMMAND を受けたらその時点までのトレースを、REPORT_COMMAND を受けたら
+  // 起動の所要時間を書き出す。RELOAD_COMMAND では書き換えた画面の定義を読み直す
+  void handleSerial() {
+    while (0 < Serial.available()) {
+      const int command = Serial.read();
+      if (command == Config::Trace::DUMP_COMMAND) {
+        beginText();
+        Trace::dump(Serial);
+        endText();
+      }
+      if (command == Config::Boot::REPORT_COMMAND) {
+        beginText();
+        boot.report(Serial);
+        endText();
+      }
+      if (command == Config::Gnss::REPORT_COMMAND) {
+        beginText();
+        gnss.report(Serial);
+        endText();
+      }
+      if (command == Config::Layout::RELOAD_COMMAND && boot.isReady()) loadLayout();
+    }
+  }
+
+  // テレメトリと同じシリアルに文字で書くので、送りかけのフレームを送り切ってから行の頭で始め、
+  // 最後に 0 を送って受信側の COBS の区切りを揃え直す
+  void beginText() {
+    telemetry.flush(Serial);
+    Serial.print("\n");
+  }
+
+  void endText() {
+    static const uint8_t DELIMITER = 0;
+    if (Config::Telemetry::ENABLED) Serial.write(&DELIMITER, 1);
+  }
+
   void handleInput() {
     switch (input.update()) {
     case Input::ID::SELECT:
       mode.next();
+      if (mode.get() == Mode::ID::HISTORY) showHistory(0);
       return;
     case Input::ID::PAUSE:
       trip.pause();
@@ -53,9 +301,32 @@ private:
       switch (mode.get()) {
       case Mode::ID::SPD_TIME:
         trip.resetTime();
+        markTotalsReset();
         break;
       case Mode::ID::AVG_ODO:
+        archiveTrip();
         trip.resetOdometerAndMovingTime();
+        markTotalsReset();
+        break;
+      case Mode::ID::HISTORY:
+        if (0 < history.getCount()) showHistory((historyCursor + 1) % history.getCount());
+        break;
+      case Mode::ID::TRIP_A:
+        trip.resetCounter(Trip::Counter::TRIP_A);
+        markTotalsReset();
+        break;
+      case Mode::ID::TRIP_B:
+        trip.resetCounter(Trip::Counter::TRIP_B);
+        markTotalsReset();
+        break;
+      case Mode::ID::LAP:
+        trip.lap();
+        break;
+      case Mode::ID::MAP:
+        trackMap.nextZoom();
+        break;
+      case Mode::ID::PAGE:
+        if (0 < layout.getPageCount()) layoutPage = (layoutPage + 1) % layout.getPageCount();
         break;
       default:
         break;
@@ -9,11 +9,21 @@ constexpr unsigned long DISPLAY_UPDATE_INTERVAL_MS = 100;
 
 namespace Time {
 
-constexpr int JST_OFFSET       = 9;
-constexpr int VALID_YEAR_START = 2025;
+constexpr int DEFAULT_OFFSET_MIN = 9 * 60; // 時間帯がわかるまでは日本時間
+constexpr int VALID_YEAR_START   = 2025;
 
 } // namespace Time
 
+namespace Clock {
+
+constexpr int32_t STEP_MS           = 1000;    // RTC がこれよりずれていたらすぐに合わせ直す
+constexpr int32_t DRIFT_SPAN_MS     = 3600000; // この間隔で RTC を合わせ直し、ずれから進み方を測る
+constexpr int32_t DRIFT_MIN_SPAN_MS = 600000;  // これより短い間隔のずれは進み方の推定に使わない
+constexpr float   DRIFT_ALPHA       = 0.5f;    // 進み方の推定の平滑化係数
+constexpr float   MAX_DRIFT_PPM     = 500.0f;  // これを超える推定は時刻の飛びとみなして捨てる
+
+} // namespace Clock
+
 namespace Pin {
 
 constexpr int BTN_A    = PIN_D09;
@@ -30,6 +40,18 @@ constexpr int ADDRESS = 0x3C;
 
 } // namespace OLED
 
+// 4 桁の 7 セグメント表示器 (アノードコモン)。セグメントは 74HC595 で送り、桁を順に点灯させる
+namespace SevenSeg {
+
+constexpr int          SDI          = PIN_D02;
+constexpr int          RCLK         = PIN_D08;
+constexpr int          SRCLK        = PIN_D07;
+constexpr int          DIGIT_PINS[] = {PIN_D10, PIN_D11, PIN_D12, PIN_D13}; // HIGH で点灯
+constexpr int          COLON_PIN    = PIN_D03;
+constexpr unsigned int MULTIPLEX_US = 2000; // 1 桁あたり。4 桁で 125 Hz
+
+} // namespace SevenSeg
+
 namespace Renderer {
 
 constexpr int16_t HEADER_HEIGHT    = 12;
@@ -37,13 +59,167 @@ constexpr int16_t HEADER_TEXT_SIZE = 1;
 
 } // namespace Renderer
 
+namespace Layout {
+
+constexpr const char *PATH           = "layout.txt"; // 利用者が定義する画面。書式は ui/Layout.h
+constexpr size_t      MAX_BYTES      = 1024;
+constexpr size_t      MAX_PAGES      = 4;
+constexpr size_t      MAX_PAGE_ITEMS = 6;
+constexpr size_t      MAX_ITEMS      = MAX_PAGES * MAX_PAGE_ITEMS;
+constexpr int         MAX_TEXT_SIZE  = 4;
+constexpr char        RELOAD_COMMAND = 'l'; // シリアルでこの文字を受けたら読み直す
+
+} // namespace Layout
+
+namespace MapView {
+
+constexpr int SCALES_M_PER_PX[] = {2, 5, 10, 25, 50}; // RESET で順に切り替える
+constexpr int MARGIN_PX         = 6;                  // 現在地がここまで端に寄ったら中心を移す
+
+} // namespace MapView
+
+// 速度と高度の推移グラフ。1 列あたり COLUMN_MS で、画面幅 128 列で約 5 分
+namespace Graph {
+
+constexpr unsigned long COLUMN_MS     = 2500;
+constexpr int16_t       SPEED_SCALE   = 10;  // 0.1 km/h 単位で保持する
+constexpr int16_t       SPEED_STEP    = 100; // 表示範囲はこの単位で広げ縮めする (10 km/h)
+constexpr int16_t       ALTITUDE_STEP = 10;  // 1 m 単位で保持し、10 m 単位で表示範囲を決める
+
+} // namespace Graph
+
 constexpr float MIN_MOVING_SPEED_KMH = 0.001f;
 
+namespace SpeedEstimator {
+
+constexpr float         ALPHA                 = 0.8f;
+constexpr float         BETA                  = 0.6f;
+constexpr float         MAX_ACCEL_KMH_PER_S   = 10.0f;
+constexpr float         MAX_EXTRAPOLATION_KMH = 5.0f;
+constexpr unsigned long MAX_EXTRAPOLATION_MS  = 1500;
+constexpr unsigned long MAX_SAMPLE_GAP_MS     = 3000;
+
+} // namespace SpeedEstimator
+
+// 直近 10 秒 / 1 分 / 5 分の平均速度 (バケット幅 x バケット数)
+namespace RollingSpeed {
+
+constexpr unsigned long SHORT_BUCKET_MS = 1000;
+constexpr size_t        SHORT_BUCKETS   = 11;
+constexpr unsigned long MID_BUCKET_MS   = 1000;
+constexpr size_t        MID_BUCKETS     = 61;
+constexpr unsigned long LONG_BUCKET_MS  = 5000;
+constexpr size_t        LONG_BUCKETS    = 61;
+
+} // namespace RollingSpeed
+
+// 0 - 64 km/h を 2 km/h 幅で数える。最後のビンはそれ以上の速度も含む
+namespace SpeedHistogram {
+
+constexpr float  BIN_KMH     = 2.0f;
+constexpr size_t BINS        = 32;
+constexpr float  ZONES_KMH[] = {0.0f, 15.0f, 25.0f, 35.0f}; // 各ゾーンの下限
+
+} // namespace SpeedHistogram
+
+namespace Lap {
+
+constexpr size_t CAPACITY          = 256;    // 超えたら古いラップから上書きする
+constexpr float  CROSSING_RADIUS_M = 20.0f;  // 地点ラップ: この距離まで近づいたら 1 周
+constexpr float  CROSSING_LEAVE_M  = 100.0f; // 一度この距離以上離れてから判定を始める
+
+// 自動ラップ。距離、時間、地点の順に最初に有効なものを使い、どれもなければ手動のみ
+constexpr uint32_t AUTO_DISTANCE_M = 5000;  // 0 なら使わない
+constexpr uint32_t AUTO_TIME_MS    = 0;     // 0 なら使わない
+constexpr bool     AUTO_AT_GATE    = false; // 最初の測位点を通るたびに区切る
+
+} // namespace Lap
+
+namespace Breadcrumb {
+
+constexpr size_t CAPACITY    = 1024;
+constexpr float  TOLERANCE_M = 3.0f;  // 初期の許容誤差。容量が埋まるたびに倍にする
+constexpr size_t LOW_WATER   = 768;   // 間引き後にこの点数以下になるまで許容誤差を上げる
+
+} // namespace Breadcrumb
+
+namespace Gradient {
+
+constexpr float  SAMPLE_M   = 5.0f;   // この距離ごとに高度の平均を 1 点として回帰に加える
+constexpr float  WINDOW_M   = 150.0f; // 回帰に使う区間の長さ
+constexpr size_t CAPACITY   = 40;     // WINDOW_M / SAMPLE_M + 1 より多く
+constexpr float  MIN_SPAN_M = 50.0f;  // 区間がこれより短い間は勾配を出さない
+constexpr float  NOISE_K    = 3.0f;   // ヒステリシス = 区間平均の標準誤差 x NOISE_K
+constexpr float  MIN_HYST_M = 1.0f;
+constexpr float  MAX_HYST_M = 5.0f;
+
+} // namespace Gradient
+
+namespace Poi {
+
+constexpr const char   *PATH           = "poi.bin"; // tools/poi で作った索引
+constexpr float         ALERT_RADIUS_M = 150.0f;
+constexpr float         REARM_RADIUS_M = 300.0f; // 一度離れるまで同じ地点は再通知しない
+constexpr unsigned long ALERT_SHOW_MS  = 10000;
+
+} // namespace Poi
+
+namespace Route {
+
+constexpr const char *PATH         = "route.bin"; // tools/route で作った経路
+constexpr size_t      CAPACITY     = 4096;        // 経路の点数の上限
+constexpr size_t      GRID_CELLS   = 1024;        // 再捕捉用の格子のセル数の上限
+constexpr size_t      WINDOW_BACK  = 2;           // 前回の線分から探す範囲
+constexpr size_t      WINDOW_AHEAD = 32;
+constexpr float       OFF_COURSE_M = 50.0f;       // これより離れたらコース外
+constexpr float       ON_COURSE_M  = 25.0f;       // コース外からはここまで近づいたら復帰
+
+} // namespace Route
+
+namespace TimeZone {
+
+constexpr const char   *PATH       = "tz.bin"; // tools/tz で作った時間帯の索引
+constexpr unsigned long RECHECK_MS = 60000;    // 境界を含むセルにいる間は、この間隔で引き直す
+
+} // namespace TimeZone
+
+namespace History {
+
+constexpr const char *DATA_PATH = "history.dat";
+constexpr const char *KEY_PATH  = "history.key";
+constexpr uint32_t    CAPACITY  = 16384; // 512 KB。毎日走っても 40 年以上もつ。満杯なら追記しない
+
+} // namespace History
+
+namespace Storage {
+
+constexpr const char   *TRIP_PATHS[]     = {"trip_a.bin", "trip_b.bin"};
+constexpr uint16_t      TRIP_VERSION     = 5; // Trip::Totals の構成を変えたら上げる
+constexpr unsigned long SAVE_INTERVAL_MS = 60000;
+
+} // namespace Storage
+
+namespace Gnss {
+
+constexpr unsigned long UPDATE_INTERVALS_MS[]  = {1000, 500, 200, 100}; // 1, 2, 5, 10 Hz
+constexpr float         RATE_MIN_KMH[]         = {0.0f, 5.0f, 15.0f, 30.0f};
+constexpr float         RATE_HYSTERESIS_KMH    = 2.0f;
+constexpr float         RATE_ACCEL_KMH_PER_S   = 3.0f; // これを超える加減速中は最高レート
+constexpr unsigned long RATE_DOWNSHIFT_HOLD_MS = 5000;
+constexpr unsigned long STABLE_FIX_MS          = 60000; // 3D 測位がこの時間続いたら LOW_POWER へ
+constexpr unsigned long FIX_LOST_MS            = 5000;  // 3D 測位を失ってこの時間で元に戻す
+constexpr unsigned long RETRY_MS               = 5000;  // 切り替えに失敗したらこの間隔でやり直す
+constexpr char          REPORT_COMMAND         = 'g'; // シリアルでこの文字を受けたら統計を書き出す
+
+} // namespace Gnss
+
 namespace Odometer {
 
-constexpr float MIN_ABS   = 1e-6f;
-constexpr float MIN_DELTA = 0.002f;
-constexpr float MAX_DELTA = 1.0f;
+constexpr double EARTH_RADIUS_M = 6378137.0; // WGS84 赤道半径
+constexpr float  MIN_ABS        = 1e-6f;
+constexpr float  MIN_STEP_M     = 2.0f;
+constexpr float  MAX_STEP_M     = 1000.0f;
+constexpr double REANCHOR_DEG   = 0.1; // 約 11 km ごとに origin を取り直す
 
 } // namespace Odometer
 
@@ -53,4 +229,28 @@ constexpr unsigned long SIMULTANEOUS_DELAY_MS = 50;
 
 } // namespace Input
 
+namespace Trace {
+
+constexpr bool     ENABLED      = true;
+constexpr size_t   CAPACITY     = 512;    // 2 のべき乗。8 バイトずつなので 4 KB
+constexpr uint32_t CPU_MHZ      = 32;     // LowPower.clockMode(CLOCK_MODE_32MHz) に合わせる
+constexpr long     SERIAL_BAUD  = 115200;
+constexpr char     DUMP_COMMAND = 't';    // シリアルでこの文字を受けたら記録を書き出す
+
+} // namespace Trace
+
+namespace Boot {
+
+constexpr char REPORT_COMMAND = 'b'; // シリアルでこの文字を受けたら起動の所要時間を書き出す
+
+} // namespace Boot
+
+namespace Telemetry {
+
+constexpr bool          ENABLED     = true;
+constexpr unsigned long INTERVAL_MS = 200; // 1 フレーム 50 バイトなので 5 Hz で 250 B/s
+constexpr size_t        QUEUE_BYTES = 256; // 送れない分はフレームごと捨てる
+
+} // namespace Telemetry
+
 } // namespace Config
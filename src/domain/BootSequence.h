@@ -0,0 +1,147 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// 起動処理を段階に分け、1 回の呼び出しで 1 段階ずつ進める。その合間に画面を描けるので、
+// 画面の準備ができた時点で起動中の表示を出せる。段階ごとの所要時間と、起動から最初の画面・
+// 最初の測位までの時間を残す
+class BootSequence {
+public:
+  // 実行する順。測位は時間がかかるので、画面の次に始めて残りの段階と並行させる
+  enum class Stage : uint8_t {
+    PANEL,    // 表示器
+    CLOCK,    // RTC の時刻
+    GNSS,     // 測位の開始
+    BUTTONS,  // ボタン
+    TOTALS,   // 走行の積算値の読み込み
+    HISTORY,  // 走行履歴の修復
+    POI,      // 地点索引
+    ROUTE,    // 経路
+    TIMEZONE, // 時間帯の索引
+    LAYOUT,   // 利用者が定義した画面
+    READY,
+    Count
+  };
+
+private:
+  static constexpr int STAGE_COUNT = static_cast<int>(Stage::Count);
+
+  Stage         stage        = Stage::PANEL;
+  unsigned long beginMs      = 0;
+  unsigned long readyMs      = 0; // 以下の時刻はどれも beginMs からの経過時間
+  unsigned long firstFrameMs = 0;
+  unsigned long firstFixMs   = 0;
+  bool          hasFrame     = false;
+  bool          hasFix       = false;
+  unsigned long stageUs[STAGE_COUNT];
+  bool          isStageOk[STAGE_COUNT];
+
+public:
+  BootSequence() {
+    for (int i = 0; i < STAGE_COUNT; i++) {
+      stageUs[i]   = 0;
+      isStageOk[i] = false;
+    }
+  }
+
+  void begin(unsigned long nowMs) {
+    *this   = BootSequence();
+    beginMs = nowMs;
+  }
+
+  Stage get() const {
+    return stage;
+  }
+
+  bool isReady() const {
+    return stage == Stage::READY;
+  }
+
+  // 今の段階を終えて次へ進む。失敗しても止めず、その機能を使わないだけにする
+  void finish(bool isOk, unsigned long elapsedUs, unsigned long nowMs) {
+    if (isReady()) return;
+    const int index  = static_cast<int>(stage);
+    stageUs[index]   = elapsedUs;
+    isStageOk[index] = isOk;
+    stage            = static_cast<Stage>(index + 1);
+    if (isReady()) readyMs = nowMs - beginMs;
+  }
+
+  void markFrame(unsigned long nowMs) {
+    if (hasFrame) return;
+    hasFrame     = true;
+    firstFrameMs = nowMs - beginMs;
+  }
+
+  void markFix(unsigned long nowMs) {
+    if (hasFix) return;
+    hasFix     = true;
+    firstFixMs = nowMs - beginMs;
+  }
+
+  unsigned long getStageUs(Stage s) const {
+    return stageUs[static_cast<int>(s)];
+  }
+
+  bool isOk(Stage s) const {
+    return isStageOk[static_cast<int>(s)];
+  }
+
+  unsigned long getReadyMs() const {
+    return readyMs;
+  }
+
+  // 画面を出していなければ false
+  bool getFirstFrameMs(unsigned long &ms) const {
+    ms = firstFrameMs;
+    return hasFrame;
+  }
+
+  // 測位していなければ false
+  bool getFirstFixMs(unsigned long &ms) const {
+    ms = firstFixMs;
+    return hasFix;
+  }
+
+  // 1 段階 1 行で所要時間 [us] と成否を、最後に最初の画面・測位・起動完了までの時間 [ms] を
+  // 書き出す
+  template <typename Out> void report(Out &out) const {
+    char line[48];
+    for (int i = 0; i < static_cast<int>(stage); i++) {
+      snprintf(line, sizeof(line), "BOOT %s %lu %s\n", getName(static_cast<Stage>(i)), stageUs[i],
+               isStageOk[i] ? "ok" : "failed");
+      out.print(line);
+    }
+    snprintf(line, sizeof(line), "BOOT frame %ld fix %ld ready %ld\n",
+             toReport(hasFrame, firstFrameMs), toReport(hasFix, firstFixMs),
+             toReport(isReady(), readyMs));
+    out.print(line);
+  }
+
+  static const char *getName(Stage s) {
+    static const char *const NAMES[] = {
+        "PANEL",
+        "CLOCK",
+        "GNSS",
+        "BUTTONS",
+        "TOTALS",
+        "HISTORY",
+        "POI",
+        "ROUTE",
+        "TIMEZONE",
+        "LAYOUT",
+        "READY",
+    };
+    static_assert(sizeof(NAMES) / sizeof(NAMES[0]) == static_cast<size_t>(Stage::Count),
+                  "every Stage needs a name");
+    return s < Stage::Count ? NAMES[static_cast<int>(s)] : "";
+  }
+
+private:
+  // まだなら -1
+  static long toReport(bool isDone, unsigned long ms) {
+    return isDone ? static_cast<long>(ms) : -1;
+  }
+};
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../Config.h"
+
+// 走行軌跡を固定容量の折れ線として保持する
+// 容量が埋まるたびに未処理の末尾を Douglas-Peucker 法で間引き、それでも足りなければ
+// 許容誤差を倍にして全体を間引き直す。誤差は最終的な許容誤差の 2 倍以内に収まる
+class Breadcrumb {
+public:
+  struct Point {
+    int32_t latE7; // 1e-7 度単位 (約 1 cm)
+    int32_t lonE7;
+  };
+
+  static constexpr size_t CAPACITY = Config::Breadcrumb::CAPACITY;
+  static_assert(2 < CAPACITY && CAPACITY <= 65536, "indices are stored as uint16_t");
+
+private:
+  Point    points[CAPACITY];
+  size_t   count    = 0;
+  size_t   settled  = 0; // これより前の点は現在の許容誤差で間引き済み
+  uint32_t rewrites = 0; // 既存の点を書き換えた (間引き・リセットした) 回数
+  float    toleranceM;
+  float    mPerE7Lat = 0.0f;
+  float    mPerE7Lon = 0.0f;
+  uint16_t stack[CAPACITY];
+  uint8_t  keep[(CAPACITY + 7) / 8];
+
+public:
+  explicit Breadcrumb(float toleranceM = Config::Breadcrumb::TOLERANCE_M)
+      : toleranceM(toleranceM) {}
+
+  void add(double lat, double lon) {
+    const Point point = {toE7(lat), toE7(lon)};
+    if (count == 0) {
+      const double mPerE7 = Config::Odometer::EARTH_RADIUS_M * PI / 180.0 / 1e7;
+      mPerE7Lat           = static_cast<float>(mPerE7);
+      mPerE7Lon           = static_cast<float>(mPerE7 * cos(lat * PI / 180.0));
+    } else if (point.latE7 == points[count - 1].latE7 && point.lonE7 == points[count - 1].lonE7) {
+      return;
+    }
+
+    if (count == CAPACITY) compact();
+    points[count++] = point;
+  }
+
+  void reset(float initialToleranceM = Config::Breadcrumb::TOLERANCE_M) {
+    count      = 0;
+    settled    = 0;
+    toleranceM = initialToleranceM;
+    rewrites++;
+  }
+
+  size_t size() const {
+    return count;
+  }
+
+  const Point &operator[](size_t i) const {
+    return points[i];
+  }
+
+  float getToleranceM() const {
+    return toleranceM;
+  }
+
+  // 前回から変わっていなければ、それまでの点は追記されただけで書き換えられていない
+  uint32_t getRewriteCount() const {
+    return rewrites;
+  }
+
+  // 点 p から線分 ab までの距離 [m]
+  float distanceM(const Point &p, const Point &a, const Point &b) const {
+    const float abx = (b.lonE7 - a.lonE7) * mPerE7Lon;
+    const float aby = (b.latE7 - a.latE7) * mPerE7Lat;
+    const float apx = (p.lonE7 - a.lonE7) * mPerE7Lon;
+    const float apy = (p.latE7 - a.latE7) * mPerE7Lat;
+    const float len = abx * abx + aby * aby;
+
+    float t = len <= 0.0f ? 0.0f : (apx * abx + apy * aby) / len;
+    if (t < 0.0f) t = 0.0f;
+    if (1.0f < t) t = 1.0f;
+    const float dx = apx - t * abx;
+    const float dy = apy - t * aby;
+    return sqrtf(dx * dx + dy * dy);
+  }
+
+  static double toDegrees(int32_t e7) {
+    return e7 / 1e7;
+  }
+
+private:
+  static int32_t toE7(double degrees) {
+    return static_cast<int32_t>(lround(degrees * 1e7));
+  }
+
+  void compact() {
+    simplify(settled == 0 ? 0 : settled - 1, toleranceM);
+    while (Config::Breadcrumb::LOW_WATER < count) {
+      toleranceM *= 2.0f;
+      simplify(0, toleranceM);
+    }
+    settled = count;
+    rewrites++;
+  }
+
+  // points[first] から末尾までを間引き、残った点を詰める
+  void simplify(size_t first, float tolerance) {
+    const size_t last = count - 1;
+    if (last <= first + 1) return;
+
+    for (size_t i = first; i <= last; i++) setKeep(i, false);
+    setKeep(first, true);
+    setKeep(last, true);
+
+    // 左端から順に処理し、スタックには未処理区間の右端だけを積む (深さは点数以下)
+    size_t a       = first;
+    size_t depth   = 0;
+    stack[depth++] = static_cast<uint16_t>(last);
+    while (0 < depth) {
+      const size_t b = stack[depth - 1];
+
+      float  worst = tolerance;
+      size_t split = 0;
+      for (size_t i = a + 1; i < b; i++) {
+        const float d = distanceM(points[i], points[a], points[b]);
+        if (worst < d) {
+          worst = d;
+          split = i;
+        }
+      }
+
+      if (split == 0) {
+        a = b;
+        depth--;
+      } else {
+        setKeep(split, true);
+        stack[depth++] = static_cast<uint16_t>(split);
+      }
+    }
+
+    size_t out = first;
+    for (size_t i = first; i <= last; i++) {
+      if (isKept(i)) points[out++] = points[i];
+    }
+    count = out;
+  }
+
+  void setKeep(size_t i, bool value) {
+    if (value) keep[i / 8] |= 1u << (i % 8);
+    else keep[i / 8] &= ~(1u << (i % 8));
+  }
+
+  bool isKept(size_t i) const {
+    return keep[i / 8] & (1u << (i % 8));
+  }
+};
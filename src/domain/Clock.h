@@ -1,9 +1,16 @@
 #pragma once
 
 #include <GNSS.h>
+#include <RTC.h>
+#include <math.h>
+#include <stdint.h>
 
 #include "../Config.h"
+#include "TimeZone.h"
 
+// 時刻。begin() の後は RTC で時を刻むので、起動直後や屋内でも時刻を出せる。GNSS の時刻が
+// 得られている間はそれを使い、RTC を合わせる。合わせた間隔とその間のずれから RTC の進み方を
+// 推定し、GNSS がない間はその分を差し引く。時差と時分秒は秒が変わったときだけ計算し直す
 class Clock {
 public:
   struct Time {
@@ -12,20 +19,156 @@ public:
     int second = 0;
   };
 
+  struct Date {
+    int year  = 0;
+    int month = 0;
+    int day   = 0;
+  };
+
 private:
-  Time time;
-  int  year = 0;
+  static constexpr uint32_t UNIX_OFFSET = 946684800; // 1970-01-01 から 2000-01-01 までの秒
+
+  Time     time;
+  uint32_t epoch = 0;
+  TimeZone zone; // 位置から決まるまでは Config::Time::DEFAULT_OFFSET_MIN
+  int      offsetMin   = 0;
+  uint32_t offsetFrom  = 0; // この範囲の epoch では offsetMin のまま
+  uint32_t offsetUntil = 0;
+
+  bool    hasRtc      = false;
+  int64_t validFromMs = 0;     // RTC がこれより前を指していたら時刻を失っている
+  bool    isSynced    = false; // 以下は最後に RTC を合わせたときの値
+  int64_t syncedMs    = 0;     // 2000-01-01 UTC からの ms
+  float   driftPpm    = 0.0f;  // RTC の進み。正なら進んでいる
+  bool    hasDriftPpm = false;
 
 public:
+  // RTC を使い始める。RTC が時刻を保っていれば、GNSS を待たずに時刻が有効になる
+  bool begin() {
+    const int32_t validDays =
+        TimeZone::daysFromCivil(Config::Time::VALID_YEAR_START, 1, 1) - TimeZone::EPOCH_DAYS;
+    RTC.begin();
+    hasRtc      = true;
+    validFromMs = static_cast<int64_t>(validDays) * 86400000;
+
+    int64_t rtcMs;
+    if (!readRtc(rtcMs)) return false;
+    setEpoch(static_cast<uint32_t>(rtcMs / 1000));
+    return true;
+  }
+
   void update(const SpNavData &navData) {
-    year        = navData.time.year;
-    time.hour   = (navData.time.hour + Config::Time::JST_OFFSET + 24) % 24;
-    time.minute = navData.time.minute;
-    time.second = navData.time.sec;
+    const SpNavTime &t = navData.time;
+    int64_t          nowMs;
+    if (Config::Time::VALID_YEAR_START <= t.year) {
+      const int32_t days = TimeZone::daysFromCivil(t.year, t.month, t.day) - TimeZone::EPOCH_DAYS;
+      nowMs = (static_cast<int64_t>(days) * 86400 + t.hour * 3600 + t.minute * 60 + t.sec) * 1000 +
+              t.usec / 1000;
+      if (hasRtc && nowMs / 1000 != epoch) discipline(nowMs);
+    } else if (hasRtc && readRtc(nowMs)) {
+      nowMs = correct(nowMs);
+    } else {
+      time  = Time();
+      epoch = 0;
+      return;
+    }
+    setEpoch(static_cast<uint32_t>(nowMs / 1000));
+  }
+
+  void setZone(const TzFormat::Zone &rules) {
+    zone        = TimeZone(rules);
+    offsetUntil = 0;
+    if (epoch == 0) return;
+    const uint32_t now = epoch;
+    epoch              = 0;
+    setEpoch(now);
+  }
+
+  const TimeZone &getZone() const {
+    return zone;
   }
 
   Time getTime() const {
-    if (year < Config::Time::VALID_YEAR_START) return Time();
     return time;
   }
+
+  // 2000-01-01 00:00:00 UTC からの秒。時刻が不明なら 0
+  uint32_t getEpoch() const {
+    return epoch;
+  }
+
+  // RTC の進み [ppm]。まだ測れていなければ false
+  bool getDriftPpm(float &ppm) const {
+    ppm = driftPpm;
+    return hasDriftPpm;
+  }
+
+  // getEpoch() の値を今の時間帯の地方時の日付にする。夏時間はその時点のものを使う
+  Date getLocalDate(uint32_t at) const {
+    return toLocalDate(at, zone.getOffsetMin(at));
+  }
+
+  static Date toLocalDate(uint32_t epoch, int offsetMin) {
+    Date date;
+    TimeZone::civilFromDays(
+        static_cast<int32_t>((static_cast<int64_t>(epoch) + offsetMin * 60) / 86400) +
+            TimeZone::EPOCH_DAYS,
+        date.year, date.month, date.day);
+    return date;
+  }
+
+private:
+  void setEpoch(uint32_t now) {
+    if (now == epoch) return;
+    epoch = now;
+    if (now < offsetFrom || offsetUntil <= now) {
+      offsetMin  = zone.getOffsetMin(now, offsetUntil);
+      offsetFrom = now;
+    }
+
+    const uint32_t local = now + offsetMin * 60;
+    time.hour            = static_cast<int>(local / 3600 % 24);
+    time.minute          = static_cast<int>(local / 60 % 60);
+    time.second          = static_cast<int>(local % 60);
+  }
+
+  // GNSS の時刻と RTC を比べ、ずれが Config::Clock::STEP_MS を超えたか、前回から
+  // Config::Clock::DRIFT_SPAN_MS 経ったら RTC を合わせ直す。その間のずれで進み方の推定を更新する
+  void discipline(int64_t gnssMs) {
+    int64_t       rtcMs;
+    const bool    hasTime = readRtc(rtcMs);
+    const int64_t spanMs  = gnssMs - syncedMs;
+    const int64_t errorMs = rtcMs - gnssMs;
+    if (isSynced && hasTime && spanMs < Config::Clock::DRIFT_SPAN_MS &&
+        -Config::Clock::STEP_MS <= errorMs && errorMs <= Config::Clock::STEP_MS) {
+      return;
+    }
+
+    if (isSynced && hasTime && Config::Clock::DRIFT_MIN_SPAN_MS <= spanMs) {
+      const float ppm = static_cast<float>(errorMs) * 1e6f / static_cast<float>(spanMs);
+      if (fabsf(ppm) <= Config::Clock::MAX_DRIFT_PPM) {
+        driftPpm    = hasDriftPpm ? driftPpm + (ppm - driftPpm) * Config::Clock::DRIFT_ALPHA : ppm;
+        hasDriftPpm = true;
+      }
+    }
+
+    RtcTime rtcTime(static_cast<uint32_t>(gnssMs / 1000) + UNIX_OFFSET,
+                    static_cast<long>(gnssMs % 1000) * 1000000);
+    RTC.setTime(rtcTime);
+    isSynced = true;
+    syncedMs = gnssMs;
+  }
+
+  // 最後に合わせてからの RTC の進みを差し引く
+  int64_t correct(int64_t rtcMs) const {
+    if (!isSynced || !hasDriftPpm) return rtcMs;
+    return rtcMs - static_cast<int64_t>((rtcMs - syncedMs) * (driftPpm / 1e6f));
+  }
+
+  // 2000-01-01 UTC からの ms。RTC が時刻を失っていれば false
+  bool readRtc(int64_t &ms) const {
+    const RtcTime now = RTC.getTime();
+    ms = (static_cast<int64_t>(now.unixtime()) - UNIX_OFFSET) * 1000 + now.nsec() / 1000000;
+    return validFromMs <= ms;
+  }
 };
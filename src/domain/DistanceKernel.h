@@ -0,0 +1,124 @@
+#pragma once
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../Config.h"
+#include "Odometer.h"
+
+#if defined(ARDUINO_ARCH_SPRESENSE) && !defined(UNIT_TEST)
+#include <arm_math.h>
+#define DISTANCE_KERNEL_USE_CMSIS
+#endif
+
+// 多数の測位点 (SoA) をまとめて区間距離に変換する。Odometer と同じ局所平面近似を用いる
+class DistanceKernel {
+public:
+  static constexpr size_t BLOCK = 64;
+
+  // count - 1 個の隣り合う点の間の距離 [m] を stepM に書き (無効な点を含む区間は不定)、
+  // Odometer::update に同じ点と isMoving を順に渡したときと同じ規則 (OdometerRule) で数えた
+  // 合計 [m] を返す
+  static double integrate(const double *lat, const double *lon, const bool *isMoving,
+                          size_t count, float *stepM) {
+    for (size_t start = 0; start + 1 < count; start += BLOCK) {
+      size_t n = count - 1 - start;
+      if (BLOCK < n) n = BLOCK;
+      integrateBlock(lat + start, lon + start, n, stepM + start);
+    }
+    return accumulate(lat, lon, isMoving, count, stepM);
+  }
+
+private:
+  typedef OdometerRule::Step Step;
+
+  static constexpr float M_PER_DEG = Config::Odometer::EARTH_RADIUS_M * PI / 180.0;
+  static constexpr float RAD       = PI / 180.0;
+
+  // ブロック内で最初の有効な点を origin とし、以降は float のみで計算する
+  // 測位前の (0, 0) を origin にすると、有効な点どうしの距離まで狂う
+  static void integrateBlock(const double *lat, const double *lon, size_t n, float *stepM) {
+    size_t origin = 0;
+    while (origin < n && !OdometerRule::isValid(lat[origin], lon[origin])) origin++;
+
+    float y[BLOCK + 1];
+    float x[BLOCK + 1];
+    for (size_t i = 0; i <= n; i++) {
+      y[i] = static_cast<float>(lat[i] - lat[origin]);
+      x[i] = static_cast<float>(lon[i] - lon[origin]);
+    }
+
+    const float cos0 = cosf(static_cast<float>(lat[origin]) * RAD);
+    const float sin0 = sinf(static_cast<float>(lat[origin]) * RAD);
+    steps(y, x, n, cos0, sin0, stepM);
+  }
+
+  // Odometer と同じく mm の整数で積算する。起点 (anchor) が直前の点のときは stepM を使い、
+  // 短い移動をまとめている間や無効な点の後だけ起点から測り直す
+  static double accumulate(const double *lat, const double *lon, const bool *isMoving,
+                           size_t count, const float *stepM) {
+    uint64_t totalMm   = 0;
+    size_t   anchor    = count; // count は起点なし
+    bool     wasMoving = false;
+    for (size_t i = 0; i < count; i++) {
+      if (!OdometerRule::isValid(lat[i], lon[i])) continue;
+      if (anchor != count && OdometerRule::isCounted(isMoving[i], wasMoving)) {
+        const float step = anchor + 1 == i ? stepM[anchor] : stepFrom(lat, lon, anchor, i);
+        const Step  rule = OdometerRule::classify(step, isMoving[i]);
+        if (rule == Step::HOLD) {
+          wasMoving = true;
+          continue;
+        }
+        if (rule == Step::ACCEPT) totalMm += Numeric<float>::toMillis(step);
+      }
+      anchor    = i;
+      wasMoving = isMoving[i];
+    }
+    return totalMm / 1000.0;
+  }
+
+  static float stepFrom(const double *lat, const double *lon, size_t from, size_t to) {
+    const float y      = static_cast<float>(lat[to] - lat[from]);
+    const float x      = static_cast<float>(lon[to] - lon[from]);
+    const float cosMid = cosf(static_cast<float>(lat[from]) * RAD) -
+                         sinf(static_cast<float>(lat[from]) * RAD) * RAD * 0.5f * y;
+    const float north  = y * M_PER_DEG;
+    const float east   = x * M_PER_DEG * cosMid;
+    return sqrtf(east * east + north * north);
+  }
+
+#ifdef DISTANCE_KERNEL_USE_CMSIS
+  static void steps(const float *y, const float *x, size_t n, float cos0, float sin0,
+                    float *stepM) {
+    float dy[BLOCK];
+    float dx[BLOCK];
+    float cosMid[BLOCK];
+    const uint32_t size = static_cast<uint32_t>(n);
+
+    arm_sub_f32(const_cast<float *>(y + 1), const_cast<float *>(y), dy, size);
+    arm_sub_f32(const_cast<float *>(x + 1), const_cast<float *>(x), dx, size);
+    arm_add_f32(const_cast<float *>(y + 1), const_cast<float *>(y), cosMid, size);
+    arm_scale_f32(cosMid, -sin0 * RAD * 0.5f, cosMid, size);
+    arm_offset_f32(cosMid, cos0, cosMid, size);
+    arm_mult_f32(dx, cosMid, dx, size);
+    arm_scale_f32(dx, M_PER_DEG, dx, size);
+    arm_scale_f32(dy, M_PER_DEG, dy, size);
+    arm_mult_f32(dx, dx, dx, size);
+    arm_mult_f32(dy, dy, dy, size);
+    arm_add_f32(dx, dy, dx, size);
+    for (size_t i = 0; i < n; i++) arm_sqrt_f32(dx[i], &stepM[i]);
+  }
+#else
+  // 分岐のない単純なループにして、ホストのコンパイラに自動ベクトル化させる
+  static void steps(const float *__restrict y, const float *__restrict x, size_t n, float cos0,
+                    float sin0, float *__restrict stepM) {
+    for (size_t i = 0; i < n; i++) {
+      const float cosMid = cos0 - sin0 * RAD * 0.5f * (y[i] + y[i + 1]);
+      const float north  = (y[i + 1] - y[i]) * M_PER_DEG;
+      const float east   = (x[i + 1] - x[i]) * M_PER_DEG * cosMid;
+      stepM[i]           = sqrtf(east * east + north * north);
+    }
+  }
+#endif
+};
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <stdint.h>
+
+// 符号付き固定小数点数。IntBits は符号ビットを含む整数部、FracBits は小数部のビット数
+// 演算結果が表現範囲を超えた場合は最大値・最小値に飽和する
+template <int IntBits, int FracBits> class Fixed {
+  static_assert(0 < IntBits && 0 <= FracBits, "invalid Fixed format");
+  static_assert(IntBits + FracBits <= 32, "Fixed must fit in 32 bits");
+
+public:
+  static constexpr int     INT_BITS  = IntBits;
+  static constexpr int     FRAC_BITS = FracBits;
+  static constexpr int64_t ONE       = int64_t(1) << FracBits;
+  static constexpr int64_t RAW_MAX   = (int64_t(1) << (IntBits + FracBits - 1)) - 1;
+  static constexpr int64_t RAW_MIN   = -(int64_t(1) << (IntBits + FracBits - 1));
+
+private:
+  int32_t value = 0;
+
+  struct RawTag {};
+  constexpr Fixed(int32_t raw, RawTag) : value(raw) {}
+
+public:
+  constexpr Fixed() = default;
+  constexpr explicit Fixed(float v) : value(saturate(v * ONE)) {}
+
+  static constexpr Fixed fromRaw(int64_t raw) {
+    return Fixed(clamp(raw), RawTag());
+  }
+
+  static constexpr Fixed fromDouble(double v) {
+    return Fixed(saturate(v * ONE), RawTag());
+  }
+
+  static constexpr Fixed max() {
+    return Fixed(static_cast<int32_t>(RAW_MAX), RawTag());
+  }
+
+  static constexpr Fixed min() {
+    return Fixed(static_cast<int32_t>(RAW_MIN), RawTag());
+  }
+
+  constexpr int32_t raw() const {
+    return value;
+  }
+
+  constexpr float toFloat() const {
+    return static_cast<float>(value) / ONE;
+  }
+
+  constexpr double toDouble() const {
+    return static_cast<double>(value) / ONE;
+  }
+
+  constexpr Fixed operator-() const {
+    return fromRaw(-static_cast<int64_t>(value));
+  }
+
+  constexpr Fixed operator+(Fixed other) const {
+    return fromRaw(static_cast<int64_t>(value) + other.value);
+  }
+
+  constexpr Fixed operator-(Fixed other) const {
+    return fromRaw(static_cast<int64_t>(value) - other.value);
+  }
+
+  constexpr Fixed operator*(Fixed other) const {
+    return fromRaw(shiftRound(static_cast<int64_t>(value) * other.value));
+  }
+
+  // 0 除算は被除数の符号に応じて飽和させる
+  constexpr Fixed operator/(Fixed other) const {
+    return other.value == 0 ? (value < 0 ? min() : max())
+                            : fromRaw(static_cast<int64_t>(value) * ONE / other.value);
+  }
+
+  Fixed &operator+=(Fixed other) {
+    return *this = *this + other;
+  }
+
+  Fixed &operator-=(Fixed other) {
+    return *this = *this - other;
+  }
+
+  Fixed &operator*=(Fixed other) {
+    return *this = *this * other;
+  }
+
+  Fixed &operator/=(Fixed other) {
+    return *this = *this / other;
+  }
+
+  constexpr bool operator==(Fixed other) const {
+    return value == other.value;
+  }
+
+  constexpr bool operator!=(Fixed other) const {
+    return value != other.value;
+  }
+
+  constexpr bool operator<(Fixed other) const {
+    return value < other.value;
+  }
+
+  constexpr bool operator<=(Fixed other) const {
+    return value <= other.value;
+  }
+
+  constexpr bool operator>(Fixed other) const {
+    return value > other.value;
+  }
+
+  constexpr bool operator>=(Fixed other) const {
+    return value >= other.value;
+  }
+
+private:
+  static constexpr int32_t clamp(int64_t raw) {
+    return static_cast<int32_t>(raw < RAW_MIN ? RAW_MIN : (RAW_MAX < raw ? RAW_MAX : raw));
+  }
+
+  // 四捨五入して整数化する。int64_t に収まらない値はここで飽和させる
+  static constexpr int32_t saturate(double scaled) {
+    return scaled <= RAW_MIN   ? static_cast<int32_t>(RAW_MIN)
+           : RAW_MAX <= scaled ? static_cast<int32_t>(RAW_MAX)
+                               : static_cast<int32_t>(scaled < 0 ? scaled - 0.5 : scaled + 0.5);
+  }
+
+  // 負数の右シフトは算術シフトとして扱う (GCC)
+  static constexpr int64_t shiftRound(int64_t product) {
+    return (product + (ONE >> 1)) >> FracBits;
+  }
+};
+
+template <int IntBits, int FracBits> constexpr int Fixed<IntBits, FracBits>::INT_BITS;
+template <int IntBits, int FracBits> constexpr int Fixed<IntBits, FracBits>::FRAC_BITS;
+template <int IntBits, int FracBits> constexpr int64_t Fixed<IntBits, FracBits>::ONE;
+template <int IntBits, int FracBits> constexpr int64_t Fixed<IntBits, FracBits>::RAW_MAX;
+template <int IntBits, int FracBits> constexpr int64_t Fixed<IntBits, FracBits>::RAW_MIN;
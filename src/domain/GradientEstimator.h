@@ -0,0 +1,165 @@
+#pragma once
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../Config.h"
+
+// 走行距離に対する高度の直線回帰で勾配を求め、獲得標高を積算する
+// 回帰は区間内の点の和 (Σx, Σy, Σxx, Σxy, Σyy) を出し入れするだけなので、1 回の更新は O(1)
+// 和は cm 単位の整数で持ち、何度出し入れしても誤差が溜まらないようにする
+class GradientEstimator {
+private:
+  static constexpr size_t  CAPACITY  = Config::Gradient::CAPACITY;
+  static constexpr int64_t SAMPLE_MM = static_cast<int64_t>(Config::Gradient::SAMPLE_M * 1000);
+  static constexpr int64_t WINDOW_CM = static_cast<int64_t>(Config::Gradient::WINDOW_M * 100);
+  static constexpr int64_t REBASE_CM = 1000000; // 和が溢れないよう、x の原点を 10 km ごとに進める
+
+  struct Sample {
+    int64_t xCm; // 走行距離 (絶対値)
+    int32_t yCm; // 高度
+  };
+
+  Sample  samples[CAPACITY];
+  size_t  head     = 0; // 最も古い点
+  size_t  count    = 0;
+  int64_t originCm = 0; // 和の x はここからの距離
+  int64_t sumX     = 0;
+  int64_t sumY     = 0;
+  int64_t sumXX    = 0;
+  int64_t sumXY    = 0;
+  int64_t sumYY    = 0;
+
+  int64_t travelledMm = 0;
+  int64_t pendingMm   = 0; // 最後の点からの距離
+  float   pendingSumM = 0.0f;
+  int     pendingN    = 0;
+
+  float ascentM   = 0.0f;
+  float anchorM   = 0.0f; // 獲得標高を最後に確定した高度
+  bool  hasAnchor = false;
+
+public:
+  // deltaMm: Odometer が今回確定した距離、altitudeM: 今回の測位の高度
+  void update(uint32_t deltaMm, float altitudeM) {
+    pendingSumM += altitudeM;
+    pendingN++;
+    travelledMm += deltaMm;
+    pendingMm += deltaMm;
+    if (pendingMm < SAMPLE_MM) return;
+
+    const float meanM = pendingSumM / pendingN;
+    pendingMm         = 0;
+    pendingSumM       = 0.0f;
+    pendingN          = 0;
+    push(travelledMm / 10, static_cast<int32_t>(lroundf(meanM * 100.0f)));
+    accumulate();
+  }
+
+  void reset() {
+    head        = 0;
+    count       = 0;
+    originCm    = 0;
+    sumX        = 0;
+    sumY        = 0;
+    sumXX       = 0;
+    sumXY       = 0;
+    sumYY       = 0;
+    travelledMm = 0;
+    pendingMm   = 0;
+    pendingSumM = 0.0f;
+    pendingN    = 0;
+    ascentM     = 0.0f;
+    hasAnchor   = false;
+  }
+
+  void restore(float savedAscentM) {
+    reset();
+    ascentM = savedAscentM;
+  }
+
+  // 上りが正 [%]。区間が短いうちは 0
+  float getGradientPercent() const {
+    if (count < 3 || spanCm() < Config::Gradient::MIN_SPAN_M * 100) return 0.0f;
+    const int64_t n   = static_cast<int64_t>(count);
+    const int64_t dxx = n * sumXX - sumX * sumX;
+    if (dxx <= 0) return 0.0f;
+    const int64_t dxy = n * sumXY - sumX * sumY;
+    return static_cast<float>(dxy) / static_cast<float>(dxx) * 100.0f;
+  }
+
+  float getAscentM() const {
+    return ascentM;
+  }
+
+  // 回帰直線からの残差の標準偏差 [m]
+  float getNoiseM() const {
+    if (count < 3) return 0.0f;
+    const int64_t n   = static_cast<int64_t>(count);
+    const float   dxx = static_cast<float>(n * sumXX - sumX * sumX);
+    const float   dxy = static_cast<float>(n * sumXY - sumX * sumY);
+    const float   dyy = static_cast<float>(n * sumYY - sumY * sumY);
+    if (dxx <= 0.0f) return 0.0f;
+    const float residual = (dyy - dxy * dxy / dxx) / (n * (n - 2.0f));
+    return residual <= 0.0f ? 0.0f : sqrtf(residual) / 100.0f;
+  }
+
+private:
+  int64_t spanCm() const {
+    return samples[(head + count - 1) % CAPACITY].xCm - samples[head].xCm;
+  }
+
+  void push(int64_t xCm, int32_t yCm) {
+    if (count == CAPACITY) pop();
+    samples[(head + count) % CAPACITY] = {xCm, yCm};
+    count++;
+    add(xCm - originCm, yCm, 1);
+    while (2 < count && WINDOW_CM < spanCm()) pop();
+
+    if (REBASE_CM < xCm - originCm) rebase(samples[head].xCm);
+  }
+
+  void pop() {
+    const Sample &oldest = samples[head];
+    add(oldest.xCm - originCm, oldest.yCm, -1);
+    head = (head + 1) % CAPACITY;
+    count--;
+  }
+
+  void add(int64_t x, int64_t y, int64_t sign) {
+    sumX += sign * x;
+    sumY += sign * y;
+    sumXX += sign * x * x;
+    sumXY += sign * x * y;
+    sumYY += sign * y * y;
+  }
+
+  // 全点の x を d だけ動かしたときの和を、点を辿らずに求める
+  void rebase(int64_t newOriginCm) {
+    const int64_t d = newOriginCm - originCm;
+    const int64_t n = static_cast<int64_t>(count);
+    sumXX += -2 * d * sumX + n * d * d;
+    sumXY -= d * sumY;
+    sumX -= n * d;
+    originCm = newOriginCm;
+  }
+
+  // 区間の平均高度 (窓の中央の高度) が、その標準誤差より大きく動いたときだけ上りとして数える
+  void accumulate() {
+    const float altitudeM   = static_cast<float>(sumY) / count / 100.0f;
+    float       hysteresisM = Config::Gradient::NOISE_K * getNoiseM() / sqrtf(count);
+    if (hysteresisM < Config::Gradient::MIN_HYST_M) hysteresisM = Config::Gradient::MIN_HYST_M;
+    if (Config::Gradient::MAX_HYST_M < hysteresisM) hysteresisM = Config::Gradient::MAX_HYST_M;
+
+    if (!hasAnchor) {
+      anchorM   = altitudeM;
+      hasAnchor = true;
+    } else if (hysteresisM <= altitudeM - anchorM) {
+      ascentM += altitudeM - anchorM;
+      anchorM = altitudeM;
+    } else if (hysteresisM <= anchorM - altitudeM) {
+      anchorM = altitudeM;
+    }
+  }
+};
@@ -0,0 +1,185 @@
+#pragma once
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../Config.h"
+
+// 区切りごとに Trip の積算値の差分を固定長レコードに記録する
+// レコードは確保済みのリングバッファに置き、容量を超えたら古いものから上書きする
+class LapTimer {
+public:
+  enum class Trigger : uint8_t { MANUAL, DISTANCE, TIME, POSITION };
+
+  struct Lap {
+    uint32_t distanceMm    = 0;
+    uint32_t movingTimeMs  = 0;
+    uint32_t elapsedTimeMs = 0;
+    uint16_t maxCentiKmh   = 0;
+    Trigger  trigger       = Trigger::MANUAL; // このラップを閉じた区切り
+
+    float getAvgKmh() const {
+      return movingTimeMs == 0 ? 0.0f : distanceMm * 3.6f / movingTimeMs;
+    }
+
+    float getMaxKmh() const {
+      return maxCentiKmh / 100.0f;
+    }
+  };
+
+  // 区切りの判定に使う Trip の積算値
+  struct Totals {
+    uint64_t totalMm       = 0;
+    uint64_t movingTimeMs  = 0;
+    uint64_t elapsedTimeMs = 0;
+  };
+
+private:
+  Lap    laps[Config::Lap::CAPACITY];
+  size_t count = 0; // 完了したラップの総数 (上書きされた分を含む)
+
+  Totals   start;
+  uint16_t maxCentiKmh = 0;
+
+  Trigger  autoTrigger   = Trigger::MANUAL; // MANUAL は自動区切りなし
+  uint32_t autoThreshold = 0;               // DISTANCE: mm, TIME: ms
+  double   gateLat       = 0.0;
+  double   gateLon       = 0.0;
+  bool     hasGate       = false;
+  bool     isGateArmed   = false;
+
+public:
+  void reset(const Totals &totals) {
+    count       = 0;
+    start       = totals;
+    maxCentiKmh = 0;
+    hasGate     = false;
+    isGateArmed = false;
+  }
+
+  void setAuto(Trigger trigger, uint32_t threshold = 0) {
+    autoTrigger   = trigger;
+    autoThreshold = threshold;
+    hasGate       = false;
+    isGateArmed   = false;
+  }
+
+  // Config::Lap で決めた自動区切りを使う
+  void setDefaultAuto() {
+    if (0 < Config::Lap::AUTO_DISTANCE_M) {
+      setAuto(Trigger::DISTANCE, Config::Lap::AUTO_DISTANCE_M * 1000);
+    } else if (0 < Config::Lap::AUTO_TIME_MS) {
+      setAuto(Trigger::TIME, Config::Lap::AUTO_TIME_MS);
+    } else {
+      setAuto(Config::Lap::AUTO_AT_GATE ? Trigger::POSITION : Trigger::MANUAL);
+    }
+  }
+
+  Trigger getAutoTrigger() const {
+    return autoTrigger;
+  }
+
+  // 地点ラップの基準点。指定しなければ最初の測位点を使う
+  void setGate(double lat, double lon) {
+    gateLat     = lat;
+    gateLon     = lon;
+    hasGate     = true;
+    isGateArmed = false;
+  }
+
+  void update(const Totals &totals, float curKmh, bool hasFix, double lat, double lon) {
+    const uint16_t centiKmh = toCentiKmh(curKmh);
+    if (maxCentiKmh < centiKmh) maxCentiKmh = centiKmh;
+
+    switch (autoTrigger) {
+    case Trigger::DISTANCE:
+      if (0 < autoThreshold && start.totalMm + autoThreshold <= totals.totalMm) {
+        mark(totals, Trigger::DISTANCE);
+      }
+      break;
+    case Trigger::TIME:
+      if (0 < autoThreshold && autoThreshold <= totals.elapsedTimeMs - start.elapsedTimeMs) {
+        mark(totals, Trigger::TIME);
+      }
+      break;
+    case Trigger::POSITION:
+      if (hasFix && isGateCrossed(lat, lon)) mark(totals, Trigger::POSITION);
+      break;
+    case Trigger::MANUAL:
+      break;
+    }
+  }
+
+  void mark(const Totals &totals, Trigger trigger = Trigger::MANUAL) {
+    laps[count % Config::Lap::CAPACITY] = measure(totals, trigger);
+    count++;
+    start       = totals;
+    maxCentiKmh = 0;
+  }
+
+  // 進行中のラップ
+  Lap getCurrent(const Totals &totals) const {
+    return measure(totals, Trigger::MANUAL);
+  }
+
+  size_t getCount() const {
+    return count;
+  }
+
+  // 保持している中で最も古いラップの番号 (0 始まり)
+  size_t getFirstIndex() const {
+    return count < Config::Lap::CAPACITY ? 0 : count - Config::Lap::CAPACITY;
+  }
+
+  // index は 0 始まりのラップ番号。上書き済み、または未完了なら nullptr
+  const Lap *get(size_t index) const {
+    if (index < getFirstIndex() || count <= index) return nullptr;
+    return &laps[index % Config::Lap::CAPACITY];
+  }
+
+  const Lap *getLast() const {
+    return count == 0 ? nullptr : get(count - 1);
+  }
+
+private:
+  static uint16_t toCentiKmh(float kmh) {
+    if (kmh <= 0.0f) return 0;
+    if (655.35f <= kmh) return UINT16_MAX;
+    return static_cast<uint16_t>(kmh * 100.0f + 0.5f);
+  }
+
+  Lap measure(const Totals &totals, Trigger trigger) const {
+    Lap lap;
+    lap.distanceMm    = static_cast<uint32_t>(totals.totalMm - start.totalMm);
+    lap.movingTimeMs  = static_cast<uint32_t>(totals.movingTimeMs - start.movingTimeMs);
+    lap.elapsedTimeMs = static_cast<uint32_t>(totals.elapsedTimeMs - start.elapsedTimeMs);
+    lap.maxCentiKmh   = maxCentiKmh;
+    lap.trigger       = trigger;
+    return lap;
+  }
+
+  // 基準点から一度離れ、再び半径内に入った時点で 1 周とする
+  bool isGateCrossed(double lat, double lon) {
+    if (!hasGate) {
+      setGate(lat, lon);
+      return false;
+    }
+
+    const double mPerDeg = Config::Odometer::EARTH_RADIUS_M * PI / 180.0;
+    const double north   = (lat - gateLat) * mPerDeg;
+    const double east    = (lon - gateLon) * mPerDeg * cos(gateLat * PI / 180.0);
+    const double d2      = north * north + east * east;
+
+    if (!isGateArmed) {
+      const double leave = Config::Lap::CROSSING_LEAVE_M;
+      if (leave * leave <= d2) isGateArmed = true;
+      return false;
+    }
+
+    const double radius = Config::Lap::CROSSING_RADIUS_M;
+    if (radius * radius < d2) return false;
+    isGateArmed = false;
+    return true;
+  }
+};
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// ROM や RAM に置いたファイルの中身をそのまま読む。FlashFileSource と同じ形で使える
+class MemorySource {
+private:
+  const uint8_t *data;
+  size_t         size;
+
+public:
+  MemorySource(const uint8_t *data, size_t size) : data(data), size(size) {}
+
+  bool read(uint32_t offset, void *buffer, size_t length) {
+    if (size < offset || size - offset < length) return false;
+    memcpy(buffer, data + offset, length);
+    return true;
+  }
+
+  size_t getSize() const {
+    return size;
+  }
+};
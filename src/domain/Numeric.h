@@ -0,0 +1,108 @@
+#pragma once
+
+#include <math.h>
+#include <stdint.h>
+
+#include "Fixed.h"
+
+// ドメイン計算で使う数値型ごとの変換と演算。float / double / Fixed を同じコードで扱う
+template <typename T> struct Numeric;
+
+template <> struct Numeric<float> {
+  static constexpr float from(double v) {
+    return static_cast<float>(v);
+  }
+
+  static float fromRatio(uint64_t num, uint64_t den) {
+    return static_cast<float>(num) / static_cast<float>(den);
+  }
+
+  static constexpr float toFloat(float v) {
+    return v;
+  }
+
+  static float hypot(float a, float b) {
+    return sqrtf(a * a + b * b);
+  }
+
+  static uint64_t toMillis(float v) {
+    return v <= 0.0f ? 0 : static_cast<uint64_t>(v * 1000.0f + 0.5f);
+  }
+};
+
+template <> struct Numeric<double> {
+  static constexpr double from(double v) {
+    return v;
+  }
+
+  static double fromRatio(uint64_t num, uint64_t den) {
+    return static_cast<double>(num) / static_cast<double>(den);
+  }
+
+  static constexpr float toFloat(double v) {
+    return static_cast<float>(v);
+  }
+
+  static double hypot(double a, double b) {
+    return sqrt(a * a + b * b);
+  }
+
+  static uint64_t toMillis(double v) {
+    return v <= 0.0 ? 0 : static_cast<uint64_t>(v * 1000.0 + 0.5);
+  }
+};
+
+template <int IntBits, int FracBits> struct Numeric<Fixed<IntBits, FracBits>> {
+  typedef Fixed<IntBits, FracBits> T;
+
+  static constexpr T from(double v) {
+    return T::fromDouble(v);
+  }
+
+  // num << FracBits が 64 ビットに収まる範囲で使う
+  static T fromRatio(uint64_t num, uint64_t den) {
+    return T::fromRaw(static_cast<int64_t>((num << FracBits) / den));
+  }
+
+  static constexpr float toFloat(T v) {
+    return v.toFloat();
+  }
+
+  // 2 乗和は 64 ビットで取り、途中で飽和させない
+  static T hypot(T a, T b) {
+    const int64_t  x = a.raw();
+    const int64_t  y = b.raw();
+    const uint64_t s = static_cast<uint64_t>(x * x) + static_cast<uint64_t>(y * y);
+    return T::fromRaw(static_cast<int64_t>(isqrt(s)));
+  }
+
+  static uint64_t toMillis(T v) {
+    return v.raw() <= 0 ? 0 : (static_cast<uint64_t>(v.raw()) * 1000 + (T::ONE >> 1)) >> FracBits;
+  }
+
+private:
+  static uint64_t isqrt(uint64_t n) {
+    uint64_t root = 0;
+    uint64_t bit  = uint64_t(1) << 62;
+    while (n < bit) bit >>= 2;
+    while (bit != 0) {
+      if (root + bit <= n) {
+        n -= root + bit;
+        root = (root >> 1) + bit;
+      } else {
+        root >>= 1;
+      }
+      bit >>= 2;
+    }
+    return root;
+  }
+};
+
+// ドメイン計算の数値型をビルド時に選ぶ (既定は float)
+#if defined(DOMAIN_NUMBER_FIXED)
+typedef Fixed<16, 16> DomainNumber;
+#elif defined(DOMAIN_NUMBER_DOUBLE)
+typedef double DomainNumber;
+#else
+typedef float DomainNumber;
+#endif
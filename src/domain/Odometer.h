@@ -1,63 +1,122 @@
 #pragma once
 
 #include <math.h>
+#include <stdint.h>
 
 #include "../Config.h"
+#include "Numeric.h"
 
-class Odometer {
+// 区間を距離に数えるかの規則。Odometer と、ログを一括で処理する DistanceKernel で共有する
+struct OdometerRule {
+  enum class Step { HOLD, ACCEPT, REJECT };
+
+  static bool isValid(double lat, double lon) {
+    return Config::Odometer::MIN_ABS <= fabs(lat) || Config::Odometer::MIN_ABS <= fabs(lon);
+  }
+
+  // 止まっている間の GPS ノイズは数えない
+  static bool isCounted(bool isMoving, bool wasMoving) {
+    return isMoving || wasMoving;
+  }
+
+  // HOLD なら起点を動かさず、閾値を超えるまで短い移動をまとめる
+  template <typename Num> static Step classify(Num stepM, bool isMoving) {
+    if (isMoving && stepM <= Numeric<Num>::from(Config::Odometer::MIN_STEP_M)) return Step::HOLD;
+    if (stepM < Numeric<Num>::from(Config::Odometer::MAX_STEP_M)) return Step::ACCEPT;
+    return Step::REJECT; // GPS ノイズ対策
+  }
+};
+
+// 基準点 (origin) の cos/sin をキャッシュした局所平面上で距離を求め、mm 単位の整数で積算する
+template <typename Num> class BasicOdometer {
 private:
-  float totalKm      = 0.0f;
-  float lastLat      = 0.0f;
-  float lastLon      = 0.0f;
-  bool  hasLastCoord = false;
+  uint64_t totalMm      = 0;
+  double   originLat    = 0.0;
+  Num      cosOrigin    = Numeric<Num>::from(1.0);
+  Num      sinOriginRad = Num(); // sin(origin) * PI / 180
+  double   anchorLat    = 0.0;   // 最後に距離を確定した地点
+  double   anchorLon    = 0.0;
+  bool     hasAnchor    = false;
+  bool     wasMoving    = false;
 
 public:
-  void update(float lat, float lon, bool isMoving) {
-    if (fabsf(lat) < Config::Odometer::MIN_ABS && fabsf(lon) < Config::Odometer::MIN_ABS) {
-      return; // 無効な値を避ける
-    }
+  // 距離を確定した (走行軌跡として採用できる) 測位点なら true を返す
+  bool update(double lat, double lon, bool isMoving) {
+    if (!OdometerRule::isValid(lat, lon)) return false; // 無効な値を避ける
 
-    if (!hasLastCoord) {
-      lastLat      = lat;
-      lastLon      = lon;
-      hasLastCoord = true;
-      return;
+    if (!hasAnchor) {
+      setOrigin(lat);
+      setAnchor(lat, lon, isMoving);
+      hasAnchor = true;
+      return true;
     }
 
-    if (isMoving) {
-      const float deltaKm = planarDistanceKm(lastLat, lastLon, lat, lon);
-      const bool  isDeltaValid =
-          Config::Odometer::MIN_DELTA < deltaKm && deltaKm < Config::Odometer::MAX_DELTA;
-      if (isDeltaValid) totalKm += deltaKm; // GPS ノイズ対策
+    if (Config::Odometer::REANCHOR_DEG < fabs(lat - originLat)) setOrigin(lat);
+
+    bool isAccepted = false;
+    if (OdometerRule::isCounted(isMoving, wasMoving)) {
+      const Num                stepM = stepMeters(lat, lon);
+      const OdometerRule::Step step  = OdometerRule::classify(stepM, isMoving);
+      if (step == OdometerRule::Step::HOLD) {
+        wasMoving = true;
+        return false;
+      }
+      if (step == OdometerRule::Step::ACCEPT) {
+        totalMm += Numeric<Num>::toMillis(stepM);
+        isAccepted = true;
+      }
     }
 
-    lastLat = lat;
-    lastLon = lon;
+    setAnchor(lat, lon, isMoving);
+    return isAccepted;
   }
 
   void reset() {
-    totalKm      = 0.0f;
-    lastLat      = 0.0f;
-    lastLon      = 0.0f;
-    hasLastCoord = false;
+    totalMm   = 0;
+    hasAnchor = false;
+    wasMoving = false;
+  }
+
+  void restore(uint64_t mm) {
+    reset();
+    totalMm = mm;
   }
 
   float getTotalDistance() const {
-    return totalKm;
+    return totalMm / 1000000.0f; // km
+  }
+
+  uint64_t getTotalMm() const {
+    return totalMm;
   }
 
 private:
+  static constexpr double M_PER_DEG = Config::Odometer::EARTH_RADIUS_M * PI / 180.0;
+
   static constexpr float toRad(float degrees) {
     return degrees * PI / 180.0f;
   }
 
-  static float planarDistanceKm(float lat1, float lon1, float lat2, float lon2) {
-    constexpr float R      = 6378137.0f; // WGS84 [m]
-    const float     latRad = toRad((lat1 + lat2) / 2.0f);
-    const float     dLat   = toRad(lat2 - lat1);
-    const float     dLon   = toRad(lon2 - lon1);
-    const float     x      = dLon * cosf(latRad) * R;
-    const float     y      = dLat * R;
-    return sqrtf(x * x + y * y) / 1000.0f; // km
+  void setOrigin(double lat) {
+    originLat    = lat;
+    cosOrigin    = Numeric<Num>::from(cosf(toRad(static_cast<float>(lat))));
+    sinOriginRad = Numeric<Num>::from(sinf(toRad(static_cast<float>(lat))) * PI / 180.0);
+  }
+
+  void setAnchor(double lat, double lon, bool isMoving) {
+    anchorLat = lat;
+    anchorLon = lon;
+    wasMoving = isMoving;
+  }
+
+  // cos(中間緯度) は origin 周りの一次近似で求め、更新ごとの三角関数を省く
+  Num stepMeters(double lat, double lon) const {
+    const Num midOffset = Numeric<Num>::from((anchorLat + lat) / 2.0 - originLat);
+    const Num cosMid    = cosOrigin - sinOriginRad * midOffset;
+    const Num north     = Numeric<Num>::from((lat - anchorLat) * M_PER_DEG);
+    const Num east      = Numeric<Num>::from((lon - anchorLon) * M_PER_DEG) * cosMid;
+    return Numeric<Num>::hypot(east, north);
   }
 };
+
+using Odometer = BasicOdometer<DomainNumber>;
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "../Config.h"
+#include "PoiIndex.h"
+
+// 最寄りの地点に近づいたら一度だけ通知する。REARM_RADIUS_M より離れるまで同じ地点は通知しない
+class PoiAlert {
+private:
+  bool              hasAlerted = false;
+  uint32_t          alerted    = 0; // 通知済みの地点の通し番号
+  PoiFormat::Record record;
+  float             distanceM  = 0.0f;
+  unsigned long     shownAt    = 0;
+  bool              isShown    = false;
+
+public:
+  // isFound: REARM_RADIUS_M 以内に地点があったか。新しく通知したら true
+  bool update(bool isFound, uint32_t index, const PoiFormat::Record &nearest, float nearestM,
+              unsigned long nowMs) {
+    if (!isFound || (hasAlerted && index != alerted)) hasAlerted = false;
+    if (!isFound) return false;
+
+    if (hasAlerted) {
+      distanceM = nearestM;
+      return false;
+    }
+    if (Config::Poi::ALERT_RADIUS_M < nearestM) return false;
+
+    hasAlerted = true;
+    alerted    = index;
+    record     = nearest;
+    distanceM  = nearestM;
+    shownAt    = nowMs;
+    isShown    = true;
+    return true;
+  }
+
+  bool isShowing(unsigned long nowMs) const {
+    return isShown && nowMs - shownAt < Config::Poi::ALERT_SHOW_MS;
+  }
+
+  const PoiFormat::Record &getRecord() const {
+    return record;
+  }
+
+  float getDistanceM() const {
+    return distanceM;
+  }
+};
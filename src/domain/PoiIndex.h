@@ -0,0 +1,178 @@
+#pragma once
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../Config.h"
+#include "MemorySource.h"
+
+// 地点 (POI) の空間索引。ホストで tools/poi を使って作り、Flash に置いて必要な部分だけを読む
+//
+// ファイル構成 (リトルエンディアン):
+//   Header | uint32_t cellStart[rows * cols + 1] | Record[count]
+// Record はセル (行優先) ごとに並べ、セル i の地点は cellStart[i] から cellStart[i + 1] の手前まで
+namespace PoiFormat {
+
+constexpr uint32_t MAGIC    = 0x31494F50; // "POI1"
+constexpr size_t   NAME_LEN = 11;
+
+enum class Kind : uint8_t { WATER, HAZARD, CHECKPOINT, OTHER };
+
+struct Header {
+  uint32_t magic;
+  uint32_t count;
+  int32_t  originLatE7; // グリッドの南西端 (1e-7 度)
+  int32_t  originLonE7;
+  int32_t  cellLatE7; // セルの大きさ
+  int32_t  cellLonE7;
+  uint16_t rows;
+  uint16_t cols;
+  uint32_t reserved;
+};
+
+struct Record {
+  int32_t latE7;
+  int32_t lonE7;
+  Kind    kind;
+  char    name[NAME_LEN]; // 終端の '\0' は名前が短いときだけ
+};
+
+static_assert(sizeof(Header) == 32, "Header layout is part of the file format");
+static_assert(sizeof(Record) == 20, "Record layout is part of the file format");
+
+} // namespace PoiFormat
+
+// Source は MemorySource や FlashFileSource のように
+// bool read(uint32_t offset, void *buffer, size_t length) を持つ
+template <typename Source> class PoiIndex {
+public:
+  struct Match {
+    uint32_t          index; // ファイル内の通し番号
+    PoiFormat::Record record;
+    float             distanceM;
+  };
+
+  // 1 回の問い合わせで読んだ量 (計測用)
+  struct Stats {
+    uint32_t cells   = 0;
+    uint32_t records = 0;
+  };
+
+private:
+  static constexpr size_t CHUNK = 16; // 一度に読む地点数
+
+  Source           &source;
+  PoiFormat::Header header;
+  bool              isOpen = false;
+  Stats             stats;
+
+public:
+  explicit PoiIndex(Source &source) : source(source) {}
+
+  bool open() {
+    isOpen = source.read(0, &header, sizeof(header)) && header.magic == PoiFormat::MAGIC &&
+             0 < header.rows && 0 < header.cols && 0 < header.cellLatE7 && 0 < header.cellLonE7;
+    return isOpen;
+  }
+
+  bool isReady() const {
+    return isOpen;
+  }
+
+  uint32_t getCount() const {
+    return isOpen ? header.count : 0;
+  }
+
+  const Stats &getStats() const {
+    return stats;
+  }
+
+  // radiusM 以内で最も近い地点
+  bool findNearest(double lat, double lon, float radiusM, Match &out) {
+    bool found = false;
+    forEachNear(lat, lon, radiusM, [&](const Match &match) {
+      if (!found || match.distanceM < out.distanceM) out = match;
+      found = true;
+    });
+    return found;
+  }
+
+  // radiusM 以内の地点ごとに f(const Match &) を呼ぶ。読むのは周囲のセルだけ
+  template <typename F> void forEachNear(double lat, double lon, float radiusM, F f) {
+    stats = Stats();
+    if (!isOpen || header.count == 0) return;
+
+    const double  mPerE7    = Config::Odometer::EARTH_RADIUS_M * PI / 180.0 / 1e7;
+    const float   mPerE7Lat = static_cast<float>(mPerE7);
+    const float   mPerE7Lon = static_cast<float>(mPerE7 * cos(lat * PI / 180.0));
+    const int32_t latE7     = static_cast<int32_t>(lround(lat * 1e7));
+    const int32_t lonE7     = static_cast<int32_t>(lround(lon * 1e7));
+    const int32_t dLatE7    = static_cast<int32_t>(radiusM / mPerE7Lat) + 1;
+    const int32_t dLonE7    = static_cast<int32_t>(radiusM / mPerE7Lon) + 1;
+
+    int32_t row0;
+    int32_t row1;
+    int32_t col0;
+    int32_t col1;
+    if (!toCells(latE7 - dLatE7, latE7 + dLatE7, header.originLatE7, header.cellLatE7,
+                 header.rows, row0, row1) ||
+        !toCells(lonE7 - dLonE7, lonE7 + dLonE7, header.originLonE7, header.cellLonE7,
+                 header.cols, col0, col1)) {
+      return;
+    }
+
+    const uint32_t tableOffset   = sizeof(PoiFormat::Header);
+    const uint32_t recordsOffset = tableOffset + (header.rows * header.cols + 1) * 4;
+    const float    radius2       = radiusM * radiusM;
+    for (int32_t row = row0; row <= row1; row++) {
+      // 同じ行で隣り合うセルの地点は連続しているので、まとめて読む
+      const uint32_t cell = row * header.cols + col0;
+      uint32_t       begin;
+      uint32_t       end;
+      if (!source.read(tableOffset + cell * 4, &begin, 4) ||
+          !source.read(tableOffset + (cell + col1 - col0 + 1) * 4, &end, 4) || header.count < end) {
+        return;
+      }
+      stats.cells += col1 - col0 + 1;
+
+      PoiFormat::Record chunk[CHUNK];
+      for (uint32_t i = begin; i < end; i += CHUNK) {
+        const uint32_t n = end - i < CHUNK ? end - i : CHUNK;
+        if (!source.read(recordsOffset + i * sizeof(chunk[0]), chunk, n * sizeof(chunk[0]))) return;
+        stats.records += n;
+
+        for (uint32_t j = 0; j < n; j++) {
+          const float north = (chunk[j].latE7 - latE7) * mPerE7Lat;
+          const float east  = (chunk[j].lonE7 - lonE7) * mPerE7Lon;
+          const float d2    = north * north + east * east;
+          if (radius2 < d2) continue;
+
+          Match match;
+          match.index     = i + j;
+          match.record    = chunk[j];
+          match.distanceM = sqrtf(d2);
+          f(static_cast<const Match &>(match));
+        }
+      }
+    }
+  }
+
+private:
+  // [low, high] と重なるセルの範囲。グリッドの外なら false
+  static bool toCells(int32_t low, int32_t high, int32_t origin, int32_t cell, int32_t cells,
+                      int32_t &first, int32_t &last) {
+    const int64_t lowCell  = floorDiv(static_cast<int64_t>(low) - origin, cell);
+    const int64_t highCell = floorDiv(static_cast<int64_t>(high) - origin, cell);
+    if (highCell < 0 || cells <= lowCell) return false;
+    first = static_cast<int32_t>(lowCell < 0 ? 0 : lowCell);
+    last  = static_cast<int32_t>(cells <= highCell ? cells - 1 : highCell);
+    return true;
+  }
+
+  static int64_t floorDiv(int64_t a, int64_t b) {
+    return a < 0 ? -((-a + b - 1) / b) : a / b;
+  }
+};
+
+template <typename Source> constexpr size_t PoiIndex<Source>::CHUNK;
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// 終えた走行 1 回分の要約。TripHistory はこの形のまま Flash に並べる
+struct RideSummary {
+  uint32_t startEpoch    = 0; // Clock::getEpoch()。不明なら 0
+  uint32_t distanceM     = 0;
+  uint32_t movingTimeMs  = 0;
+  uint32_t elapsedTimeMs = 0;
+  float    avgKmh        = 0.0f;
+  float    maxKmh        = 0.0f;
+  uint32_t reserved      = 0;
+  uint32_t crc           = 0; // ここより前の全体
+};
+
+static_assert(sizeof(RideSummary) == 32, "RideSummary layout is part of the history format");
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// 一定幅のバケットを並べたリングバッファで、直近の時間加重平均速度を O(1) で求める
+// 窓は確定した BUCKETS - 1 個のバケットと、書き込み中のバケットからなる
+template <size_t BUCKETS> class RollingAverage {
+  static_assert(1 < BUCKETS, "RollingAverage needs at least two buckets");
+
+private:
+  struct Bucket {
+    uint32_t centiKmhMs = 0; // 速度 [0.01 km/h] x 時間 [ms]
+    uint32_t ms         = 0;
+  };
+
+  const unsigned long bucketMs;
+  Bucket              buckets[BUCKETS];
+  size_t              head       = 0;
+  uint64_t            sumCentiMs = 0; // 整数で持ち、加減算を繰り返しても誤差が溜まらないようにする
+  uint64_t            sumMs      = 0;
+
+public:
+  explicit RollingAverage(unsigned long bucketMs) : bucketMs(bucketMs) {}
+
+  void add(float kmh, unsigned long dtMs) {
+    if (BUCKETS * bucketMs <= dtMs) {
+      reset(); // 窓全体より長い間隔は、それまでの履歴を捨てる
+      dtMs = (BUCKETS - 1) * bucketMs + dtMs % bucketMs;
+    }
+
+    const uint32_t centiKmh = kmh <= 0.0f ? 0 : static_cast<uint32_t>(kmh * 100.0f + 0.5f);
+    while (0 < dtMs) {
+      Bucket             &bucket = buckets[head];
+      const unsigned long room   = bucketMs - bucket.ms;
+      const unsigned long part   = dtMs < room ? dtMs : room;
+
+      bucket.ms += part;
+      bucket.centiKmhMs += centiKmh * part;
+      sumMs += part;
+      sumCentiMs += static_cast<uint64_t>(centiKmh) * part;
+      dtMs -= part;
+
+      if (bucket.ms == bucketMs) advance();
+    }
+  }
+
+  void reset() {
+    for (size_t i = 0; i < BUCKETS; i++) buckets[i] = Bucket();
+    head       = 0;
+    sumCentiMs = 0;
+    sumMs      = 0;
+  }
+
+  float get() const {
+    if (sumMs == 0) return 0.0f;
+    return static_cast<float>(sumCentiMs) / static_cast<float>(sumMs) / 100.0f;
+  }
+
+private:
+  void advance() {
+    head          = (head + 1) % BUCKETS;
+    Bucket &stale = buckets[head];
+    sumCentiMs -= stale.centiKmhMs;
+    sumMs -= stale.ms;
+    stale = Bucket();
+  }
+};
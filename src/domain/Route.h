@@ -0,0 +1,237 @@
+#pragma once
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../Config.h"
+
+// 走る予定の経路。ホストで tools/route を使って作り、起動時に Flash から RAM に読み込む
+//
+// ファイル構成 (リトルエンディアン): Header | Point[count]
+namespace RouteFormat {
+
+constexpr uint32_t MAGIC = 0x31455452; // "RTE1"
+
+struct Header {
+  uint32_t magic;
+  uint32_t count;
+};
+
+struct Point {
+  int32_t latE7;
+  int32_t lonE7;
+};
+
+static_assert(sizeof(Header) == 8, "Header layout is part of the file format");
+static_assert(sizeof(Point) == 8, "Point layout is part of the file format");
+
+} // namespace RouteFormat
+
+// 線分 i は points[i] から points[i + 1] まで。距離は経路の中央の緯度で作った局所平面で求める
+// 道を外れたあとの再捕捉のため、各線分を始点のセルに登録した格子も持つ
+class Route {
+public:
+  // 点 (latE7, lonE7) から線分への最短距離と、線分の始点から足までの距離
+  struct Projection {
+    float distanceM;
+    float alongM;
+  };
+
+private:
+  static constexpr size_t CAPACITY   = Config::Route::CAPACITY;
+  static constexpr size_t GRID_CELLS = Config::Route::GRID_CELLS;
+  static_assert(CAPACITY <= UINT16_MAX, "segment indices are stored as uint16_t");
+
+  RouteFormat::Point points[CAPACITY];
+  float              cumulativeM[CAPACITY]; // 始点から各点までの距離
+  size_t             count = 0;
+
+  float mPerE7Lat = 0.0f;
+  float mPerE7Lon = 0.0f;
+
+  int32_t  originLatE7 = 0;
+  int32_t  originLonE7 = 0;
+  int32_t  cellLatE7   = 1;
+  int32_t  cellLonE7   = 1;
+  uint16_t rows        = 0;
+  uint16_t cols        = 0;
+  uint16_t cellStart[GRID_CELLS + 1];
+  uint16_t cellSegments[CAPACITY];
+
+public:
+  // Source は MemorySource や FlashFileSource
+  template <typename Source> bool load(Source &source) {
+    RouteFormat::Header header;
+    count = 0;
+    if (!source.read(0, &header, sizeof(header)) || header.magic != RouteFormat::MAGIC ||
+        header.count < 2 || CAPACITY < header.count) {
+      return false;
+    }
+    if (!source.read(sizeof(header), points, header.count * sizeof(points[0]))) return false;
+    return set(points, header.count);
+  }
+
+  // points は自身の配列でもよい
+  bool set(const RouteFormat::Point *source, size_t n) {
+    count = 0;
+    if (n < 2 || CAPACITY < n) return false;
+    for (size_t i = 0; i < n; i++) points[i] = source[i];
+    count = n;
+
+    int32_t latMin = points[0].latE7;
+    int32_t latMax = latMin;
+    for (size_t i = 1; i < count; i++) {
+      if (points[i].latE7 < latMin) latMin = points[i].latE7;
+      if (latMax < points[i].latE7) latMax = points[i].latE7;
+    }
+    const double mPerE7 = Config::Odometer::EARTH_RADIUS_M * PI / 180.0 / 1e7;
+    mPerE7Lat           = static_cast<float>(mPerE7);
+    mPerE7Lon           = static_cast<float>(mPerE7 * cos((latMin + latMax) / 2e7 * PI / 180.0));
+
+    float maxSegmentM = 0.0f;
+    cumulativeM[0]    = 0.0f;
+    for (size_t i = 1; i < count; i++) {
+      const float segmentM = segmentLengthM(i - 1);
+      cumulativeM[i]       = cumulativeM[i - 1] + segmentM;
+      if (maxSegmentM < segmentM) maxSegmentM = segmentM;
+    }
+    buildGrid(maxSegmentM);
+    return true;
+  }
+
+  void clear() {
+    count = 0;
+  }
+
+  size_t getCount() const {
+    return count;
+  }
+
+  size_t getSegmentCount() const {
+    return count < 2 ? 0 : count - 1;
+  }
+
+  float getLengthM() const {
+    return count < 2 ? 0.0f : cumulativeM[count - 1];
+  }
+
+  float getCumulativeM(size_t index) const {
+    return cumulativeM[index];
+  }
+
+  const RouteFormat::Point &getPoint(size_t index) const {
+    return points[index];
+  }
+
+  Projection project(int32_t latE7, int32_t lonE7, size_t segment) const {
+    const RouteFormat::Point &a  = points[segment];
+    const RouteFormat::Point &b  = points[segment + 1];
+    const float               dx = (b.lonE7 - a.lonE7) * mPerE7Lon;
+    const float               dy = (b.latE7 - a.latE7) * mPerE7Lat;
+    const float               px = (lonE7 - a.lonE7) * mPerE7Lon;
+    const float               py = (latE7 - a.latE7) * mPerE7Lat;
+    const float               l2 = dx * dx + dy * dy;
+
+    float t = l2 <= 0.0f ? 0.0f : (px * dx + py * dy) / l2;
+    if (t < 0.0f) t = 0.0f;
+    if (1.0f < t) t = 1.0f;
+
+    const float ex = px - t * dx;
+    const float ey = py - t * dy;
+    return {sqrtf(ex * ex + ey * ey), t * sqrtf(l2)};
+  }
+
+  // radiusM 以内にありうる線分ごとに f(size_t segment) を呼ぶ (より遠い線分も混じる)
+  template <typename F>
+  void forEachSegmentNear(int32_t latE7, int32_t lonE7, float radiusM, F f) const {
+    if (count < 2) return;
+
+    // 線分はセルより短いので、始点は radiusM + セル 1 つ分の範囲にある
+    const int64_t reachLat = static_cast<int64_t>(radiusM / mPerE7Lat) + cellLatE7;
+    const int64_t reachLon = static_cast<int64_t>(radiusM / mPerE7Lon) + cellLonE7;
+    int32_t       row0;
+    int32_t       row1;
+    int32_t       col0;
+    int32_t       col1;
+    if (!toCells(latE7 - reachLat, latE7 + reachLat, originLatE7, cellLatE7, rows, row0, row1) ||
+        !toCells(lonE7 - reachLon, lonE7 + reachLon, originLonE7, cellLonE7, cols, col0, col1)) {
+      return;
+    }
+
+    for (int32_t row = row0; row <= row1; row++) {
+      const size_t first = cellStart[row * cols + col0];
+      const size_t last  = cellStart[row * cols + col1 + 1];
+      for (size_t i = first; i < last; i++) f(static_cast<size_t>(cellSegments[i]));
+    }
+  }
+
+private:
+  float segmentLengthM(size_t segment) const {
+    const float dx = (points[segment + 1].lonE7 - points[segment].lonE7) * mPerE7Lon;
+    const float dy = (points[segment + 1].latE7 - points[segment].latE7) * mPerE7Lat;
+    return sqrtf(dx * dx + dy * dy);
+  }
+
+  // セルは最長の線分以上、セル数は GRID_CELLS 以下にする
+  void buildGrid(float maxSegmentM) {
+    int32_t latMax = points[0].latE7;
+    int32_t lonMax = points[0].lonE7;
+    originLatE7    = latMax;
+    originLonE7    = lonMax;
+    for (size_t i = 1; i < count; i++) {
+      if (points[i].latE7 < originLatE7) originLatE7 = points[i].latE7;
+      if (latMax < points[i].latE7) latMax = points[i].latE7;
+      if (points[i].lonE7 < originLonE7) originLonE7 = points[i].lonE7;
+      if (lonMax < points[i].lonE7) lonMax = points[i].lonE7;
+    }
+
+    float cellM = maxSegmentM < Config::Route::OFF_COURSE_M ? Config::Route::OFF_COURSE_M
+                                                             : maxSegmentM;
+    while (true) {
+      cellLatE7 = static_cast<int32_t>(cellM / mPerE7Lat) + 1;
+      cellLonE7 = static_cast<int32_t>(cellM / mPerE7Lon) + 1;
+      const int64_t r = (static_cast<int64_t>(latMax) - originLatE7) / cellLatE7 + 1;
+      const int64_t c = (static_cast<int64_t>(lonMax) - originLonE7) / cellLonE7 + 1;
+      if (r * c <= static_cast<int64_t>(GRID_CELLS)) {
+        rows = static_cast<uint16_t>(r);
+        cols = static_cast<uint16_t>(c);
+        break;
+      }
+      cellM *= 1.25f;
+    }
+
+    // 始点のセルで数え上げソートする
+    const size_t cells = static_cast<size_t>(rows) * cols;
+    for (size_t i = 0; i <= cells; i++) cellStart[i] = 0;
+    for (size_t i = 0; i + 1 < count; i++) cellStart[cellOf(points[i]) + 1]++;
+    for (size_t i = 0; i < cells; i++) cellStart[i + 1] += cellStart[i];
+    for (size_t i = 0; i + 1 < count; i++) {
+      // cellStart[cell] を書き込み位置として進め、あとで 1 つずつ戻す
+      cellSegments[cellStart[cellOf(points[i])]++] = static_cast<uint16_t>(i);
+    }
+    for (size_t i = cells; 0 < i; i--) cellStart[i] = cellStart[i - 1];
+    cellStart[0] = 0;
+  }
+
+  size_t cellOf(const RouteFormat::Point &point) const {
+    const size_t row = static_cast<size_t>((point.latE7 - originLatE7) / cellLatE7);
+    const size_t col = static_cast<size_t>((point.lonE7 - originLonE7) / cellLonE7);
+    return row * cols + col;
+  }
+
+  // [low, high] と重なるセルの範囲。格子の外なら false
+  static bool toCells(int64_t low, int64_t high, int32_t origin, int32_t cell, int32_t cells,
+                      int32_t &first, int32_t &last) {
+    const int64_t lowCell  = floorDiv(low - origin, cell);
+    const int64_t highCell = floorDiv(high - origin, cell);
+    if (highCell < 0 || cells <= lowCell) return false;
+    first = static_cast<int32_t>(lowCell < 0 ? 0 : lowCell);
+    last  = static_cast<int32_t>(cells <= highCell ? cells - 1 : highCell);
+    return true;
+  }
+
+  static int64_t floorDiv(int64_t a, int64_t b) {
+    return a < 0 ? -((-a + b - 1) / b) : a / b;
+  }
+};
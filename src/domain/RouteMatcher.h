@@ -0,0 +1,155 @@
+#pragma once
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../Config.h"
+#include "Route.h"
+
+// 測位点を経路上の位置に対応付け、残り距離とコース外れを求める
+// 通常は前回の線分の前後 (窓) だけを調べるので、1 回の更新は経路の長さによらない
+// 窓で見つからないとき (初回・寄り道からの復帰・近道) だけ Route の格子で探し直す
+class RouteMatcher {
+public:
+  // 直近の更新で調べた量 (計測用)
+  struct Stats {
+    uint32_t segments = 0;
+    bool     usedGrid = false;
+  };
+
+private:
+  struct Candidate {
+    size_t segment   = 0;
+    float  distanceM = INFINITY;
+    float  alongM    = 0.0f;
+  };
+
+  const Route &route;
+  size_t       segment     = 0;
+  float        alongM      = 0.0f; // 線分の始点からの距離
+  float        offsetM     = 0.0f; // 経路からの距離
+  bool         isMatched   = false;
+  bool         isOffCourse = false;
+  Stats        stats;
+
+public:
+  explicit RouteMatcher(const Route &route) : route(route) {}
+
+  void reset() {
+    segment     = 0;
+    alongM      = 0.0f;
+    offsetM     = 0.0f;
+    isMatched   = false;
+    isOffCourse = false;
+  }
+
+  void update(double lat, double lon) {
+    stats = Stats();
+    if (route.getSegmentCount() == 0) return;
+
+    const int32_t latE7 = static_cast<int32_t>(lround(lat * 1e7));
+    const int32_t lonE7 = static_cast<int32_t>(lround(lon * 1e7));
+
+    Candidate best;
+    if (isMatched) best = searchWindow(latE7, lonE7, segment);
+    // 戻るときは ON_COURSE_M まで近づく必要があるので、格子でも同じ基準で探す
+    const float threshold =
+        isMatched && !isOffCourse ? Config::Route::OFF_COURSE_M : Config::Route::ON_COURSE_M;
+    if (threshold < best.distanceM) {
+      const Candidate found = searchGrid(latE7, lonE7, threshold);
+      // 格子では最初に条件を満たした線分を選ぶので、その周りで最も近い線分に寄せる
+      if (found.distanceM <= threshold) best = searchWindow(latE7, lonE7, found.segment);
+    }
+
+    if (best.distanceM <= threshold) {
+      segment     = best.segment;
+      alongM      = best.alongM;
+      offsetM     = best.distanceM;
+      isMatched   = true;
+      isOffCourse = false;
+      return;
+    }
+    if (!isMatched) return;
+    isOffCourse = true;
+    offsetM     = best.distanceM;
+  }
+
+  bool hasRoute() const {
+    return 0 < route.getSegmentCount();
+  }
+
+  bool isMatching() const {
+    return isMatched;
+  }
+
+  bool isOff() const {
+    return isOffCourse;
+  }
+
+  // コース外の間は最後に対応付けた位置のまま
+  float getDistanceToGoM() const {
+    if (!isMatched) return route.getLengthM();
+    const float remaining = route.getLengthM() - route.getCumulativeM(segment) - alongM;
+    return remaining < 0.0f ? 0.0f : remaining;
+  }
+
+  float getOffsetM() const {
+    return offsetM;
+  }
+
+  size_t getSegment() const {
+    return segment;
+  }
+
+  const Stats &getStats() const {
+    return stats;
+  }
+
+private:
+  Candidate searchWindow(int32_t latE7, int32_t lonE7, size_t center) {
+    const size_t segments = route.getSegmentCount();
+    const size_t back     = Config::Route::WINDOW_BACK;
+    const size_t first    = back < center ? center - back : 0;
+    size_t       last     = center + Config::Route::WINDOW_AHEAD;
+    if (segments <= last) last = segments - 1;
+
+    Candidate best;
+    for (size_t i = first; i <= last; i++) consider(latE7, lonE7, i, best);
+    return best;
+  }
+
+  // threshold 以内の線分のうち、前回の線分以降で最初のものを選ぶ (往復する経路で逆向きに乗らない)
+  // 前回以降になければ最も番号の小さいもの、threshold 以内がなければ最も近いもの
+  Candidate searchGrid(int32_t latE7, int32_t lonE7, float threshold) {
+    stats.usedGrid = true;
+
+    Candidate nearest;
+    Candidate ahead;
+    Candidate lowest;
+    ahead.segment  = SIZE_MAX;
+    lowest.segment = SIZE_MAX;
+    const size_t from = isMatched ? segment : 0;
+    route.forEachSegmentNear(latE7, lonE7, threshold, [&](size_t i) {
+      Candidate candidate;
+      consider(latE7, lonE7, i, candidate);
+      if (candidate.distanceM < nearest.distanceM) nearest = candidate;
+      if (threshold < candidate.distanceM) return;
+      if (from <= i && i < ahead.segment) ahead = candidate;
+      if (i < lowest.segment) lowest = candidate;
+    });
+
+    if (ahead.segment != SIZE_MAX) return ahead;
+    if (lowest.segment != SIZE_MAX) return lowest;
+    return nearest;
+  }
+
+  void consider(int32_t latE7, int32_t lonE7, size_t i, Candidate &best) {
+    stats.segments++;
+    const Route::Projection p = route.project(latE7, lonE7, i);
+    if (best.distanceM <= p.distanceM) return;
+    best.segment   = i;
+    best.distanceM = p.distanceM;
+    best.alongM    = p.alongM;
+  }
+};
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "../Config.h"
+
+// GNSS の速度サンプルを alpha-beta フィルタで平滑化し、次のサンプルまでの間を外挿する
+class SpeedEstimator {
+private:
+  float    kmh            = 0.0f; // 最終サンプル時刻での推定速度
+  float    accelKmhPerSec = 0.0f;
+  float    currentKmh     = 0.0f;
+  uint32_t lastSampleMs   = 0; // millis() が一周しても差が正しくなるよう 32 ビットで持つ
+  bool     hasSample      = false;
+
+public:
+  void addSample(float measuredKmh, uint32_t timeMs) {
+    const uint32_t dtMs = timeMs - lastSampleMs;
+
+    if (!hasSample || Config::SpeedEstimator::MAX_SAMPLE_GAP_MS < dtMs || measuredKmh <= 0.0f) {
+      kmh            = measuredKmh < 0.0f ? 0.0f : measuredKmh; // 停止は即座に反映する
+      accelKmhPerSec = 0.0f;
+      lastSampleMs   = timeMs;
+      hasSample      = true;
+      return;
+    }
+    if (dtMs == 0) return;
+
+    const float dt        = dtMs / 1000.0f;
+    const float predicted = kmh + accelKmhPerSec * dt;
+    const float residual  = measuredKmh - predicted;
+
+    kmh = predicted + Config::SpeedEstimator::ALPHA * residual;
+    accelKmhPerSec += Config::SpeedEstimator::BETA * residual / dt;
+    accelKmhPerSec = clamp(accelKmhPerSec, Config::SpeedEstimator::MAX_ACCEL_KMH_PER_S);
+    if (kmh < 0.0f) kmh = 0.0f;
+    lastSampleMs = timeMs;
+  }
+
+  void update(uint32_t nowMs) {
+    if (!hasSample) {
+      currentKmh = 0.0f;
+      return;
+    }
+
+    uint32_t elapsedMs = nowMs - lastSampleMs;
+    if (Config::SpeedEstimator::MAX_EXTRAPOLATION_MS < elapsedMs) {
+      elapsedMs = Config::SpeedEstimator::MAX_EXTRAPOLATION_MS; // それ以上は保持
+    }
+
+    const float delta = clamp(accelKmhPerSec * (elapsedMs / 1000.0f),
+                              Config::SpeedEstimator::MAX_EXTRAPOLATION_KMH);
+    currentKmh        = kmh + delta;
+    if (currentKmh < 0.0f) currentKmh = 0.0f;
+  }
+
+  void reset() {
+    kmh            = 0.0f;
+    accelKmhPerSec = 0.0f;
+    currentKmh     = 0.0f;
+    hasSample      = false;
+  }
+
+  float get() const {
+    return currentKmh;
+  }
+
+  float getAccel() const {
+    return accelKmhPerSec;
+  }
+
+private:
+  static float clamp(float value, float limit) {
+    if (value < -limit) return -limit;
+    if (limit < value) return limit;
+    return value;
+  }
+};
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../Config.h"
+
+// 速度帯ごとの滞在時間を固定幅のビンに積算する。サンプル自体は保持しない
+class SpeedHistogram {
+public:
+  static constexpr size_t BINS       = Config::SpeedHistogram::BINS;
+  static constexpr size_t ZONE_COUNT = sizeof(Config::SpeedHistogram::ZONES_KMH) / sizeof(float);
+
+private:
+  uint64_t binMs[BINS] = {}; // 何か月分でも桁あふれしない
+  uint64_t totalMs     = 0;
+
+public:
+  void add(float kmh, uint32_t dtMs) {
+    binMs[binOf(kmh)] += dtMs;
+    totalMs += dtMs;
+  }
+
+  void reset() {
+    for (size_t i = 0; i < BINS; i++) binMs[i] = 0;
+    totalMs = 0;
+  }
+
+  uint64_t getTotalMs() const {
+    return totalMs;
+  }
+
+  uint64_t getBinMs(size_t bin) const {
+    return binMs[bin];
+  }
+
+  // 累積時間が ratio (0 - 1) に達する速度。ビン内は一様に分布しているとみなす
+  float getPercentile(float ratio) const {
+    if (totalMs == 0) return 0.0f;
+
+    const float target     = ratio * totalMs;
+    float       cumulative = 0.0f;
+    size_t      last       = 0;
+    for (size_t i = 0; i < BINS; i++) {
+      if (binMs[i] == 0) continue;
+      if (target <= cumulative + binMs[i]) {
+        return (i + (target - cumulative) / binMs[i]) * Config::SpeedHistogram::BIN_KMH;
+      }
+      cumulative += binMs[i];
+      last = i;
+    }
+    return (last + 1) * Config::SpeedHistogram::BIN_KMH;
+  }
+
+  // [lowKmh, highKmh) に滞在した時間。境界にかかるビンは幅の比で按分する
+  uint64_t getTimeInRangeMs(float lowKmh, float highKmh) const {
+    const float width = Config::SpeedHistogram::BIN_KMH;
+    const float top   = BINS * width;
+    if (top <= highKmh) highKmh = INFINITY; // 最後のビンは上限がない
+
+    uint64_t full    = 0;
+    float    partial = 0.0f;
+    for (size_t i = 0; i < BINS; i++) {
+      const float binLow  = i * width;
+      const float binHigh = i + 1 < BINS ? binLow + width : INFINITY;
+      if (binMs[i] == 0 || highKmh <= binLow || binHigh <= lowKmh) continue;
+      if (lowKmh <= binLow && binHigh <= highKmh) {
+        full += binMs[i];
+        continue;
+      }
+
+      const float low  = lowKmh < binLow ? binLow : lowKmh;
+      const float high = highKmh < binLow + width ? highKmh : binLow + width;
+      if (low < high) partial += binMs[i] * (high - low) / width;
+    }
+    return full + static_cast<uint64_t>(partial + 0.5f);
+  }
+
+  uint64_t getZoneMs(size_t zone) const {
+    const float *zones = Config::SpeedHistogram::ZONES_KMH;
+    return getTimeInRangeMs(zones[zone], zone + 1 < ZONE_COUNT ? zones[zone + 1] : INFINITY);
+  }
+
+private:
+  static size_t binOf(float kmh) {
+    if (kmh <= 0.0f) return 0;
+    const size_t bin = static_cast<size_t>(kmh / Config::SpeedHistogram::BIN_KMH);
+    return bin < BINS ? bin : BINS - 1;
+  }
+};
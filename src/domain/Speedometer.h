@@ -1,31 +1,70 @@
 #pragma once
 
-class Speedometer {
+#include <stdint.h>
+
+#include "../Config.h"
+#include "Numeric.h"
+#include "RollingAverage.h"
+
+template <typename Num> class BasicSpeedometer {
 private:
   struct Speed {
-    float curKmh = 0.0f;
-    float maxKmh = 0.0f;
-    float avgKmh = 0.0f;
+    Num curKmh = Num();
+    Num maxKmh = Num();
+    Num avgKmh = Num();
   };
 
   Speed speed;
 
+  RollingAverage<Config::RollingSpeed::SHORT_BUCKETS> avgShort;
+  RollingAverage<Config::RollingSpeed::MID_BUCKETS>   avgMid;
+  RollingAverage<Config::RollingSpeed::LONG_BUCKETS>  avgLong;
+
 public:
-  void update(float curKmh, unsigned long movingTimeMs, float totalKm) {
+  BasicSpeedometer()
+      : avgShort(Config::RollingSpeed::SHORT_BUCKET_MS),
+        avgMid(Config::RollingSpeed::MID_BUCKET_MS),
+        avgLong(Config::RollingSpeed::LONG_BUCKET_MS) {}
+
+  // 平均は積算した mm と ms の比から一度に求め、km や時間に直す丸めを重ねない
+  void update(Num curKmh, uint32_t dtMs, uint64_t movingTimeMs, uint64_t totalMm) {
+    const float kmh = Numeric<Num>::toFloat(curKmh);
+    avgShort.add(kmh, dtMs);
+    avgMid.add(kmh, dtMs);
+    avgLong.add(kmh, dtMs);
+
     speed.curKmh = curKmh;
     if (speed.maxKmh < speed.curKmh) speed.maxKmh = speed.curKmh;
-    if (0 < movingTimeMs) speed.avgKmh = totalKm / (movingTimeMs / (60.0f * 60.0f * 1000.0f));
+    if (0 < movingTimeMs) speed.avgKmh = Numeric<Num>::fromRatio(totalMm * 36, movingTimeMs * 10);
+  }
+
+  void restoreMax(float maxKmh) {
+    speed.maxKmh = Numeric<Num>::from(maxKmh);
   }
 
   float getCur() const {
-    return speed.curKmh;
+    return Numeric<Num>::toFloat(speed.curKmh);
   }
 
   float getMax() const {
-    return speed.maxKmh;
+    return Numeric<Num>::toFloat(speed.maxKmh);
   }
 
   float getAvg() const {
-    return speed.avgKmh;
+    return Numeric<Num>::toFloat(speed.avgKmh);
+  }
+
+  float getAvg10s() const {
+    return avgShort.get();
+  }
+
+  float getAvg1min() const {
+    return avgMid.get();
+  }
+
+  float getAvg5min() const {
+    return avgLong.get();
   }
 };
+
+using Speedometer = BasicSpeedometer<DomainNumber>;
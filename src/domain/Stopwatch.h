@@ -1,17 +1,20 @@
 #pragma once
 
+#include <stdint.h>
+
+// 時間は 64 ビットの ms で積算し、何か月動かしても桁あふれしない
 class Stopwatch {
 private:
   struct Duration {
-    unsigned long movingTimeMs = 0;
-    unsigned long totalTimeMs  = 0;
+    uint64_t movingTimeMs = 0;
+    uint64_t totalTimeMs  = 0;
   };
 
   Duration duration;
   bool     isPaused = false;
 
 public:
-  void update(bool isMoving, unsigned long dt) {
+  void update(bool isMoving, uint32_t dt) {
     if (isMoving) duration.movingTimeMs += dt;
     if (!isPaused) duration.totalTimeMs += dt;
   }
@@ -29,16 +32,21 @@ public:
     resetMovingTime();
   }
 
+  void restore(uint64_t movingTimeMs, uint64_t totalTimeMs) {
+    duration.movingTimeMs = movingTimeMs;
+    duration.totalTimeMs  = totalTimeMs;
+  }
+
   void pause() {
     if (isPaused) isPaused = false;
     else isPaused = true;
   }
 
-  unsigned long getMovingTimeMs() const {
+  uint64_t getMovingTimeMs() const {
     return duration.movingTimeMs;
   }
 
-  unsigned long getElapsedTimeMs() const {
+  uint64_t getElapsedTimeMs() const {
     return duration.totalTimeMs;
   }
 };
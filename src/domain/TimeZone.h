@@ -0,0 +1,126 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../Config.h"
+
+// 時間帯の規則。TimeZoneIndex のファイルにもこの形のまま入る (リトルエンディアン)
+namespace TzFormat {
+
+// 夏時間の切り替え。month 月の第 week (5 は最終) weekday 曜日 (0 は日曜) の、
+// 切り替え前の地方時で minute 分
+struct Rule {
+  uint8_t month;
+  uint8_t week;
+  uint8_t weekday;
+  uint8_t reserved;
+  int16_t minute;
+};
+
+struct Zone {
+  int16_t stdOffsetMin; // UTC からの差。東が正
+  int16_t dstSaveMin;   // 夏時間に足す分。0 なら夏時間なし
+  Rule    start;
+  Rule    end;
+};
+
+static_assert(sizeof(Rule) == 6, "Rule layout is part of the file format");
+static_assert(sizeof(Zone) == 16, "Zone layout is part of the file format");
+
+} // namespace TzFormat
+
+// 時間帯の規則から、ある時点の UTC からの差を求める
+class TimeZone {
+public:
+  static constexpr int32_t EPOCH_DAYS = 10957; // 1970-01-01 から 2000-01-01 までの日数
+
+private:
+  TzFormat::Zone zone;
+
+public:
+  TimeZone() : zone(fixed(Config::Time::DEFAULT_OFFSET_MIN)) {}
+  explicit TimeZone(const TzFormat::Zone &zone) : zone(zone) {}
+
+  const TzFormat::Zone &get() const {
+    return zone;
+  }
+
+  // epoch は 2000-01-01 00:00:00 UTC からの秒
+  int getOffsetMin(uint32_t epoch) const {
+    uint32_t until;
+    return getOffsetMin(epoch, until);
+  }
+
+  // until には、次に時差が変わりうる時点を入れる。それまでは同じ値を使い回せる
+  int getOffsetMin(uint32_t epoch, uint32_t &until) const {
+    until = UINT32_MAX;
+    if (zone.dstSaveMin == 0) return zone.stdOffsetMin;
+
+    // 切り替えは年に 2 回なので、標準時で見た年の分だけを求める
+    int           year;
+    int           month;
+    int           day;
+    const int64_t t = epoch;
+    civilFromDays(static_cast<int32_t>((t + zone.stdOffsetMin * 60) / 86400 + EPOCH_DAYS), year,
+                  month, day);
+    const int64_t start   = toTransition(year, zone.start, zone.stdOffsetMin);
+    const int64_t end     = toTransition(year, zone.end, zone.stdOffsetMin + zone.dstSaveMin);
+    const int32_t newYear = daysFromCivil(year + 1, 1, 1) - EPOCH_DAYS;
+    int64_t       next    = static_cast<int64_t>(newYear) * 86400 - zone.stdOffsetMin * 60;
+    if (t < start && start < next) next = start;
+    if (t < end && end < next) next = end;
+    if (next < UINT32_MAX) until = static_cast<uint32_t>(next);
+
+    const bool inDst = start < end ? start <= t && t < end
+                                   : t < end || start <= t; // 南半球は年をまたぐ
+    return zone.stdOffsetMin + (inDst ? zone.dstSaveMin : 0);
+  }
+
+  bool isDst(uint32_t epoch) const {
+    return getOffsetMin(epoch) != zone.stdOffsetMin;
+  }
+
+  // 夏時間のない時間帯
+  static TzFormat::Zone fixed(int offsetMin) {
+    TzFormat::Zone zone = TzFormat::Zone();
+    zone.stdOffsetMin   = static_cast<int16_t>(offsetMin);
+    return zone;
+  }
+
+  // 1970-01-01 からの日数 (H. Hinnant)
+  static int32_t daysFromCivil(int y, int m, int d) {
+    y -= m <= 2 ? 1 : 0;
+    const int32_t  era = (y >= 0 ? y : y - 399) / 400;
+    const uint32_t yoe = static_cast<uint32_t>(y - era * 400);
+    const uint32_t doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    const uint32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<int32_t>(doe) - 719468;
+  }
+
+  // daysFromCivil の逆 (H. Hinnant)
+  static void civilFromDays(int32_t days, int &year, int &month, int &day) {
+    const int32_t  z   = days + 719468;
+    const int32_t  era = (z >= 0 ? z : z - 146096) / 146097;
+    const uint32_t doe = static_cast<uint32_t>(z - era * 146097);
+    const uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const uint32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const uint32_t mp  = (5 * doy + 2) / 153;
+
+    day   = static_cast<int>(doy - (153 * mp + 2) / 5 + 1);
+    month = static_cast<int>(mp < 10 ? mp + 3 : mp - 9);
+    year  = static_cast<int>(yoe) + era * 400 + (month <= 2 ? 1 : 0);
+  }
+
+private:
+  // year 年の切り替えの時点 (2000-01-01 UTC からの秒)。offsetMin は切り替え前の UTC からの差
+  static int64_t toTransition(int year, const TzFormat::Rule &rule, int offsetMin) {
+    const int32_t first   = daysFromCivil(year, rule.month, 1);
+    const int32_t next    = rule.month == 12 ? daysFromCivil(year + 1, 1, 1)
+                                             : daysFromCivil(year, rule.month + 1, 1);
+    const int     weekday = static_cast<int>((first % 7 + 11) % 7); // 1970-01-01 は木曜
+    int32_t       day     = first + (rule.weekday - weekday + 7) % 7 + (rule.week - 1) * 7;
+    while (next <= day) day -= 7; // 第 5 週がなければ最終週
+    return (static_cast<int64_t>(day) - EPOCH_DAYS) * 86400 + (rule.minute - offsetMin) * 60;
+  }
+};
@@ -0,0 +1,264 @@
+#pragma once
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "../Config.h"
+#include "MemorySource.h"
+#include "TimeZone.h"
+
+// 時間帯の境界の索引。ホストで tools/tz を使って境界を間引いた多角形と粗いグリッドにまとめ、
+// Flash に置いて必要な部分だけを読む
+//
+// ファイル構成 (リトルエンディアン):
+//   Header | Zone[zoneCount] | Polygon[polygonCount] | Vertex[vertexCount]
+//   | uint32_t cellStart[rows * cols + 1] | uint16_t candidate[candidateCount]
+// セル i の候補は candidate[cellStart[i]] から candidate[cellStart[i + 1]] の手前まで。
+// 候補は境界がそのセルを通る多角形の番号で、FULL を付けたものはセル全体を覆う時間帯の番号
+// (候補の最後に置く)
+namespace TzFormat {
+
+constexpr uint32_t MAGIC = 0x31495A54; // "TZI1"
+constexpr uint16_t FULL  = 0x8000;
+
+struct Header {
+  uint32_t magic;
+  uint16_t zoneCount;
+  uint16_t polygonCount;
+  uint32_t vertexCount;
+  uint32_t candidateCount;
+  int32_t  originLatE7; // グリッドの南西端 (1e-7 度)
+  int32_t  originLonE7;
+  int32_t  cellLatE7; // セルの大きさ
+  int32_t  cellLonE7;
+  uint16_t rows;
+  uint16_t cols;
+  uint32_t reserved;
+};
+
+// 穴のない多角形。最後の頂点と最初の頂点を結んで閉じる
+struct Polygon {
+  uint16_t zone;
+  uint16_t reserved;
+  uint32_t firstVertex;
+  uint32_t vertexCount;
+  int32_t  latMinE7;
+  int32_t  latMaxE7;
+  int32_t  lonMinE7;
+  int32_t  lonMaxE7;
+};
+
+struct Vertex {
+  int32_t latE7;
+  int32_t lonE7;
+};
+
+static_assert(sizeof(Header) == 40, "Header layout is part of the file format");
+static_assert(sizeof(Polygon) == 28, "Polygon layout is part of the file format");
+static_assert(sizeof(Vertex) == 8, "Vertex layout is part of the file format");
+
+} // namespace TzFormat
+
+// Source は MemorySource や FlashFileSource のように
+// bool read(uint32_t offset, void *buffer, size_t length) と size_t getSize() を持つ
+template <typename Source> class TimeZoneIndex {
+public:
+  // 1 回の問い合わせで読んだ量 (計測用)
+  struct Stats {
+    uint32_t polygons = 0;
+    uint32_t vertices = 0;
+  };
+
+private:
+  static constexpr size_t CHUNK = 32; // 一度に読む頂点数
+
+  Source          &source;
+  TzFormat::Header header;
+  bool             isOpen = false;
+  uint32_t         polygonsAt;
+  uint32_t         verticesAt;
+  uint32_t         cellsAt;
+  uint32_t         candidatesAt;
+  Stats            stats;
+  uint32_t         lookupCount = 0;
+  TzFormat::Zone   zone;
+  bool             hasCell   = false; // 以下は update() が最後に引いたセル
+  int32_t          cell      = 0;
+  bool             isMixed   = false;
+  unsigned long    checkedMs = 0;
+
+public:
+  explicit TimeZoneIndex(Source &source)
+      : source(source), zone(TimeZone::fixed(Config::Time::DEFAULT_OFFSET_MIN)) {}
+
+  bool open() {
+    hasCell = false;
+    isOpen  = false;
+    if (!source.read(0, &header, sizeof(header)) || header.magic != TzFormat::MAGIC ||
+        header.rows == 0 || header.cols == 0 || header.cellLatE7 <= 0 || header.cellLonE7 <= 0) {
+      return false;
+    }
+    polygonsAt   = sizeof(header) + header.zoneCount * sizeof(TzFormat::Zone);
+    verticesAt   = polygonsAt + header.polygonCount * sizeof(TzFormat::Polygon);
+    cellsAt      = verticesAt + header.vertexCount * sizeof(TzFormat::Vertex);
+    candidatesAt = cellsAt + (header.rows * header.cols + 1) * 4;
+    isOpen       = source.getSize() == candidatesAt + header.candidateCount * 2;
+    return isOpen;
+  }
+
+  bool isReady() const {
+    return isOpen;
+  }
+
+  const Stats &getStats() const {
+    return stats;
+  }
+
+  uint32_t getLookupCount() const {
+    return lookupCount;
+  }
+
+  // update() で決めた現在地の時間帯
+  const TzFormat::Zone &getZone() const {
+    return zone;
+  }
+
+  // 現在地から時間帯を決め直し、変わったら true。前回と同じセルにいる間は引き直さない。
+  // 境界を含むセルでは Config::TimeZone::RECHECK_MS ごとに引き直す
+  bool update(double lat, double lon, unsigned long nowMs) {
+    if (!isOpen) return false;
+    const int32_t latE7 = toE7(lat);
+    const int32_t lonE7 = toE7(lon);
+    int32_t       at;
+    if (!toCell(latE7, lonE7, at)) at = -1;
+    if (hasCell && at == cell && (!isMixed || nowMs - checkedMs < Config::TimeZone::RECHECK_MS)) {
+      return false;
+    }
+
+    TzFormat::Zone found;
+    find(latE7, lonE7, found, isMixed);
+    hasCell   = true;
+    cell      = at;
+    checkedMs = nowMs;
+    if (memcmp(&found, &zone, sizeof(zone)) == 0) return false;
+    zone = found;
+    return true;
+  }
+
+  // 地点の時間帯。どの時間帯にも入らなければ、経度から決めた海上の時差にして false
+  bool lookup(double lat, double lon, TzFormat::Zone &out) {
+    bool mixed;
+    return find(toE7(lat), toE7(lon), out, mixed);
+  }
+
+  // 海上の時差。経度 15 度ごとに 1 時間で、夏時間はない
+  static TzFormat::Zone nautical(int32_t lonE7) {
+    const int32_t hours = (lonE7 + (lonE7 < 0 ? -75000000 : 75000000)) / 150000000;
+    return TimeZone::fixed(hours * 60);
+  }
+
+private:
+  // mixed はセルの中で時間帯が変わりうるとき true
+  bool find(int32_t latE7, int32_t lonE7, TzFormat::Zone &out, bool &mixed) {
+    lookupCount++;
+    stats = Stats();
+    out   = nautical(lonE7);
+    mixed = true;
+
+    int32_t  index;
+    uint32_t range[2];
+    if (!isOpen || !toCell(latE7, lonE7, index) ||
+        !source.read(cellsAt + index * 4, range, sizeof(range)) ||
+        header.candidateCount < range[1]) {
+      return false;
+    }
+
+    for (uint32_t i = range[0]; i < range[1]; i++) {
+      uint16_t candidate;
+      if (!source.read(candidatesAt + i * 2, &candidate, 2)) return false;
+      if (candidate & TzFormat::FULL) {
+        mixed = range[1] - range[0] != 1;
+        return readZone(candidate & ~TzFormat::FULL, out);
+      }
+
+      TzFormat::Polygon polygon;
+      if (header.polygonCount <= candidate ||
+          !source.read(polygonsAt + candidate * sizeof(polygon), &polygon, sizeof(polygon))) {
+        return false;
+      }
+      if (contains(polygon, latE7, lonE7)) return readZone(polygon.zone, out);
+    }
+    return false;
+  }
+
+  bool readZone(uint32_t index, TzFormat::Zone &out) {
+    TzFormat::Zone read;
+    if (header.zoneCount <= index ||
+        !source.read(sizeof(header) + index * sizeof(read), &read, sizeof(read))) {
+      return false;
+    }
+    out = read;
+    return true;
+  }
+
+  // 交差数による内外判定。辺ごとに、地点から東へ伸ばした半直線と交わるかを整数で調べる
+  bool contains(const TzFormat::Polygon &polygon, int32_t latE7, int32_t lonE7) {
+    stats.polygons++;
+    if (latE7 < polygon.latMinE7 || polygon.latMaxE7 < latE7 || lonE7 < polygon.lonMinE7 ||
+        polygon.lonMaxE7 < lonE7 || polygon.vertexCount < 3 ||
+        header.vertexCount < polygon.vertexCount ||
+        header.vertexCount - polygon.vertexCount < polygon.firstVertex) {
+      return false;
+    }
+
+    const uint32_t   first = verticesAt + polygon.firstVertex * sizeof(TzFormat::Vertex);
+    TzFormat::Vertex prev;
+    if (!source.read(first + (polygon.vertexCount - 1) * sizeof(prev), &prev, sizeof(prev))) {
+      return false;
+    }
+
+    bool             inside = false;
+    TzFormat::Vertex chunk[CHUNK];
+    for (uint32_t i = 0; i < polygon.vertexCount; i += CHUNK) {
+      const uint32_t n = polygon.vertexCount - i < CHUNK ? polygon.vertexCount - i : CHUNK;
+      if (!source.read(first + i * sizeof(chunk[0]), chunk, n * sizeof(chunk[0]))) return false;
+      stats.vertices += n;
+
+      for (uint32_t j = 0; j < n; j++) {
+        const TzFormat::Vertex &v = chunk[j];
+        if ((latE7 < v.latE7) != (latE7 < prev.latE7)) {
+          // 交点の経度が地点より東なら数える。両辺に dLat を掛けて割り算を避ける
+          const int64_t dLat  = static_cast<int64_t>(v.latE7) - prev.latE7;
+          const int64_t cross = (static_cast<int64_t>(latE7) - prev.latE7) *
+                                (static_cast<int64_t>(v.lonE7) - prev.lonE7);
+          const int64_t here  = (static_cast<int64_t>(lonE7) - prev.lonE7) * dLat;
+          if (0 < dLat ? here < cross : cross < here) inside = !inside;
+        }
+        prev = v;
+      }
+    }
+    return inside;
+  }
+
+  bool toCell(int32_t latE7, int32_t lonE7, int32_t &index) const {
+    const int64_t row =
+        floorDiv(static_cast<int64_t>(latE7) - header.originLatE7, header.cellLatE7);
+    const int64_t col =
+        floorDiv(static_cast<int64_t>(lonE7) - header.originLonE7, header.cellLonE7);
+    if (row < 0 || header.rows <= row || col < 0 || header.cols <= col) return false;
+    index = static_cast<int32_t>(row * header.cols + col);
+    return true;
+  }
+
+  static int64_t floorDiv(int64_t a, int64_t b) {
+    return a < 0 ? -((-a + b - 1) / b) : a / b;
+  }
+
+  static int32_t toE7(double degrees) {
+    return static_cast<int32_t>(lround(degrees * 1e7));
+  }
+};
+
+template <typename Source> constexpr size_t TimeZoneIndex<Source>::CHUNK;
@@ -2,19 +2,53 @@
 
 #include <GNSS.h>
 
+#include "Breadcrumb.h"
+#include "GradientEstimator.h"
+#include "LapTimer.h"
+#include "Numeric.h"
 #include "Odometer.h"
+#include "RideSummary.h"
+#include "SpeedEstimator.h"
+#include "SpeedHistogram.h"
 #include "Speedometer.h"
 #include "Stopwatch.h"
+#include "TripCounters.h"
 
-class Trip {
+template <typename Num> class BasicTrip {
 public:
-  Speedometer speedometer;
-  Odometer    odometer;
-  Stopwatch   stopwatch;
+  // 現在の走行とは別にリセットできる積算値。LIFETIME はリセットしない
+  enum class Counter { TRIP_A, TRIP_B, LIFETIME, Count };
+
+  typedef TripCounters<static_cast<size_t>(Counter::Count)> Counters;
+
+  // 電源断をまたいで引き継ぐ積算値
+  struct Totals {
+    uint64_t       totalMm       = 0;
+    uint64_t       movingTimeMs  = 0;
+    uint64_t       elapsedTimeMs = 0;
+    float          maxKmh        = 0.0f;
+    float          ascentM       = 0.0f;
+    uint32_t       startEpoch    = 0;
+    SpeedHistogram speedHistogram;
+    Counters       counters;
+  };
+
+  BasicSpeedometer<Num> speedometer;
+  SpeedEstimator        speedEstimator;
+  SpeedHistogram        speedHistogram;
+  BasicOdometer<Num>    odometer;
+  Stopwatch             stopwatch;
+  LapTimer              laps;
+  Breadcrumb            breadcrumb;
+  GradientEstimator     gradient;
+  Counters              counters;
 
 private:
-  unsigned long lastMillis;
-  bool          hasLastMillis;
+  uint32_t  lastMillis; // millis() は 49.7 日で一周するので、差は 32 ビットで取る
+  bool      hasLastMillis;
+  SpNavTime lastEpoch  = {};
+  TripDelta lastDelta;
+  uint32_t  startEpoch = 0;
 
 public:
   void begin() {
@@ -22,34 +56,103 @@ public:
   }
 
   void update(const SpNavData &navData, unsigned long currentMillis) {
-    const float rawKmh   = navData.velocity * 60.0f * 60.0f / 1000.0f;
-    const bool  hasFix   = navData.posFixMode != FixInvalid;
-    const bool  isMoving = hasFix && (Config::MIN_MOVING_SPEED_KMH < rawKmh); // GPS ノイズ対策
-    const float speedKmh = isMoving ? rawKmh : 0.0f;
+    const Num      minKmh    = Numeric<Num>::from(Config::MIN_MOVING_SPEED_KMH);
+    const Num      rawKmh    = Numeric<Num>::from(navData.velocity) * Numeric<Num>::from(3.6);
+    const bool     hasFix    = navData.posFixMode != FixInvalid;
+    const bool     isMoving  = hasFix && (minKmh < rawKmh); // GPS ノイズ対策
+    const Num      speedKmh  = isMoving ? rawKmh : Num();
+    const float    sampleKmh = Numeric<Num>::toFloat(speedKmh);
+    const uint32_t nowMs     = static_cast<uint32_t>(currentMillis);
+
+    if (!hasFix) speedEstimator.reset();
+    else if (isNewEpoch(navData.time)) speedEstimator.addSample(sampleKmh, nowMs);
+    speedEstimator.update(nowMs);
 
     if (!hasLastMillis) {
-      lastMillis    = currentMillis;
+      lastMillis    = nowMs;
       hasLastMillis = true;
       return;
     }
 
-    const unsigned long dt = currentMillis - lastMillis;
-    lastMillis             = currentMillis;
+    const uint32_t dt = nowMs - lastMillis;
+    lastMillis        = nowMs;
 
+    // 距離と時間の差分はここで一度だけ求め、各集計に配る
+    TripDelta      delta;
+    const uint64_t lastElapsedMs = stopwatch.getElapsedTimeMs();
     stopwatch.update(isMoving, dt);
-    if (hasFix) odometer.update(navData.latitude, navData.longitude, isMoving);
-    speedometer.update(speedKmh, stopwatch.getMovingTimeMs(), odometer.getTotalDistance());
+    delta.movingMs  = isMoving ? dt : 0;
+    delta.elapsedMs = static_cast<uint32_t>(stopwatch.getElapsedTimeMs() - lastElapsedMs);
+    delta.kmh       = sampleKmh;
+
+    if (isMoving) speedHistogram.add(sampleKmh, dt);
+    if (hasFix) {
+      const uint64_t lastMm = odometer.getTotalMm();
+      if (odometer.update(navData.latitude, navData.longitude, isMoving)) {
+        breadcrumb.add(navData.latitude, navData.longitude);
+      }
+      delta.distanceMm = static_cast<uint32_t>(odometer.getTotalMm() - lastMm);
+      // 高度は 3D 測位のときだけ有効
+      if (navData.posFixMode == Fix3D) gradient.update(delta.distanceMm, navData.altitude);
+    }
+    counters.add(delta);
+    lastDelta = delta;
+    speedometer.update(speedKmh, dt, stopwatch.getMovingTimeMs(), odometer.getTotalMm());
+    laps.update(getLapTotals(), sampleKmh, hasFix, navData.latitude, navData.longitude);
+  }
+
+  TripCounter getCounter(Counter id) const {
+    return counters.get(static_cast<size_t>(id));
+  }
+
+  void resetCounter(Counter id) {
+    counters.reset(static_cast<size_t>(id));
+  }
+
+  // 直近の更新の差分
+  const TripDelta &getLastDelta() const {
+    return lastDelta;
+  }
+
+  // 走り始めた時刻 (Clock::getEpoch())。最初に分かった値を残す
+  void markStart(uint32_t epoch) {
+    if (startEpoch == 0) startEpoch = epoch;
+  }
+
+  RideSummary getSummary() const {
+    RideSummary summary;
+    summary.startEpoch    = startEpoch;
+    summary.distanceM     = static_cast<uint32_t>(odometer.getTotalMm() / 1000);
+    summary.movingTimeMs  = toSummaryMs(stopwatch.getMovingTimeMs());
+    summary.elapsedTimeMs = toSummaryMs(stopwatch.getElapsedTimeMs());
+    summary.avgKmh        = speedometer.getAvg();
+    summary.maxKmh        = speedometer.getMax();
+    return summary;
+  }
+
+  void lap() {
+    laps.mark(getLapTotals());
+  }
+
+  LapTimer::Lap getCurrentLap() const {
+    return laps.getCurrent(getLapTotals());
   }
 
   void resetTime() {
     stopwatch.resetTotalTime();
     lastMillis    = 0;
     hasLastMillis = false;
+    laps.reset(getLapTotals());
   }
 
   void resetOdometerAndMovingTime() {
     odometer.reset();
     stopwatch.resetMovingTime();
+    speedHistogram.reset();
+    breadcrumb.reset();
+    gradient.reset();
+    startEpoch = 0;
+    laps.reset(getLapTotals());
   }
 
   void reset() {
@@ -60,4 +163,51 @@ public:
   void pause() {
     stopwatch.pause();
   }
+
+  Totals getTotals() const {
+    Totals totals;
+    totals.totalMm        = odometer.getTotalMm();
+    totals.movingTimeMs   = stopwatch.getMovingTimeMs();
+    totals.elapsedTimeMs  = stopwatch.getElapsedTimeMs();
+    totals.maxKmh         = speedometer.getMax();
+    totals.ascentM        = gradient.getAscentM();
+    totals.speedHistogram = speedHistogram;
+    totals.counters       = counters;
+    totals.startEpoch     = startEpoch;
+    return totals;
+  }
+
+  void restore(const Totals &totals) {
+    odometer.restore(totals.totalMm);
+    stopwatch.restore(totals.movingTimeMs, totals.elapsedTimeMs);
+    speedometer.restoreMax(totals.maxKmh);
+    gradient.restore(totals.ascentM);
+    speedHistogram = totals.speedHistogram;
+    counters       = totals.counters;
+    startEpoch     = totals.startEpoch;
+    laps.reset(getLapTotals());
+  }
+
+private:
+  LapTimer::Totals getLapTotals() const {
+    LapTimer::Totals totals;
+    totals.totalMm       = odometer.getTotalMm();
+    totals.movingTimeMs  = stopwatch.getMovingTimeMs();
+    totals.elapsedTimeMs = stopwatch.getElapsedTimeMs();
+    return totals;
+  }
+
+  // 履歴の形式は 32 ビットなので、49.7 日を超える走行は頭打ちにする
+  static uint32_t toSummaryMs(uint64_t ms) {
+    return ms < UINT32_MAX ? static_cast<uint32_t>(ms) : UINT32_MAX;
+  }
+
+  bool isNewEpoch(const SpNavTime &time) {
+    const bool isSame = time.sec == lastEpoch.sec && time.usec == lastEpoch.usec &&
+                        time.minute == lastEpoch.minute && time.hour == lastEpoch.hour;
+    lastEpoch         = time;
+    return !isSame;
+  }
 };
+
+using Trip = BasicTrip<DomainNumber>;
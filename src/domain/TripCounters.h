@@ -0,0 +1,70 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// 1 回の更新で増えた量。Trip が測位ごとに一度だけ求め、すべてのカウンタに配る
+struct TripDelta {
+  uint32_t distanceMm = 0;
+  uint32_t movingMs   = 0;
+  uint32_t elapsedMs  = 0;
+  float    kmh        = 0.0f;
+};
+
+// 個別にリセットできる積算値 1 つ分
+struct TripCounter {
+  uint64_t totalMm       = 0;
+  uint64_t movingTimeMs  = 0;
+  uint64_t elapsedTimeMs = 0;
+  float    maxKmh        = 0.0f;
+
+  void add(const TripDelta &delta) {
+    totalMm += delta.distanceMm;
+    movingTimeMs += delta.movingMs;
+    elapsedTimeMs += delta.elapsedMs;
+    if (maxKmh < delta.kmh) maxKmh = delta.kmh;
+  }
+
+  float getDistanceKm() const {
+    return totalMm / 1000000.0f;
+  }
+
+  float getAvgKmh() const {
+    if (movingTimeMs == 0) return 0.0f;
+    return static_cast<float>(totalMm) / movingTimeMs * 3.6f; // mm/ms = m/s
+  }
+};
+
+// カウンタは項目ごとの配列に並べ (SoA)、同じ差分を項目ごとのループで足す
+// 分岐のない単純なループになり、カウンタを増やしても 1 個あたり数回の加算で済む
+template <size_t N> class TripCounters {
+private:
+  uint64_t totalMm[N]       = {};
+  uint64_t movingTimeMs[N]  = {};
+  uint64_t elapsedTimeMs[N] = {};
+  float    maxKmh[N]        = {};
+
+public:
+  void add(const TripDelta &delta) {
+    for (size_t i = 0; i < N; i++) totalMm[i] += delta.distanceMm;
+    for (size_t i = 0; i < N; i++) movingTimeMs[i] += delta.movingMs;
+    for (size_t i = 0; i < N; i++) elapsedTimeMs[i] += delta.elapsedMs;
+    for (size_t i = 0; i < N; i++) maxKmh[i] = maxKmh[i] < delta.kmh ? delta.kmh : maxKmh[i];
+  }
+
+  void reset(size_t index) {
+    totalMm[index]       = 0;
+    movingTimeMs[index]  = 0;
+    elapsedTimeMs[index] = 0;
+    maxKmh[index]        = 0.0f;
+  }
+
+  TripCounter get(size_t index) const {
+    TripCounter counter;
+    counter.totalMm       = totalMm[index];
+    counter.movingTimeMs  = movingTimeMs[index];
+    counter.elapsedTimeMs = elapsedTimeMs[index];
+    counter.maxKmh        = maxKmh[index];
+    return counter;
+  }
+};
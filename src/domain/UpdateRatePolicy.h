@@ -0,0 +1,62 @@
+#pragma once
+
+#include <math.h>
+
+#include "../Config.h"
+
+// 走行状態から GNSS の測位間隔を選ぶ。上げるときは即座に、下げるときは一定時間待ってから切り替える
+class UpdateRatePolicy {
+private:
+  static constexpr int LEVEL_COUNT =
+      sizeof(Config::Gnss::UPDATE_INTERVALS_MS) / sizeof(Config::Gnss::UPDATE_INTERVALS_MS[0]);
+
+  int           level          = 0;
+  unsigned long downshiftSince = 0;
+  bool          isDownshifting = false;
+
+public:
+  unsigned long update(float speedKmh, float accelKmhPerSec, unsigned long nowMs) {
+    const int target = targetLevel(speedKmh, accelKmhPerSec);
+
+    if (level <= target) {
+      level          = target;
+      isDownshifting = false;
+      return getIntervalMs();
+    }
+
+    if (!isDownshifting) {
+      isDownshifting = true;
+      downshiftSince = nowMs;
+    } else if (Config::Gnss::RATE_DOWNSHIFT_HOLD_MS <= nowMs - downshiftSince) {
+      level          = target;
+      isDownshifting = false;
+    }
+    return getIntervalMs();
+  }
+
+  void reset() {
+    level          = 0;
+    isDownshifting = false;
+  }
+
+  unsigned long getIntervalMs() const {
+    return Config::Gnss::UPDATE_INTERVALS_MS[level];
+  }
+
+private:
+  int targetLevel(float speedKmh, float accelKmhPerSec) const {
+    const bool isStopped = speedKmh < Config::MIN_MOVING_SPEED_KMH;
+    if (!isStopped && Config::Gnss::RATE_ACCEL_KMH_PER_S < fabsf(accelKmhPerSec)) {
+      return LEVEL_COUNT - 1;
+    }
+
+    int target = 0;
+    for (int i = 1; i < LEVEL_COUNT; i++) {
+      // 現在のレート以下は閾値を下げて判定し、境界付近でのばたつきを防ぐ
+      float threshold = Config::Gnss::RATE_MIN_KMH[i];
+      if (i <= level) threshold -= Config::Gnss::RATE_HYSTERESIS_KMH;
+      if (threshold <= speedKmh) target = i;
+    }
+    return target;
+  }
+};
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// COBS (Consistent Overhead Byte Stuffing)。0 を含まない列にして、0 をフレームの区切りに使う
+class Cobs {
+public:
+  static constexpr size_t maxEncodedSize(size_t size) {
+    return size + size / 254 + 1;
+  }
+
+  // out には maxEncodedSize(size) バイト必要。区切りの 0 は付けない
+  static size_t encode(const uint8_t *in, size_t size, uint8_t *out) {
+    size_t  codeAt = 0;
+    size_t  length = 1;
+    uint8_t code   = 1;
+    for (size_t i = 0; i < size; i++) {
+      if (in[i] != 0) {
+        out[length++] = in[i];
+        code++;
+      }
+      if (in[i] == 0 || code == 0xFF) {
+        out[codeAt] = code;
+        codeAt      = length++;
+        code        = 1;
+      }
+    }
+    out[codeAt] = code;
+    return length;
+  }
+
+  // 区切りの 0 を除いた列を戻す。壊れた列や capacity を超える場合は false
+  static bool decode(const uint8_t *in, size_t size, uint8_t *out, size_t capacity,
+                     size_t &length) {
+    length = 0;
+    for (size_t i = 0; i < size;) {
+      const uint8_t code = in[i++];
+      if (code == 0 || size < i + code - 1 || capacity < length + code - 1) return false;
+      for (uint8_t k = 1; k < code; k++) {
+        if (in[i] == 0) return false;
+        out[length++] = in[i++];
+      }
+      if (code != 0xFF && i < size) {
+        if (capacity <= length) return false;
+        out[length++] = 0;
+      }
+    }
+    return true;
+  }
+};
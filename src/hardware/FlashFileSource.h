@@ -0,0 +1,26 @@
+#pragma once
+
+#include <Flash.h>
+#include <stdint.h>
+
+// Flash 上のファイルを読む。ファイルは開いたままにして、必要な位置だけを読む
+class FlashFileSource {
+private:
+  File file;
+
+public:
+  bool begin(const char *path) {
+    if (!Flash.exists(path)) return false;
+    file = Flash.open(path, FILE_READ);
+    return file;
+  }
+
+  bool read(uint32_t offset, void *buffer, size_t length) {
+    if (!file || !file.seek(offset)) return false;
+    return file.read(buffer, length) == static_cast<int>(length);
+  }
+
+  size_t getSize() {
+    return file ? file.size() : 0;
+  }
+};
@@ -1,12 +1,57 @@
 #pragma once
 
+#include <Arduino.h>
 #include <GNSS.h>
+#include <cstdio>
 #include <cstring>
 
+#include "../Config.h"
+#include "Trace.h"
+
 class Gnss {
+public:
+  // 捕捉する衛星システムの組み合わせ。多いほど精度は上がるが電力と TTFF が増える
+  enum class Profile { MAX_ACCURACY, BALANCED, LOW_POWER, Count };
+
+  struct ProfileStats {
+    unsigned long coldTtffMs    = 0; // 0 は未測位
+    unsigned long restarts      = 0;
+    unsigned long reacquiredSum = 0; // 切り替え後の再測位までの時間の合計 [ms]
+    unsigned long reacquired    = 0;
+    unsigned long epochs        = 0;
+    unsigned long fix3dEpochs   = 0;
+    unsigned long satelliteSum  = 0;
+  };
+
 private:
-  SpGnss    gnss;
-  SpNavData navData;
+  enum : uint8_t {
+    USE_GPS     = 1 << 0,
+    USE_GLONASS = 1 << 1,
+    USE_GALILEO = 1 << 2,
+    USE_QZ_L1CA = 1 << 3,
+    USE_QZ_L1S  = 1 << 4,
+  };
+
+  static constexpr int PROFILE_COUNT = static_cast<int>(Profile::Count);
+
+  SpGnss        gnss;
+  SpNavData     navData;
+  unsigned long intervalMs       = Config::Gnss::UPDATE_INTERVALS_MS[0]; // 受信機が今使っている間隔
+  unsigned long targetIntervalMs = Config::Gnss::UPDATE_INTERVALS_MS[0];
+
+  Profile       baseProfile      = Profile::MAX_ACCURACY;
+  Profile       profile          = Profile::MAX_ACCURACY; // 受信機が今使っている組み合わせ
+  Profile       targetProfile    = Profile::MAX_ACCURACY; // 切り替えたい組み合わせ
+  bool          isBegun          = false;
+  bool          isRunning        = false;
+  unsigned long lastAttemptMs    = 0;
+  bool          isAutoProfile    = true;
+  bool          isColdStart      = true;
+  bool          hasFixSinceStart = false;
+  bool          is3dHeld         = false;
+  unsigned long startMillis      = 0;
+  unsigned long stateSince       = 0; // 3D 測位の継続開始、または 3D 測位を失った時刻
+  ProfileStats  stats[PROFILE_COUNT];
 
 public:
   Gnss() {
@@ -15,22 +60,198 @@ public:
 
   bool begin() {
     if (gnss.begin() != 0) return false;
-    gnss.select(GPS);
-    gnss.select(GLONASS);
-    gnss.select(GALILEO);
-    gnss.select(QZ_L1CA);
-    gnss.select(QZ_L1S);
-    if (gnss.start(COLD_START) != 0) return false;
-    return true;
+    isBegun    = true;
+    profile    = targetProfile;
+    intervalMs = targetIntervalMs;
+    applyConstellations(profile);
+    if (gnss.setInterval(toSpInterval(intervalMs)) != 0) return false;
+    return start(COLD_START);
   }
 
   bool update() {
+    TraceScope trace(TraceEvent::GNSS_UPDATE);
+    // 設定の変更に失敗して止まっていると新しい測位が来ないので、ここでやり直す
+    if (isBegun && (!isRunning || !isApplied()) &&
+        Config::Gnss::RETRY_MS <= millis() - lastAttemptMs) {
+      reconfigure();
+    }
     if (gnss.waitUpdate(0) != 1) return false;
     gnss.getNavData(&navData);
+    Trace::mark(TraceEvent::GNSS_FIX, static_cast<uint16_t>(navData.numSatellites));
+    record(millis());
     return true;
   }
 
   const SpNavData &getNavData() const {
     return navData;
   }
+
+  // 組み合わせの切り替えと同じく、受信機を止めて間隔を変え、HOT_START で再開する。
+  // 失敗したら update() がやり直すので、同じ値で呼び直しても受信機には触れない
+  bool setUpdateIntervalMs(unsigned long ms) {
+    if (ms == targetIntervalMs) return ms == intervalMs;
+    targetIntervalMs = ms;
+    return reconfigure();
+  }
+
+  unsigned long getUpdateIntervalMs() const {
+    return intervalMs;
+  }
+
+  // isAuto なら安定した 3D 測位中は LOW_POWER に落とし、測位を失ったら next に戻す
+  bool setProfile(Profile next, bool isAuto = true) {
+    baseProfile   = next;
+    targetProfile = next;
+    isAutoProfile = isAuto;
+    return reconfigure();
+  }
+
+  Profile getProfile() const {
+    return profile;
+  }
+
+  const ProfileStats &getStats(Profile p) const {
+    return stats[static_cast<int>(p)];
+  }
+
+  // 組み合わせごとに 1 行で、コールドスタートの TTFF [ms]・切り替えの回数と平均の再測位時間
+  // [ms]・受信回数と 3D 測位の割合 [%]・平均の衛星数 (0.1 単位) を書き出す。
+  // 今使っている組み合わせには * を付ける
+  template <typename Out> void report(Out &out) const {
+    char line[112];
+    for (int i = 0; i < PROFILE_COUNT; i++) {
+      const ProfileStats &s = stats[i];
+      snprintf(line, sizeof(line),
+               "GNSS %s%s ttff %lu restarts %lu reacquire %lu epochs %lu fix3d %lu sats %lu\n",
+               getName(static_cast<Profile>(i)), i == static_cast<int>(profile) ? "*" : "",
+               s.coldTtffMs, s.restarts, average(s.reacquiredSum, s.reacquired), s.epochs,
+               average(s.fix3dEpochs * 100, s.epochs), average(s.satelliteSum * 10, s.epochs));
+      out.print(line);
+    }
+  }
+
+  static const char *getName(Profile p) {
+    static const char *const NAMES[] = {
+        "MAX_ACCURACY",
+        "BALANCED",
+        "LOW_POWER",
+    };
+    static_assert(sizeof(NAMES) / sizeof(NAMES[0]) == PROFILE_COUNT,
+                  "every Profile needs a name");
+    return NAMES[static_cast<int>(p)];
+  }
+
+private:
+  void record(unsigned long now) {
+    ProfileStats &s     = stats[static_cast<int>(profile)];
+    const bool    isFix = navData.posFixMode != FixInvalid;
+    const bool    is3d  = navData.posFixMode == Fix3D;
+
+    s.epochs++;
+    s.satelliteSum += navData.numSatellites;
+    if (is3d) s.fix3dEpochs++;
+
+    if (isFix && !hasFixSinceStart) {
+      hasFixSinceStart = true;
+      if (isColdStart) s.coldTtffMs = now - startMillis;
+      else {
+        s.reacquiredSum += now - startMillis;
+        s.reacquired++;
+      }
+      isColdStart = false;
+    }
+
+    if (is3d != is3dHeld) {
+      is3dHeld   = is3d;
+      stateSince = now;
+    }
+
+    if (!isAutoProfile) return;
+    // 切り替えに失敗している間は、ここで毎回やり直さず update() に任せる
+    const unsigned long heldMs = now - stateSince;
+    Profile             next   = targetProfile;
+    if (is3dHeld && profile == baseProfile && Config::Gnss::STABLE_FIX_MS <= heldMs) {
+      next = Profile::LOW_POWER;
+    } else if (!is3dHeld && (profile == baseProfile || Config::Gnss::FIX_LOST_MS <= heldMs)) {
+      next = baseProfile;
+    }
+    if (next == targetProfile) return;
+    targetProfile = next;
+    reconfigure();
+  }
+
+  bool isApplied() const {
+    return targetProfile == profile && targetIntervalMs == intervalMs;
+  }
+
+  // 受信機の設定は止めている間に変える。profile と intervalMs は新しい設定で受信を始められた
+  // ときだけ変え、失敗したら元の設定で受信を続ける。それも失敗したら update() が
+  // Config::Gnss::RETRY_MS ごとにやり直す。begin() の前は値を覚えておくだけ
+  bool reconfigure() {
+    if (!isBegun || (isApplied() && isRunning)) return true;
+    lastAttemptMs = millis();
+    if (isRunning && gnss.stop() != 0) return false; // 元の設定のまま動いている
+    isRunning = false;
+
+    if (restart(targetProfile, targetIntervalMs)) {
+      if (targetProfile != profile) stats[static_cast<int>(targetProfile)].restarts++;
+      profile    = targetProfile;
+      intervalMs = targetIntervalMs;
+      return true;
+    }
+    if (!isApplied()) restart(profile, intervalMs);
+    return false;
+  }
+
+  bool restart(Profile p, unsigned long ms) {
+    applyConstellations(p);
+    if (gnss.setInterval(toSpInterval(ms)) != 0) return false;
+    return start(HOT_START);
+  }
+
+  bool start(int mode) {
+    startMillis      = millis();
+    hasFixSinceStart = false;
+    is3dHeld         = false;
+    stateSince       = startMillis;
+    isRunning        = gnss.start(mode) == 0;
+    return isRunning;
+  }
+
+  void applyConstellations(Profile p) {
+    const uint8_t mask = constellations(p);
+    selectIf(GPS, mask & USE_GPS);
+    selectIf(GLONASS, mask & USE_GLONASS);
+    selectIf(GALILEO, mask & USE_GALILEO);
+    selectIf(QZ_L1CA, mask & USE_QZ_L1CA);
+    selectIf(QZ_L1S, mask & USE_QZ_L1S);
+  }
+
+  template <typename System> void selectIf(System system, bool isUsed) {
+    if (isUsed) gnss.select(system);
+    else gnss.deselect(system);
+  }
+
+  static uint8_t constellations(Profile p) {
+    switch (p) {
+    case Profile::BALANCED:
+      return USE_GPS | USE_GLONASS | USE_QZ_L1CA;
+    case Profile::LOW_POWER:
+      return USE_GPS | USE_QZ_L1CA;
+    case Profile::MAX_ACCURACY:
+    default:
+      return USE_GPS | USE_GLONASS | USE_GALILEO | USE_QZ_L1CA | USE_QZ_L1S;
+    }
+  }
+
+  static unsigned long average(unsigned long sum, unsigned long count) {
+    return count == 0 ? 0 : sum / count;
+  }
+
+  static SpInterval toSpInterval(unsigned long ms) {
+    if (ms <= 100) return SpInterval_10Hz;
+    if (ms <= 200) return SpInterval_5Hz;
+    if (ms <= 500) return SpInterval_2Hz;
+    return SpInterval_1Hz;
+  }
 };
@@ -56,6 +56,14 @@ public:
     ssd1306.drawLine(x0, y0, x1, y1, color);
   }
 
+  void drawRect(int x, int y, int w, int h, int color) {
+    ssd1306.drawRect(x, y, w, h, color);
+  }
+
+  void drawBitmap(int x, int y, const uint8_t *bitmap, int w, int h, int color) {
+    ssd1306.drawBitmap(x, y, bitmap, w, h, color);
+  }
+
   Rect getTextBounds(const char *string) {
     Rect rect;
     ssd1306.getTextBounds(string, 0, 0, &rect.x, &rect.y, &rect.w, &rect.h);
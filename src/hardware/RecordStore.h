@@ -0,0 +1,91 @@
+#pragma once
+
+#include <Flash.h>
+#include <stdint.h>
+
+#include "Crc32.h"
+
+// 固定長の記録を 2 つのファイルへ交互に保存する。書き込み中に電源が落ちても
+// もう一方に直前の記録が残るので、読み込み時は CRC が正しく新しい方を採用する
+class RecordStore {
+private:
+  struct Header {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t size;
+    uint32_t sequence;
+    uint32_t crc; // sequence と本体
+  };
+
+  static constexpr uint32_t MAGIC = 0x31524353; // "SCR1"
+
+  const char *paths[2];
+  uint16_t    version;
+  uint32_t    sequence = 0;
+  size_t      nextSlot = 0;
+
+public:
+  RecordStore(const char *pathA, const char *pathB, uint16_t version) : version(version) {
+    paths[0] = pathA;
+    paths[1] = pathB;
+  }
+
+  template <typename T> bool load(T &out) {
+    bool found = false;
+    for (size_t slot = 0; slot < 2; slot++) {
+      T        value;
+      uint32_t seq;
+      if (!read(paths[slot], &value, sizeof(T), seq)) continue;
+      if (found && seq - sequence > 0x7FFFFFFFu) continue; // 古い方 (周回を考慮)
+
+      out      = value;
+      sequence = seq;
+      nextSlot = 1 - slot;
+      found    = true;
+    }
+    return found;
+  }
+
+  template <typename T> bool save(const T &value) {
+    const char *path = paths[nextSlot];
+    Header      header;
+    header.magic    = MAGIC;
+    header.version  = version;
+    header.size     = sizeof(T);
+    header.sequence = sequence + 1;
+    header.crc      = checksum(header.sequence, &value, sizeof(T));
+
+    Flash.remove(path); // FILE_WRITE は追記になるため
+    File file = Flash.open(path, FILE_WRITE);
+    if (!file) return false;
+    size_t written = file.write(reinterpret_cast<const uint8_t *>(&header), sizeof(header));
+    written += file.write(reinterpret_cast<const uint8_t *>(&value), sizeof(T));
+    file.close();
+    if (written != sizeof(header) + sizeof(T)) return false;
+
+    sequence = header.sequence;
+    nextSlot = 1 - nextSlot;
+    return true;
+  }
+
+private:
+  static uint32_t checksum(uint32_t sequence, const void *data, size_t size) {
+    return Crc32::compute(data, size, Crc32::compute(&sequence, sizeof(sequence)));
+  }
+
+  bool read(const char *path, void *data, size_t size, uint32_t &seq) const {
+    if (!Flash.exists(path)) return false;
+    File file = Flash.open(path, FILE_READ);
+    if (!file) return false;
+
+    Header     header;
+    const bool hasHeader = file.read(&header, sizeof(header)) == static_cast<int>(sizeof(header));
+    const bool isValid   = hasHeader && header.magic == MAGIC && header.version == version &&
+                         header.size == size && file.read(data, size) == static_cast<int>(size);
+    file.close();
+    if (!isValid || header.crc != checksum(header.sequence, data, size)) return false;
+
+    seq = header.sequence;
+    return true;
+  }
+};
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <Arduino.h>
+#include <stdint.h>
+
+#include "../Config.h"
+
+// 4 桁の 7 セグメント表示器。桁の切り替え (ダイナミック点灯) はタイマー割り込みで行い、
+// 割り込みの中では用意済みのバイトを 74HC595 へ送るだけにする
+class SevenSeg {
+public:
+  static constexpr int DIGITS = 4;
+
+  // 点灯するセグメント。bit0-6 が a-g、bit7 が小数点
+  struct Segments {
+    uint8_t digits[DIGITS] = {};
+    bool    colon          = false;
+
+    bool operator==(const Segments &other) const {
+      for (int i = 0; i < DIGITS; i++) {
+        if (digits[i] != other.digits[i]) return false;
+      }
+      return colon == other.colon;
+    }
+  };
+
+private:
+  // 74HC595 へそのまま送るバイト (アノードコモンなので 0 で点灯)
+  struct Buffer {
+    uint8_t bytes[DIGITS] = {0xFF, 0xFF, 0xFF, 0xFF};
+    bool    colon         = false;
+  };
+
+  Buffer           buffers[2];
+  volatile uint8_t front = 0; // 割り込みが読む側
+  uint8_t          digit = 0; // 点灯中の桁
+
+public:
+  void begin() {
+    pinMode(Config::SevenSeg::SDI, OUTPUT);
+    pinMode(Config::SevenSeg::RCLK, OUTPUT);
+    pinMode(Config::SevenSeg::SRCLK, OUTPUT);
+    pinMode(Config::SevenSeg::COLON_PIN, OUTPUT);
+    digitalWrite(Config::SevenSeg::COLON_PIN, LOW);
+    for (int i = 0; i < DIGITS; i++) {
+      pinMode(Config::SevenSeg::DIGIT_PINS[i], OUTPUT);
+      digitalWrite(Config::SevenSeg::DIGIT_PINS[i], LOW);
+    }
+
+    instance() = this;
+    attachTimerInterrupt(onTimer, Config::SevenSeg::MULTIPLEX_US);
+  }
+
+  // 裏のバッファに書いてから表に切り替えるので、割り込みが書きかけを読むことはない
+  void show(const Segments &segments) {
+    const uint8_t back = front ^ 1;
+    for (int i = 0; i < DIGITS; i++) buffers[back].bytes[i] = ~segments.digits[i];
+    buffers[back].colon = segments.colon;
+    front               = back;
+  }
+
+  // 割り込みから呼ぶ。1 回ごとに次の桁へ進める
+  void multiplex() {
+    const Buffer &buffer = buffers[front];
+    digitalWrite(Config::SevenSeg::DIGIT_PINS[digit], LOW);
+    digit = (digit + 1) % DIGITS;
+
+    digitalWrite(Config::SevenSeg::RCLK, LOW);
+    shiftOut(Config::SevenSeg::SDI, Config::SevenSeg::SRCLK, MSBFIRST, buffer.bytes[digit]);
+    digitalWrite(Config::SevenSeg::RCLK, HIGH);
+
+    digitalWrite(Config::SevenSeg::DIGIT_PINS[digit], HIGH);
+    digitalWrite(Config::SevenSeg::COLON_PIN, buffer.colon ? HIGH : LOW);
+  }
+
+  uint8_t getDigit() const {
+    return digit;
+  }
+
+private:
+  static SevenSeg *&instance() {
+    static SevenSeg *active = nullptr;
+    return active;
+  }
+
+  static unsigned int onTimer() {
+    if (instance()) instance()->multiplex();
+    return Config::SevenSeg::MULTIPLEX_US;
+  }
+};
@@ -0,0 +1,183 @@
+#pragma once
+
+#include <GNSS.h>
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "../Config.h"
+#include "../domain/Clock.h"
+#include "Cobs.h"
+#include "Crc32.h"
+
+// 1 回分の送信内容。この並びのまま CRC-32 を付け、COBS で包んで 0 で区切る
+struct TelemetrySnapshot {
+  uint8_t  version          = 1;
+  uint8_t  fixMode          = 0;
+  uint8_t  satellites       = 0;
+  uint8_t  reserved         = 0;
+  uint16_t sequence         = 0; // 送れずに捨てた分も進めるので、受信側で欠けを数えられる
+  uint16_t speedCentiKmh    = 0;
+  uint32_t uptimeMs         = 0;
+  uint32_t epoch            = 0; // Clock::getEpoch()
+  uint32_t distanceM        = 0;
+  uint32_t movingTimeMs     = 0;
+  uint32_t elapsedTimeMs    = 0;
+  int32_t  latE7            = 0;
+  int32_t  lonE7            = 0;
+  int16_t  altitudeM        = 0;
+  int16_t  gradientPermille = 0;
+  uint16_t avgCentiKmh      = 0;
+  uint16_t maxCentiKmh      = 0;
+};
+
+static_assert(sizeof(TelemetrySnapshot) == 44, "TelemetrySnapshot layout is part of the protocol");
+
+// バイト列の送信待ち行列。フレーム単位で積み、入らなければ待たずに捨てる
+template <size_t N> class TxQueue {
+private:
+  uint8_t  bytes[N];
+  size_t   head    = 0;
+  size_t   size    = 0;
+  uint32_t dropped = 0;
+
+public:
+  bool push(const uint8_t *data, size_t length) {
+    if (N - size < length) {
+      dropped++;
+      return false;
+    }
+    for (size_t i = 0; i < length; i++) bytes[(head + size + i) % N] = data[i];
+    size += length;
+    return true;
+  }
+
+  // port が今すぐ受け取れる分だけ書く。送信中に止まることはない
+  template <typename Port> size_t pump(Port &port) {
+    size_t written = 0;
+    int    room    = port.availableForWrite();
+    while (0 < size && 0 < room) {
+      size_t chunk = head + size <= N ? size : N - head;
+      if (static_cast<size_t>(room) < chunk) chunk = room;
+      const size_t sent = port.write(bytes + head, chunk);
+      head              = (head + sent) % N;
+      size -= sent;
+      room -= static_cast<int>(sent);
+      written += sent;
+      if (sent < chunk) break;
+    }
+    return written;
+  }
+
+  // 積んである分を書き切る。port.write() が送り終えるまで待つ
+  template <typename Port> void flush(Port &port) {
+    while (0 < size) {
+      const size_t chunk = head + size <= N ? size : N - head;
+      const size_t sent  = port.write(bytes + head, chunk);
+      if (sent == 0) return;
+      head = (head + sent) % N;
+      size -= sent;
+    }
+  }
+
+  size_t getSize() const {
+    return size;
+  }
+
+  uint32_t getDropped() const {
+    return dropped;
+  }
+};
+
+// 走行中の値を一定間隔でシリアルに流す
+class Telemetry {
+public:
+  static constexpr size_t PAYLOAD = sizeof(TelemetrySnapshot) + sizeof(uint32_t);
+  static constexpr size_t FRAME   = Cobs::maxEncodedSize(PAYLOAD) + 1;
+
+private:
+  TxQueue<Config::Telemetry::QUEUE_BYTES> queue;
+  unsigned long                           lastSendMillis = 0;
+  bool                                    hasSent        = false;
+  uint16_t                                sequence       = 0;
+
+public:
+  template <typename Trip>
+  void update(const Trip &trip, const Clock &clock, const SpNavData &navData, unsigned long now) {
+    if (!Config::Telemetry::ENABLED) return;
+    if (hasSent && now - lastSendMillis < Config::Telemetry::INTERVAL_MS) return;
+    lastSendMillis = now;
+    hasSent        = true;
+    send(capture(trip, clock, navData, now));
+  }
+
+  bool send(TelemetrySnapshot snapshot) {
+    snapshot.sequence = sequence++;
+    uint8_t      frame[FRAME];
+    const size_t length = encode(snapshot, frame);
+    return queue.push(frame, length);
+  }
+
+  template <typename Port> size_t pump(Port &port) {
+    return queue.pump(port);
+  }
+
+  // 文字で書き出す前に、送りかけのフレームを最後まで送る
+  template <typename Port> void flush(Port &port) {
+    queue.flush(port);
+  }
+
+  uint32_t getDropped() const {
+    return queue.getDropped();
+  }
+
+  size_t getQueuedBytes() const {
+    return queue.getSize();
+  }
+
+  // 区切りの 0 まで含めたフレームを out に書き、その長さを返す
+  static size_t encode(const TelemetrySnapshot &snapshot, uint8_t *out) {
+    uint8_t payload[PAYLOAD];
+    memcpy(payload, &snapshot, sizeof(snapshot));
+    const uint32_t crc = Crc32::compute(&snapshot, sizeof(snapshot));
+    memcpy(payload + sizeof(snapshot), &crc, sizeof(crc));
+
+    const size_t length = Cobs::encode(payload, PAYLOAD, out);
+    out[length]         = 0;
+    return length + 1;
+  }
+
+  template <typename Trip>
+  static TelemetrySnapshot capture(const Trip &trip, const Clock &clock, const SpNavData &navData,
+                                   unsigned long now) {
+    const float gradientPercent = trip.gradient.getGradientPercent();
+
+    TelemetrySnapshot snapshot;
+    snapshot.fixMode          = static_cast<uint8_t>(navData.posFixMode);
+    snapshot.satellites       = static_cast<uint8_t>(navData.numSatellites);
+    snapshot.speedCentiKmh    = toCenti(trip.speedEstimator.get());
+    snapshot.uptimeMs         = static_cast<uint32_t>(now);
+    snapshot.epoch            = clock.getEpoch();
+    snapshot.distanceM        = saturate(trip.odometer.getTotalMm() / 1000);
+    snapshot.movingTimeMs     = saturate(trip.stopwatch.getMovingTimeMs());
+    snapshot.elapsedTimeMs    = saturate(trip.stopwatch.getElapsedTimeMs());
+    snapshot.latE7            = static_cast<int32_t>(lround(navData.latitude * 1e7));
+    snapshot.lonE7            = static_cast<int32_t>(lround(navData.longitude * 1e7));
+    snapshot.altitudeM        = static_cast<int16_t>(lroundf(navData.altitude));
+    snapshot.gradientPermille = static_cast<int16_t>(lroundf(gradientPercent * 10.0f));
+    snapshot.avgCentiKmh      = toCenti(trip.speedometer.getAvg());
+    snapshot.maxCentiKmh      = toCenti(trip.speedometer.getMax());
+    return snapshot;
+  }
+
+private:
+  // 送信の形式は 32 ビットなので、49.7 日を超える時間は一周させずに頭打ちにする
+  static uint32_t saturate(uint64_t value) {
+    return value < UINT32_MAX ? static_cast<uint32_t>(value) : UINT32_MAX;
+  }
+
+  static uint16_t toCenti(float kmh) {
+    return kmh <= 0.0f ? 0 : static_cast<uint16_t>(kmh * 100.0f + 0.5f);
+  }
+};
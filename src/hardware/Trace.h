@@ -0,0 +1,192 @@
+#pragma once
+
+#include <Arduino.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "../Config.h"
+
+#if defined(ARDUINO_ARCH_SPRESENSE) && !defined(UNIT_TEST)
+#define TRACE_USE_CYCCNT
+#endif
+
+// 記録する区間・出来事。名前は Trace::getName() の表に同じ順で並べる
+enum class TraceEvent : uint8_t {
+  APP_UPDATE,
+  APP_BOOT, // arg: BootSequence::Stage
+  APP_TRIP,
+  APP_NAVIGATION, // POI と経路
+  APP_RATE, // GNSS の更新間隔
+  APP_SAVE,
+  APP_GRAPH,
+  APP_TELEMETRY,
+  APP_RENDER,
+  GNSS_UPDATE,
+  GNSS_FIX, // arg: 衛星数
+  INPUT_UPDATE,
+  INPUT_EVENT, // arg: Input::ID
+  RENDER,
+  RENDER_DISPLAY, // OLED への転送
+  Count
+};
+
+struct TraceRecord {
+  uint32_t ticks;
+  uint8_t  event;
+  uint8_t  phase; // 'B' 開始 / 'E' 終了 / 'i' 単発。Chrome の trace event と同じ
+  uint16_t arg;
+};
+
+static_assert(sizeof(TraceRecord) == 8, "TraceRecord layout is part of the dump format");
+
+// 直近 N 件を残すリングバッファ。溢れたら古いものから上書きする
+template <size_t N> class TraceBuffer {
+  static_assert(0 < N && (N & (N - 1)) == 0, "TraceBuffer size must be a power of two");
+
+private:
+  TraceRecord records[N];
+  uint32_t    head = 0; // これまでに書いた件数
+
+public:
+  // 書く位置だけを不可分に確保するので、割り込みの中から呼んでも記録が重ならない
+  void emit(uint32_t ticks, TraceEvent event, char phase, uint16_t arg) {
+    const uint32_t slot   = __atomic_fetch_add(&head, 1, __ATOMIC_RELAXED);
+    TraceRecord   &record = records[slot & (N - 1)];
+    record.ticks          = ticks;
+    record.event          = static_cast<uint8_t>(event);
+    record.phase          = static_cast<uint8_t>(phase);
+    record.arg            = arg;
+  }
+
+  void clear() {
+    __atomic_store_n(&head, 0, __ATOMIC_RELAXED);
+  }
+
+  size_t getCount() const {
+    const uint32_t total = __atomic_load_n(&head, __ATOMIC_RELAXED);
+    return total < N ? total : N;
+  }
+
+  uint32_t getDropped() const {
+    const uint32_t total = __atomic_load_n(&head, __ATOMIC_RELAXED);
+    return total < N ? 0 : total - N;
+  }
+
+  // 古い順
+  const TraceRecord &at(size_t index) const {
+    const uint32_t total = __atomic_load_n(&head, __ATOMIC_RELAXED);
+    const uint32_t first = total < N ? 0 : total - N;
+    return records[(first + index) & (N - 1)];
+  }
+
+  // "TRACE1 <ticks/us> <件数> <上書きで失った件数>" の後に 1 件 1 行の 16 進、最後に "END"
+  template <typename Out> void dump(Out &out, uint32_t ticksPerUs) const {
+    const size_t count = getCount();
+    char         line[40];
+    snprintf(line, sizeof(line), "TRACE1 %lu %lu %lu\n", static_cast<unsigned long>(ticksPerUs),
+             static_cast<unsigned long>(count), static_cast<unsigned long>(getDropped()));
+    out.print(line);
+    for (size_t i = 0; i < count; i++) {
+      const TraceRecord &record = at(i);
+      snprintf(line, sizeof(line), "%08lx%02x%02x%04x\n",
+               static_cast<unsigned long>(record.ticks), record.event, record.phase, record.arg);
+      out.print(line);
+    }
+    out.print("END\n");
+  }
+};
+
+// 全体で 1 つのトレース。時刻は CPU のサイクルカウンタ (ホストでは micros())
+class Trace {
+public:
+  typedef TraceBuffer<Config::Trace::CAPACITY> Buffer;
+
+#ifdef TRACE_USE_CYCCNT
+  static constexpr uint32_t TICKS_PER_US = Config::Trace::CPU_MHZ;
+#else
+  static constexpr uint32_t TICKS_PER_US = 1;
+#endif
+
+  static Buffer &buffer() {
+    static Buffer instance;
+    return instance;
+  }
+
+  // サイクルカウンタ (DWT_CYCCNT) を動かす
+  static void begin() {
+#ifdef TRACE_USE_CYCCNT
+    *reinterpret_cast<volatile uint32_t *>(0xE000EDFC) |= 1UL << 24; // DEMCR.TRCENA
+    *reinterpret_cast<volatile uint32_t *>(0xE0001004) = 0;          // DWT_CYCCNT
+    *reinterpret_cast<volatile uint32_t *>(0xE0001000) |= 1UL;       // DWT_CTRL.CYCCNTENA
+#endif
+  }
+
+  static uint32_t now() {
+#ifdef TRACE_USE_CYCCNT
+    return *reinterpret_cast<volatile uint32_t *>(0xE0001004);
+#else
+    return static_cast<uint32_t>(micros());
+#endif
+  }
+
+  static void enter(TraceEvent event, uint16_t arg = 0) {
+    emit(event, 'B', arg);
+  }
+
+  static void leave(TraceEvent event, uint16_t arg = 0) {
+    emit(event, 'E', arg);
+  }
+
+  static void mark(TraceEvent event, uint16_t arg = 0) {
+    emit(event, 'i', arg);
+  }
+
+  template <typename Out> static void dump(Out &out) {
+    buffer().dump(out, TICKS_PER_US);
+  }
+
+  static const char *getName(uint8_t event) {
+    static const char *const NAMES[] = {
+        "APP_UPDATE",
+        "APP_BOOT",
+        "APP_TRIP",
+        "APP_NAVIGATION",
+        "APP_RATE",
+        "APP_SAVE",
+        "APP_GRAPH",
+        "APP_TELEMETRY",
+        "APP_RENDER",
+        "GNSS_UPDATE",
+        "GNSS_FIX",
+        "INPUT_UPDATE",
+        "INPUT_EVENT",
+        "RENDER",
+        "RENDER_DISPLAY",
+    };
+    static_assert(sizeof(NAMES) / sizeof(NAMES[0]) == static_cast<size_t>(TraceEvent::Count),
+                  "every TraceEvent needs a name");
+    return event < static_cast<uint8_t>(TraceEvent::Count) ? NAMES[event] : nullptr;
+  }
+
+private:
+  static void emit(TraceEvent event, char phase, uint16_t arg) {
+    if (!Config::Trace::ENABLED) return;
+    buffer().emit(now(), event, phase, arg);
+  }
+};
+
+// スコープの出入りを 1 組の区間として記録する
+class TraceScope {
+private:
+  const TraceEvent event;
+
+public:
+  explicit TraceScope(TraceEvent event, uint16_t arg = 0) : event(event) {
+    Trace::enter(event, arg);
+  }
+
+  ~TraceScope() {
+    Trace::leave(event);
+  }
+};
@@ -0,0 +1,182 @@
+#pragma once
+
+#include <Flash.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../Config.h"
+#include "../domain/RideSummary.h"
+#include "Crc32.h"
+
+// 終えた走行の要約を固定長で追記していく履歴 (FILE_WRITE は追記になるため、書き換えはしない)
+//   データ: RideSummary[count]。古い順なので、N 件前の記録は位置が決まり 1 回の読み込みで取り出せる
+//   索引:   uint32_t key[count]。開始時刻を単調非減少にしたもので、日付の範囲を二分探索する
+// 書き込み途中で電源が落ちても、次の begin() で位置を揃え直し、索引をデータから作り直す
+class TripHistory {
+private:
+  static constexpr size_t RECORD = sizeof(RideSummary);
+  static constexpr size_t KEY    = sizeof(uint32_t);
+
+  const char *dataPath;
+  const char *keyPath;
+  uint32_t    count   = 0;
+  uint32_t    lastKey = 0;
+  bool        isOpen  = false; // 位置と索引が揃っている。揃うまで追記しない
+
+public:
+  TripHistory(const char *dataPath, const char *keyPath) : dataPath(dataPath), keyPath(keyPath) {}
+
+  bool begin() {
+    isOpen = repair();
+    return isOpen;
+  }
+
+  bool append(RideSummary ride) {
+    if (!isOpen && !begin()) return false;
+    if (Config::History::CAPACITY <= count) return false;
+    ride.reserved = 0;
+    ride.crc      = checksum(ride);
+
+    File file = Flash.open(dataPath, FILE_WRITE);
+    if (!file) return false;
+    const size_t written = file.write(reinterpret_cast<const uint8_t *>(&ride), RECORD);
+    file.close();
+    if (written != RECORD) {
+      begin(); // 途中まで書いた分を埋めて位置を揃える
+      return false;
+    }
+    count++;
+
+    const uint32_t key  = lastKey < ride.startEpoch ? ride.startEpoch : lastKey;
+    File           keys = Flash.open(keyPath, FILE_WRITE);
+    if (!keys || keys.write(reinterpret_cast<const uint8_t *>(&key), KEY) != KEY) {
+      if (keys) keys.close();
+      isOpen = rebuildKeys();
+      return isOpen;
+    }
+    keys.close();
+    lastKey = key;
+    return true;
+  }
+
+  uint32_t getCount() const {
+    return count;
+  }
+
+  // index は古い順の通し番号。壊れた記録なら false
+  bool get(uint32_t index, RideSummary &out) const {
+    if (count <= index) return false;
+    File file = Flash.open(dataPath, FILE_READ);
+    if (!file) return false;
+    const bool isRead = file.seek(index * RECORD) &&
+                        file.read(&out, RECORD) == static_cast<int>(RECORD);
+    file.close();
+    return isRead && out.crc == checksum(out);
+  }
+
+  // n 件前 (0 が最新) の記録
+  bool getRecent(uint32_t n, RideSummary &out) const {
+    return n < count && get(count - 1 - n, out);
+  }
+
+  // [fromEpoch, toEpoch) に始まった走行の通し番号の範囲 [first, last)
+  void findRange(uint32_t fromEpoch, uint32_t toEpoch, uint32_t &first, uint32_t &last) const {
+    first = lowerBound(fromEpoch);
+    last  = lowerBound(toEpoch);
+    if (last < first) last = first;
+  }
+
+private:
+  // データの末尾を記録の区切りに揃え、索引の件数が合わなければ作り直す
+  bool repair() {
+    count   = 0;
+    lastKey = 0;
+
+    uint32_t size = fileSize(dataPath);
+    if (size % RECORD != 0) {
+      // 途中まで書いた記録は 0 で埋め、壊れた 1 件として扱う
+      const uint8_t zeros[RECORD] = {};
+      const size_t  pad           = RECORD - size % RECORD;
+      File          file          = Flash.open(dataPath, FILE_WRITE);
+      if (!file) return false;
+      const size_t written = file.write(zeros, pad);
+      file.close();
+      if (written != pad) return false;
+      size += pad;
+    }
+    count = size / RECORD;
+
+    if (fileSize(keyPath) != count * KEY) return rebuildKeys();
+    return count == 0 || readKey(count - 1, lastKey);
+  }
+
+  static uint32_t checksum(const RideSummary &ride) {
+    return Crc32::compute(&ride, offsetof(RideSummary, crc));
+  }
+
+  static uint32_t fileSize(const char *path) {
+    if (!Flash.exists(path)) return 0;
+    File     file = Flash.open(path, FILE_READ);
+    uint32_t size = file ? file.size() : 0;
+    if (file) file.close();
+    return size;
+  }
+
+  bool readKey(uint32_t index, uint32_t &key) const {
+    File file = Flash.open(keyPath, FILE_READ);
+    if (!file) return false;
+    const bool isRead =
+        file.seek(index * KEY) && file.read(&key, KEY) == static_cast<int>(KEY);
+    file.close();
+    return isRead;
+  }
+
+  // key が epoch 以上になる最初の通し番号。索引を二分探索するので読み込みは log2(count) 回
+  uint32_t lowerBound(uint32_t epoch) const {
+    File file = Flash.open(keyPath, FILE_READ);
+    if (!file) return count;
+
+    uint32_t low  = 0;
+    uint32_t high = count;
+    while (low < high) {
+      const uint32_t mid = low + (high - low) / 2;
+      uint32_t       key = 0;
+      if (!file.seek(mid * KEY) || file.read(&key, KEY) != static_cast<int>(KEY)) break;
+      if (key < epoch) low = mid + 1;
+      else high = mid;
+    }
+    file.close();
+    return low;
+  }
+
+  // データを先頭から読んで索引を書き直す。壊れた記録は直前と同じ key にする
+  bool rebuildKeys() {
+    Flash.remove(keyPath);
+    lastKey = 0;
+    if (count == 0) return true;
+
+    File data = Flash.open(dataPath, FILE_READ);
+    File keys = Flash.open(keyPath, FILE_WRITE);
+    bool isOk = data && keys;
+
+    uint32_t buffer[64]; // 書き込みはまとめて行う
+    size_t   buffered = 0;
+    for (uint32_t i = 0; isOk && i < count; i++) {
+      RideSummary ride;
+      if (data.read(&ride, RECORD) != static_cast<int>(RECORD)) {
+        isOk = false;
+        break;
+      }
+      if (ride.crc == checksum(ride) && lastKey < ride.startEpoch) lastKey = ride.startEpoch;
+      buffer[buffered++] = lastKey;
+      if (buffered == 64 || i + 1 == count) {
+        const size_t bytes = buffered * KEY;
+        buffered           = 0;
+        if (keys.write(reinterpret_cast<const uint8_t *>(buffer), bytes) != bytes) isOk = false;
+      }
+    }
+    if (data) data.close();
+    if (keys) keys.close();
+    return isOk;
+  }
+};
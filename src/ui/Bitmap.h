@@ -0,0 +1,144 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "../Config.h"
+
+// 1 ビット/画素の画像。行優先・MSB が左端で、Adafruit_GFX::drawBitmap にそのまま渡せる
+template <int W, int H> class Bitmap {
+public:
+  static constexpr int    WIDTH      = W;
+  static constexpr int    HEIGHT     = H;
+  static constexpr int    BYTE_WIDTH = (W + 7) / 8;
+  static constexpr size_t SIZE       = BYTE_WIDTH * H;
+
+private:
+  uint8_t bits[SIZE];
+
+public:
+  Bitmap() {
+    clear();
+  }
+
+  void clear() {
+    memset(bits, 0, sizeof(bits));
+  }
+
+  const uint8_t *data() const {
+    return bits;
+  }
+
+  bool get(int x, int y) const {
+    if (!contains(x, y)) return false;
+    return bits[y * BYTE_WIDTH + x / 8] & (0x80 >> (x % 8));
+  }
+
+  void set(int x, int y) {
+    if (contains(x, y)) bits[y * BYTE_WIDTH + x / 8] |= 0x80 >> (x % 8);
+  }
+
+  // 全体を 1 画素左へずらし、右端の列を空ける
+  void shiftLeft() {
+    for (int y = 0; y < H; y++) {
+      uint8_t *row = bits + y * BYTE_WIDTH;
+      for (int i = 0; i < BYTE_WIDTH - 1; i++) row[i] = (row[i] << 1) | (row[i + 1] >> 7);
+      row[BYTE_WIDTH - 1] <<= 1;
+    }
+  }
+
+  void clearColumn(int x) {
+    for (int y = 0; y < H; y++) bits[y * BYTE_WIDTH + x / 8] &= ~(0x80 >> (x % 8));
+  }
+
+  static bool contains(int x, int y) {
+    return 0 <= x && x < W && 0 <= y && y < H;
+  }
+
+  // Bresenham 法で線を引き、描いた画素数を返す。画面外の部分は先に切り落とす
+  uint32_t drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1) {
+    if (!clip(x0, y0, x1, y1)) return 0;
+
+    const int32_t dx    = x0 < x1 ? x1 - x0 : x0 - x1;
+    const int32_t dy    = y0 < y1 ? y0 - y1 : y1 - y0; // 負
+    const int32_t sx    = x0 < x1 ? 1 : -1;
+    const int32_t sy    = y0 < y1 ? 1 : -1;
+    int32_t       err   = dx + dy;
+    uint32_t      count = 0;
+    for (;;) {
+      set(x0, y0);
+      count++;
+      if (x0 == x1 && y0 == y1) return count;
+      const int32_t e2 = 2 * err;
+      if (dy <= e2) {
+        err += dy;
+        x0 += sx;
+      }
+      if (e2 <= dx) {
+        err += dx;
+        y0 += sy;
+      }
+    }
+  }
+
+private:
+  enum : uint8_t { LEFT = 1, RIGHT = 2, TOP = 4, BOTTOM = 8 };
+
+  static uint8_t outcode(int32_t x, int32_t y) {
+    uint8_t code = 0;
+    if (x < 0) code |= LEFT;
+    else if (W - 1 < x) code |= RIGHT;
+    if (y < 0) code |= TOP;
+    else if (H - 1 < y) code |= BOTTOM;
+    return code;
+  }
+
+  // Cohen-Sutherland 法。画面と交わらなければ false
+  static bool clip(int32_t &x0, int32_t &y0, int32_t &x1, int32_t &y1) {
+    uint8_t code0 = outcode(x0, y0);
+    uint8_t code1 = outcode(x1, y1);
+    for (;;) {
+      if (!(code0 | code1)) return true;
+      if (code0 & code1) return false;
+
+      const uint8_t code = code0 ? code0 : code1;
+      const int64_t dx   = static_cast<int64_t>(x1) - x0;
+      const int64_t dy   = static_cast<int64_t>(y1) - y0;
+      int32_t       x;
+      int32_t       y;
+      if (code & BOTTOM) {
+        y = H - 1;
+        x = static_cast<int32_t>(x0 + dx * (y - y0) / dy);
+      } else if (code & TOP) {
+        y = 0;
+        x = static_cast<int32_t>(x0 + dx * (y - y0) / dy);
+      } else if (code & RIGHT) {
+        x = W - 1;
+        y = static_cast<int32_t>(y0 + dy * (x - x0) / dx);
+      } else {
+        x = 0;
+        y = static_cast<int32_t>(y0 + dy * (x - x0) / dx);
+      }
+
+      if (code == code0) {
+        x0    = x;
+        y0    = y;
+        code0 = outcode(x0, y0);
+      } else {
+        x1    = x;
+        y1    = y;
+        code1 = outcode(x1, y1);
+      }
+    }
+  }
+};
+
+template <int W, int H> constexpr int Bitmap<W, H>::WIDTH;
+template <int W, int H> constexpr int Bitmap<W, H>::HEIGHT;
+template <int W, int H> constexpr int Bitmap<W, H>::BYTE_WIDTH;
+template <int W, int H> constexpr size_t Bitmap<W, H>::SIZE;
+
+// ヘッダの下の描画領域
+typedef Bitmap<Config::OLED::WIDTH, Config::OLED::HEIGHT - Config::Renderer::HEADER_HEIGHT>
+    MainAreaBitmap;
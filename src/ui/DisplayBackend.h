@@ -0,0 +1,26 @@
+#pragma once
+
+#include "Frame.h"
+
+// Renderer が描画先に求める操作。派生クラスは自分を Derived に渡して継承し、
+// beginDisplay() と drawFrame() を実装する。呼び出しはコンパイル時に決まり、仮想関数を使わない
+template <typename Derived> class DisplayBackend {
+public:
+  bool begin() {
+    return self().beginDisplay();
+  }
+
+  // 前回と異なる Frame のときだけ呼ばれる
+  void draw(const Frame &frame) {
+    self().drawFrame(frame);
+  }
+
+protected:
+  DisplayBackend()  = default;
+  ~DisplayBackend() = default;
+
+private:
+  Derived &self() {
+    return static_cast<Derived &>(*this);
+  }
+};
@@ -3,6 +3,7 @@
 #include <cstdio>
 
 #include "../domain/Clock.h"
+#include "../domain/PoiIndex.h"
 
 class Formatter {
 public:
@@ -10,19 +11,77 @@ public:
     snprintf(buffer, size, "%4.1f", speedKmh);
   }
 
+  static void formatSpeedPair(float firstKmh, float secondKmh, char *buffer, size_t size) {
+    snprintf(buffer, size, "%.1f/%.1f", firstKmh, secondKmh);
+  }
+
   static void formatDistance(float distanceKm, char *buffer, size_t size) {
     snprintf(buffer, size, "%5.2f", distanceKm);
   }
 
+  static void formatGradient(float percent, char *buffer, size_t size) {
+    snprintf(buffer, size, "%+4.1f", percent);
+  }
+
+  static void formatMeters(float meters, char *buffer, size_t size) {
+    snprintf(buffer, size, "%3.0f", meters);
+  }
+
+  static void formatLongDistance(float distanceKm, char *buffer, size_t size) {
+    snprintf(buffer, size, "%6.1f", distanceKm);
+  }
+
   static void formatTime(const Clock::Time time, char *buffer, size_t size) {
     snprintf(buffer, size, "%02d:%02d", time.hour, time.minute);
   }
 
-  static void formatDuration(unsigned long millis, char *buffer, size_t size) {
-    const unsigned long seconds = millis / 1000;
-    const unsigned long h       = seconds / 3600;
-    const unsigned long m       = (seconds % 3600) / 60;
-    const unsigned long s       = seconds % 60;
+  static void formatDate(const Clock::Date date, char *buffer, size_t size) {
+    snprintf(buffer, size, "%02d/%02d", date.month, date.day);
+  }
+
+  static void formatRideNumber(uint32_t number, char *buffer, size_t size) {
+    snprintf(buffer, size, "#%lu", static_cast<unsigned long>(number));
+  }
+
+  static void formatLapNumber(size_t number, char *buffer, size_t size) {
+    snprintf(buffer, size, "L%u", static_cast<unsigned>(number));
+  }
+
+  static void formatProgress(int done, int total, char *buffer, size_t size) {
+    snprintf(buffer, size, "%d/%d", done, total);
+  }
+
+  static void formatScale(int metersPerPixel, char *buffer, size_t size) {
+    snprintf(buffer, size, "%dm/px", metersPerPixel);
+  }
+
+  static void formatPoiKind(PoiFormat::Kind kind, char *buffer, size_t size) {
+    switch (kind) {
+    case PoiFormat::Kind::WATER:
+      snprintf(buffer, size, "WATER");
+      break;
+    case PoiFormat::Kind::HAZARD:
+      snprintf(buffer, size, "HAZARD");
+      break;
+    case PoiFormat::Kind::CHECKPOINT:
+      snprintf(buffer, size, "CHECK");
+      break;
+    default:
+      snprintf(buffer, size, "POI");
+      break;
+    }
+  }
+
+  // 名前は終端の '\0' がないことがある
+  static void formatPoiName(const char *name, char *buffer, size_t size) {
+    snprintf(buffer, size, "%.*s", static_cast<int>(PoiFormat::NAME_LEN), name);
+  }
+
+  static void formatDuration(uint64_t millis, char *buffer, size_t size) {
+    const uint64_t      seconds = millis / 1000;
+    const unsigned long h       = static_cast<unsigned long>(seconds / 3600);
+    const unsigned long m       = static_cast<unsigned long>(seconds % 3600 / 60);
+    const unsigned long s       = static_cast<unsigned long>(seconds % 60);
 
     if (0 < h) snprintf(buffer, size, "%lu:%02lu:%02lu", h, m, s);
     else snprintf(buffer, size, "%02lu:%02lu", m, s);
@@ -3,10 +3,17 @@
 #include <GNSS.h>
 #include <cstring>
 
+#include "../domain/BootSequence.h"
 #include "../domain/Clock.h"
+#include "../domain/PoiAlert.h"
+#include "../domain/RideSummary.h"
+#include "../domain/RouteMatcher.h"
 #include "../domain/Trip.h"
 #include "Formatter.h"
+#include "GraphView.h"
+#include "Layout.h"
 #include "Mode.h"
+#include "TrackMap.h"
 
 struct Frame {
   struct Item {
@@ -31,18 +38,72 @@ struct Frame {
     }
   };
 
-  Header header;
-  Item   main;
-  Item   sub;
+  // 画像で描く画面。各モードが必要とするものだけを渡す
+  struct Views {
+    const TrackMap     *trackMap     = nullptr;
+    const GraphView    *graphView    = nullptr;
+    const PoiAlert     *poiAlert     = nullptr; // 通知中だけ渡す。どのモードよりも優先して表示する
+    const RouteMatcher *routeMatcher = nullptr;
+    const RideSummary  *ride         = nullptr; // 履歴で選んでいる走行。読めなければ nullptr
+    uint32_t            rideNumber   = 0;       // 1 が最新
+    const Layout       *layout       = nullptr;
+    uint8_t             layoutPage   = 0;
+  };
+
+  // main と sub の代わりに表示する画像
+  struct Graphic {
+    const MainAreaBitmap *image    = nullptr; // nullptr なら main と sub を表示する
+    uint32_t              revision = 0;
+    int16_t               markerX  = -1; // 現在地などの印。なければ -1
+    int16_t               markerY  = -1;
+
+    bool operator==(const Graphic &other) const {
+      return image == other.image && revision == other.revision && markerX == other.markerX &&
+             markerY == other.markerY;
+    }
+  };
+
+  // main と sub の代わりに、Layout の 1 画面分の項目を描く。位置は解決済みなので値だけを持つ
+  struct Page {
+    const Layout::Item *items    = nullptr; // nullptr なら main と sub を表示する
+    uint32_t            revision = 0;       // Layout::getRevision()
+    uint8_t             count    = 0;
+    char                values[Config::Layout::MAX_PAGE_ITEMS][12] = {};
+
+    bool operator==(const Page &other) const {
+      if (items != other.items || revision != other.revision || count != other.count) return false;
+      for (uint8_t i = 0; i < count; i++) {
+        if (strcmp(values[i], other.values[i]) != 0) return false;
+      }
+      return true;
+    }
+  };
+
+  Header  header;
+  Item    main;
+  Item    sub;
+  Graphic graphic;
+  Page    page;
 
   Frame() = default;
 
   bool operator==(const Frame &other) const {
-    return header == other.header && main == other.main && sub == other.sub;
+    return header == other.header && main == other.main && sub == other.sub &&
+           graphic == other.graphic && page == other.page;
+  }
+
+  // 起動中の表示。進んでいる段階と、全段階のうちいくつ終えたかを出す
+  explicit Frame(const BootSequence &boot) {
+    const BootSequence::Stage stage = boot.get();
+    Formatter::formatProgress(static_cast<int>(stage), static_cast<int>(BootSequence::Stage::READY),
+                              header.modeTime, sizeof(header.modeTime));
+    strcpy(main.value, "BOOT");
+    strcpy(sub.value, BootSequence::getName(stage));
   }
 
-  Frame(Trip &trip, Clock &clock, Mode::ID modeId, SpFixMode fixMode) {
-    getModeData(trip, clock, modeId);
+  Frame(Trip &trip, Clock &clock, Mode::ID modeId, SpFixMode fixMode, const Views &views) {
+    if (views.poiAlert) getPoiData(*views.poiAlert);
+    else getModeData(trip, clock, modeId, views);
 
     switch (fixMode) {
     case FixInvalid:
@@ -58,15 +119,27 @@ struct Frame {
       strcpy(header.fixStatus, "");
       break;
     }
+    // コース外れはどのモードでも分かるようにする
+    if (fixMode != FixInvalid && views.routeMatcher && views.routeMatcher->isOff()) {
+      strcpy(header.fixStatus, "OFF");
+    }
   }
 
 private:
-  void getModeData(Trip &trip, Clock &clock, Mode::ID modeId) {
+  void getPoiData(const PoiAlert &alert) {
+    const PoiFormat::Record &record = alert.getRecord();
+    Formatter::formatPoiKind(record.kind, header.modeSpeed, sizeof(header.modeSpeed));
+    Formatter::formatMeters(alert.getDistanceM(), main.value, sizeof(main.value));
+    strcpy(main.unit, "m");
+    Formatter::formatPoiName(record.name, sub.value, sizeof(sub.value));
+  }
+
+  void getModeData(Trip &trip, Clock &clock, Mode::ID modeId, const Views &views) {
     switch (modeId) {
     case Mode::ID::SPD_TIME:
       strcpy(header.modeSpeed, "SPD");
       strcpy(header.modeTime, "Time");
-      Formatter::formatSpeed(trip.speedometer.getCur(), main.value, sizeof(main.value));
+      Formatter::formatSpeed(trip.speedEstimator.get(), main.value, sizeof(main.value));
       strcpy(main.unit, "km/h");
       Formatter::formatDuration(trip.stopwatch.getElapsedTimeMs(), sub.value, sizeof(sub.value));
       strcpy(sub.unit, "");
@@ -87,6 +160,130 @@ private:
       Formatter::formatTime(clock.getTime(), sub.value, sizeof(sub.value));
       strcpy(sub.unit, "");
       break;
+    case Mode::ID::TRIP_A:
+    case Mode::ID::TRIP_B: {
+      const bool        isA = modeId == Mode::ID::TRIP_A;
+      const TripCounter counter =
+          trip.getCounter(isA ? Trip::Counter::TRIP_A : Trip::Counter::TRIP_B);
+      strcpy(header.modeSpeed, isA ? "TRIP A" : "TRIP B");
+      strcpy(header.modeTime, "Avg");
+      Formatter::formatDistance(counter.getDistanceKm(), main.value, sizeof(main.value));
+      strcpy(main.unit, "km");
+      Formatter::formatSpeed(counter.getAvgKmh(), sub.value, sizeof(sub.value));
+      strcpy(sub.unit, "km/h");
+      break;
+    }
+    case Mode::ID::LIFETIME: {
+      const TripCounter counter = trip.getCounter(Trip::Counter::LIFETIME);
+      strcpy(header.modeSpeed, "TOTAL");
+      strcpy(header.modeTime, "Ride");
+      Formatter::formatLongDistance(counter.getDistanceKm(), main.value, sizeof(main.value));
+      strcpy(main.unit, "km");
+      Formatter::formatDuration(counter.movingTimeMs, sub.value, sizeof(sub.value));
+      strcpy(sub.unit, "");
+      break;
+    }
+    case Mode::ID::HISTORY:
+      strcpy(header.modeSpeed, "LOG");
+      strcpy(main.unit, "km");
+      Formatter::formatRideNumber(views.rideNumber, header.modeTime, sizeof(header.modeTime));
+      if (!views.ride) {
+        strcpy(main.value, "--.--");
+        strcpy(sub.value, "");
+        strcpy(sub.unit, "");
+        break;
+      }
+      if (views.ride->startEpoch != 0) {
+        Formatter::formatDate(clock.getLocalDate(views.ride->startEpoch), header.modeSpeed,
+                              sizeof(header.modeSpeed));
+      }
+      Formatter::formatDistance(views.ride->distanceM / 1000.0f, main.value, sizeof(main.value));
+      Formatter::formatDuration(views.ride->movingTimeMs, sub.value, sizeof(sub.value));
+      strcpy(sub.unit, "");
+      break;
+    case Mode::ID::ROLLING_AVG:
+      strcpy(header.modeSpeed, "10s");
+      strcpy(header.modeTime, "1m/5m");
+      Formatter::formatSpeed(trip.speedometer.getAvg10s(), main.value, sizeof(main.value));
+      strcpy(main.unit, "km/h");
+      Formatter::formatSpeedPair(trip.speedometer.getAvg1min(), trip.speedometer.getAvg5min(),
+                                 sub.value, sizeof(sub.value));
+      strcpy(sub.unit, "");
+      break;
+    case Mode::ID::LAP: {
+      const LapTimer::Lap lap = trip.getCurrentLap();
+      strcpy(header.modeSpeed, "LAP");
+      Formatter::formatLapNumber(trip.laps.getCount() + 1, header.modeTime,
+                                 sizeof(header.modeTime));
+      Formatter::formatSpeed(lap.getAvgKmh(), main.value, sizeof(main.value));
+      strcpy(main.unit, "km/h");
+      Formatter::formatDuration(lap.elapsedTimeMs, sub.value, sizeof(sub.value));
+      strcpy(sub.unit, "");
+      break;
+    }
+    case Mode::ID::ROUTE:
+      strcpy(header.modeSpeed, "TO GO");
+      strcpy(main.unit, "km");
+      strcpy(sub.unit, "m");
+      if (!views.routeMatcher || !views.routeMatcher->hasRoute()) {
+        strcpy(main.value, "--.--");
+        strcpy(sub.value, "");
+        strcpy(sub.unit, "");
+        break;
+      }
+      strcpy(header.modeTime, views.routeMatcher->isOff() ? "Off" : "On");
+      Formatter::formatDistance(views.routeMatcher->getDistanceToGoM() / 1000.0f, main.value,
+                                sizeof(main.value));
+      Formatter::formatMeters(views.routeMatcher->getOffsetM(), sub.value, sizeof(sub.value));
+      break;
+    case Mode::ID::CLIMB:
+      strcpy(header.modeSpeed, "GRADE");
+      strcpy(header.modeTime, "Climb");
+      Formatter::formatGradient(trip.gradient.getGradientPercent(), main.value, sizeof(main.value));
+      strcpy(main.unit, "%");
+      Formatter::formatMeters(trip.gradient.getAscentM(), sub.value, sizeof(sub.value));
+      strcpy(sub.unit, "m");
+      break;
+    case Mode::ID::MAP:
+      strcpy(header.modeSpeed, "MAP");
+      if (!views.trackMap) {
+        strcpy(main.value, "ERROR");
+        break;
+      }
+      Formatter::formatScale(views.trackMap->getScaleMPerPx(), header.modeTime,
+                             sizeof(header.modeTime));
+      graphic.image    = &views.trackMap->getImage();
+      graphic.revision = views.trackMap->getRevision();
+      if (!views.trackMap->getHead(trip.breadcrumb, graphic.markerX, graphic.markerY)) {
+        graphic.markerX = graphic.markerY = -1;
+      }
+      break;
+    case Mode::ID::GRAPH:
+      strcpy(header.modeSpeed, "SPD/ALT");
+      if (!views.graphView) {
+        strcpy(main.value, "ERROR");
+        break;
+      }
+      Formatter::formatDuration(Config::Graph::COLUMN_MS * GraphView::Image::WIDTH,
+                                header.modeTime, sizeof(header.modeTime));
+      graphic.image    = &views.graphView->getImage();
+      graphic.revision = views.graphView->getRevision();
+      break;
+    case Mode::ID::PAGE:
+      strcpy(header.modeSpeed, "PAGE");
+      if (!views.layout || views.layout->getPageCount() == 0) {
+        strcpy(main.value, "--.--");
+        break;
+      }
+      Formatter::formatProgress(views.layoutPage + 1, views.layout->getPageCount(),
+                                header.modeTime, sizeof(header.modeTime));
+      page.items    = views.layout->getPage(views.layoutPage, page.count);
+      page.revision = views.layout->getRevision();
+      for (uint8_t i = 0; i < page.count; i++) {
+        page.items[i].format(trip, clock, page.values[i], sizeof(page.values[i]));
+      }
+      strcpy(main.value, page.values[0]); // 7 セグメント表示器は最初の項目だけを出す
+      break;
     default:
       strcpy(main.value, "ERROR");
       strcpy(main.unit, "");
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <math.h>
+#include <stdint.h>
+
+#include "../Config.h"
+#include "Bitmap.h"
+#include "Sparkline.h"
+
+// 直近の速度 (上段) と高度 (下段) を右から左へ流れるグラフで描く
+// 列が確定するたびに画像を 1 列ずらして右端の列だけを描き、表示範囲が変わったときだけ全体を描き直す
+class GraphView {
+public:
+  typedef MainAreaBitmap Image;
+
+  struct Stats {
+    uint32_t updates     = 0;
+    uint32_t columns     = 0;
+    uint32_t fullRedraws = 0;
+  };
+
+private:
+  static constexpr int ROWS = Image::HEIGHT / 2;
+
+  Image                   image;
+  Sparkline<Image::WIDTH> speed;
+  Sparkline<Image::WIDTH> altitude;
+  unsigned long           columnStart = 0;
+  bool                    hasStart    = false;
+  uint32_t                revision    = 0;
+  Stats                   stats;
+
+public:
+  GraphView() : speed(Config::Graph::SPEED_STEP), altitude(Config::Graph::ALTITUDE_STEP) {}
+
+  // 画像が変わったら true
+  bool update(float speedKmh, float altitudeM, bool hasFix, unsigned long nowMs) {
+    stats.updates++;
+    if (!hasStart) {
+      columnStart = nowMs;
+      hasStart    = true;
+    }
+    if (hasFix) {
+      speed.add(static_cast<int16_t>(lroundf(speedKmh * Config::Graph::SPEED_SCALE)));
+      altitude.add(static_cast<int16_t>(lroundf(altitudeM)));
+    }
+
+    const unsigned long elapsed = nowMs - columnStart;
+    if (elapsed < Config::Graph::COLUMN_MS) return false;
+
+    unsigned long columns = elapsed / Config::Graph::COLUMN_MS;
+    columnStart += columns * Config::Graph::COLUMN_MS;
+    if (Image::WIDTH < columns) columns = Image::WIDTH;
+
+    bool isRescaled = false;
+    for (unsigned long i = 0; i < columns; i++) {
+      isRescaled |= speed.commit();
+      isRescaled |= altitude.commit();
+      if (!isRescaled) scroll();
+    }
+    if (isRescaled) redraw();
+
+    stats.columns += columns;
+    revision++;
+    return true;
+  }
+
+  const Image &getImage() const {
+    return image;
+  }
+
+  uint32_t getRevision() const {
+    return revision;
+  }
+
+  const Stats &getStats() const {
+    return stats;
+  }
+
+  const Sparkline<Image::WIDTH> &getSpeed() const {
+    return speed;
+  }
+
+  const Sparkline<Image::WIDTH> &getAltitude() const {
+    return altitude;
+  }
+
+private:
+  void scroll() {
+    image.shiftLeft();
+    speed.drawColumn(image, Image::WIDTH - 1, 0, 0, ROWS - 1);
+    altitude.drawColumn(image, Image::WIDTH - 1, 0, ROWS, Image::HEIGHT - ROWS);
+  }
+
+  void redraw() {
+    image.clear();
+    speed.drawAll(image, 0, ROWS - 1);
+    altitude.drawAll(image, ROWS, Image::HEIGHT - ROWS);
+    stats.fullRedraws++;
+  }
+};
@@ -2,6 +2,7 @@
 
 #include "../Config.h"
 #include "../hardware/Button.h"
+#include "../hardware/Trace.h"
 
 class Input {
 public:
@@ -28,6 +29,14 @@ public:
   }
 
   ID update() {
+    TraceScope trace(TraceEvent::INPUT_UPDATE);
+    const ID   event = detect();
+    if (event != ID::NONE) Trace::mark(TraceEvent::INPUT_EVENT, static_cast<uint16_t>(event));
+    return event;
+  }
+
+private:
+  ID detect() {
     const bool          selectPressed = btnSelect.isPressed();
     const bool          pausePressed  = btnPause.isPressed();
     const unsigned long now           = millis();
@@ -0,0 +1,284 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "../Config.h"
+#include "../domain/Clock.h"
+#include "../domain/Trip.h"
+#include "Formatter.h"
+
+// 利用者が定義した画面。読み込むときに一度だけ解釈し、項目ごとに値を作る関数と描く位置を
+// 決めておく。描画ではこの表を順にたどるだけにする
+//
+// 1 行に 1 項目で「項目 文字の大きさ 位置」を書く。"page" の行で次の画面に移る。
+// 位置は TL T TR / L C R / BL B BR (上・中・下 × 左・中央・右)
+//   page
+//   SPEED 3 C
+//   TIME 2 B
+class Layout {
+public:
+  static constexpr int CHAR_WIDTH  = 6; // 大きさ 1 の文字の幅と高さ
+  static constexpr int CHAR_HEIGHT = 8;
+  static constexpr int UNIT_GAP    = 4; // 値と単位の間
+
+  enum class Align : uint8_t { LEFT, CENTER, RIGHT };
+
+  typedef void (*Format)(const Trip &trip, const Clock &clock, char *buffer, size_t size);
+
+  struct Item {
+    Format      format   = nullptr;
+    const char *unit     = ""; // 大きさ 1 で値の後ろに下揃えで描く
+    int16_t     x        = 0;  // align の基準
+    int16_t     y        = 0;  // 値の上端
+    int16_t     unitY    = 0;
+    int16_t     unitW    = 0; // 単位と間隔を合わせた幅
+    uint8_t     textSize = 1;
+    Align       align    = Align::LEFT;
+
+    // 等幅の文字なので、値の幅は文字数だけで決まる
+    int16_t getValueWidth(const char *value) const {
+      return static_cast<int16_t>(strlen(value) * CHAR_WIDTH * textSize);
+    }
+
+    // 値の左端。単位まで含めて align に揃える
+    int16_t getLeft(int16_t valueWidth) const {
+      switch (align) {
+      case Align::CENTER:
+        return x - (valueWidth + unitW) / 2;
+      case Align::RIGHT:
+        return x - (valueWidth + unitW);
+      case Align::LEFT:
+      default:
+        return x;
+      }
+    }
+  };
+
+private:
+  static constexpr size_t MAX_PAGES = Config::Layout::MAX_PAGES;
+  static constexpr size_t MAX_ITEMS = Config::Layout::MAX_ITEMS;
+
+  struct Field {
+    const char *name;
+    Format      format;
+    const char *unit;
+  };
+
+  Item    items[MAX_ITEMS];
+  uint8_t pageStart[MAX_PAGES + 1];
+  uint8_t  pageCount = 0;
+  uint8_t  itemCount = 0;
+  uint32_t revision  = 0;
+
+public:
+  // Source は MemorySource や FlashFileSource。読めない、または解釈できなければ画面なしになる
+  template <typename Source> bool load(Source &source) {
+    char         text[Config::Layout::MAX_BYTES];
+    const size_t size = source.getSize();
+    clear();
+    if (sizeof(text) < size || !source.read(0, text, size)) return false;
+    return compile(text, size);
+  }
+
+  bool compile(const char *text, size_t length) {
+    clear();
+    size_t start = 0;
+    while (start < length) {
+      size_t end = start;
+      while (end < length && text[end] != '\n') end++;
+      if (!compileLine(text + start, end - start)) {
+        clear();
+        return false;
+      }
+      start = end + 1;
+    }
+    if (0 < pageCount && pageStart[pageCount - 1] == itemCount) pageCount--; // 空の画面
+    pageStart[pageCount] = itemCount;
+    return 0 < pageCount;
+  }
+
+  void clear() {
+    pageCount    = 0;
+    itemCount    = 0;
+    pageStart[0] = 0;
+    revision++;
+  }
+
+  uint8_t getPageCount() const {
+    return pageCount;
+  }
+
+  // 読み直すたびに増える。項目の位置だけが変わっても描き直せるように Frame が比べる
+  uint32_t getRevision() const {
+    return revision;
+  }
+
+  const Item *getPage(uint8_t page, uint8_t &count) const {
+    if (pageCount <= page) {
+      count = 0;
+      return nullptr;
+    }
+    count = pageStart[page + 1] - pageStart[page];
+    return items + pageStart[page];
+  }
+
+private:
+  bool compileLine(const char *line, size_t length) {
+    char   tokens[3][16];
+    size_t n = 0;
+    for (size_t i = 0; i < length;) {
+      while (i < length && isBlank(line[i])) i++;
+      if (i == length || line[i] == '#') break;
+      if (n == 3) return false;
+      size_t k = 0;
+      while (i < length && !isBlank(line[i])) {
+        if (k + 1 == sizeof(tokens[n])) return false;
+        tokens[n][k++] = line[i++];
+      }
+      tokens[n++][k] = '\0';
+    }
+
+    if (n == 0) return true;
+    if (n == 1 && strcmp(tokens[0], "page") == 0) return beginPage();
+    if (n != 3) return false;
+
+    const Field *field = findField(tokens[0]);
+    const int    size  = tokens[1][1] == '\0' ? tokens[1][0] - '0' : 0;
+    if (!field || size < 1 || Config::Layout::MAX_TEXT_SIZE < size) return false;
+    int column = 0;
+    int row    = 0;
+    if (!parseAnchor(tokens[2], column, row)) return false;
+
+    if (pageCount == 0 && !beginPage()) return false;
+    const uint8_t pageItems = itemCount - pageStart[pageCount - 1];
+    if (MAX_ITEMS <= itemCount || Config::Layout::MAX_PAGE_ITEMS <= pageItems) return false;
+    items[itemCount++] = resolve(*field, static_cast<uint8_t>(size), column, row);
+    return true;
+  }
+
+  bool beginPage() {
+    if (0 < pageCount && pageStart[pageCount - 1] == itemCount) return true; // 空の画面は詰める
+    if (MAX_PAGES <= pageCount) return false;
+    pageStart[pageCount++] = itemCount;
+    return true;
+  }
+
+  // 描画領域 (ヘッダーの下) の中で、位置と大きさから座標を決める
+  static Item resolve(const Field &field, uint8_t size, int column, int row) {
+    const int top    = Config::Renderer::HEADER_HEIGHT;
+    const int height = Config::OLED::HEIGHT - top;
+    const int width  = Config::OLED::WIDTH;
+    const int textH  = CHAR_HEIGHT * size;
+    const int unitW  = field.unit[0] == '\0' ? 0 : UNIT_GAP + strlen(field.unit) * CHAR_WIDTH;
+
+    Item item;
+    item.format   = field.format;
+    item.unit     = field.unit;
+    item.textSize = size;
+    item.align    = static_cast<Align>(column);
+    item.x        = static_cast<int16_t>(width * column / 2);
+    item.y        = static_cast<int16_t>(top + (height - textH) * row / 2);
+    item.unitY    = static_cast<int16_t>(item.y + textH - CHAR_HEIGHT);
+    item.unitW    = static_cast<int16_t>(unitW);
+    return item;
+  }
+
+  static bool parseAnchor(const char *name, int &column, int &row) {
+    static const char *const ANCHORS[] = {"TL", "T", "TR", "L", "C", "R", "BL", "B", "BR"};
+    for (int i = 0; i < 9; i++) {
+      if (strcmp(name, ANCHORS[i]) != 0) continue;
+      column = i % 3;
+      row    = i / 3;
+      return true;
+    }
+    return false;
+  }
+
+  static const Field *findField(const char *name) {
+    static const Field FIELDS[] = {
+        {"SPEED", formatSpeed, "km/h"},
+        {"AVG", formatAvg, "km/h"},
+        {"MAX", formatMax, "km/h"},
+        {"AVG10S", formatAvg10s, "km/h"},
+        {"LAP", formatLapAvg, "km/h"},
+        {"DIST", formatDistance, "km"},
+        {"TRIP_A", formatTripA, "km"},
+        {"TRIP_B", formatTripB, "km"},
+        {"TOTAL", formatTotal, "km"},
+        {"TIME", formatElapsed, ""},
+        {"MOVING", formatMoving, ""},
+        {"CLOCK", formatClock, ""},
+        {"GRADE", formatGrade, "%"},
+        {"ASCENT", formatAscent, "m"},
+    };
+    for (const Field &field : FIELDS) {
+      if (strcmp(name, field.name) == 0) return &field;
+    }
+    return nullptr;
+  }
+
+  static bool isBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+  }
+
+  static void formatSpeed(const Trip &trip, const Clock &, char *buffer, size_t size) {
+    Formatter::formatSpeed(trip.speedEstimator.get(), buffer, size);
+  }
+
+  static void formatAvg(const Trip &trip, const Clock &, char *buffer, size_t size) {
+    Formatter::formatSpeed(trip.speedometer.getAvg(), buffer, size);
+  }
+
+  static void formatMax(const Trip &trip, const Clock &, char *buffer, size_t size) {
+    Formatter::formatSpeed(trip.speedometer.getMax(), buffer, size);
+  }
+
+  static void formatAvg10s(const Trip &trip, const Clock &, char *buffer, size_t size) {
+    Formatter::formatSpeed(trip.speedometer.getAvg10s(), buffer, size);
+  }
+
+  static void formatLapAvg(const Trip &trip, const Clock &, char *buffer, size_t size) {
+    Formatter::formatSpeed(trip.getCurrentLap().getAvgKmh(), buffer, size);
+  }
+
+  static void formatDistance(const Trip &trip, const Clock &, char *buffer, size_t size) {
+    Formatter::formatDistance(trip.odometer.getTotalDistance(), buffer, size);
+  }
+
+  static void formatTripA(const Trip &trip, const Clock &, char *buffer, size_t size) {
+    Formatter::formatDistance(trip.getCounter(Trip::Counter::TRIP_A).getDistanceKm(), buffer,
+                              size);
+  }
+
+  static void formatTripB(const Trip &trip, const Clock &, char *buffer, size_t size) {
+    Formatter::formatDistance(trip.getCounter(Trip::Counter::TRIP_B).getDistanceKm(), buffer,
+                              size);
+  }
+
+  static void formatTotal(const Trip &trip, const Clock &, char *buffer, size_t size) {
+    Formatter::formatLongDistance(trip.getCounter(Trip::Counter::LIFETIME).getDistanceKm(),
+                                  buffer, size);
+  }
+
+  static void formatElapsed(const Trip &trip, const Clock &, char *buffer, size_t size) {
+    Formatter::formatDuration(trip.stopwatch.getElapsedTimeMs(), buffer, size);
+  }
+
+  static void formatMoving(const Trip &trip, const Clock &, char *buffer, size_t size) {
+    Formatter::formatDuration(trip.stopwatch.getMovingTimeMs(), buffer, size);
+  }
+
+  static void formatClock(const Trip &, const Clock &clock, char *buffer, size_t size) {
+    Formatter::formatTime(clock.getTime(), buffer, size);
+  }
+
+  static void formatGrade(const Trip &trip, const Clock &, char *buffer, size_t size) {
+    Formatter::formatGradient(trip.gradient.getGradientPercent(), buffer, size);
+  }
+
+  static void formatAscent(const Trip &trip, const Clock &, char *buffer, size_t size) {
+    Formatter::formatMeters(trip.gradient.getAscentM(), buffer, size);
+  }
+};
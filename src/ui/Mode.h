@@ -2,7 +2,23 @@
 
 class Mode {
 public:
-  enum class ID { SPD_TIME, AVG_ODO, MAX_CLOCK, Count };
+  enum class ID {
+    SPD_TIME,
+    AVG_ODO,
+    MAX_CLOCK,
+    TRIP_A,
+    TRIP_B,
+    LIFETIME,
+    HISTORY,
+    ROLLING_AVG,
+    LAP,
+    ROUTE,
+    CLIMB,
+    MAP,
+    GRAPH,
+    PAGE, // 利用者が定義した画面
+    Count
+  };
 
 private:
   ID currentID = ID::SPD_TIME;
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <cstring>
+
+#include "../hardware/OLED.h"
+#include "../hardware/Trace.h"
+#include "DisplayBackend.h"
+
+// SSD1306 に文字と画像で描く
+class OledBackend : public DisplayBackend<OledBackend> {
+  friend class DisplayBackend<OledBackend>;
+
+private:
+  OLED oled;
+
+  bool beginDisplay() {
+    return oled.begin();
+  }
+
+  void drawFrame(const Frame &frame) {
+    oled.clear();
+    drawHeader(frame);
+    drawMainArea(frame);
+    TraceScope display(TraceEvent::RENDER_DISPLAY);
+    oled.display();
+  }
+
+  void drawHeader(const Frame &frame) {
+    oled.setTextSize(Config::Renderer::HEADER_TEXT_SIZE);
+    oled.setTextColor(WHITE);
+
+    drawTextLeft(0, frame.header.fixStatus);
+    drawTextCenter(0, frame.header.modeSpeed);
+    drawTextRight(0, frame.header.modeTime);
+
+    int16_t lineY = Config::Renderer::HEADER_HEIGHT - 2;
+    oled.drawLine(0, lineY, oled.getWidth(), lineY, WHITE);
+  }
+
+  void drawMainArea(const Frame &frame) {
+    const int16_t headerH = Config::Renderer::HEADER_HEIGHT;
+    const int16_t screenH = oled.getHeight();
+
+    if (frame.graphic.image) {
+      drawGraphic(frame.graphic);
+      return;
+    }
+    if (frame.page.items) {
+      drawPage(frame.page);
+      return;
+    }
+
+    drawItem(frame.main, headerH + 14, 3, 1, false);
+    drawItem(frame.sub, screenH, 2, 1, true);
+  }
+
+  // 地図やグラフはキャッシュ済みの画像を転送するだけにし、印だけを重ねる
+  void drawGraphic(const Frame::Graphic &graphic) {
+    const int16_t headerH = Config::Renderer::HEADER_HEIGHT;
+    oled.drawBitmap(0, headerH, graphic.image->data(), MainAreaBitmap::WIDTH,
+                    MainAreaBitmap::HEIGHT, WHITE);
+    if (0 <= graphic.markerX) {
+      oled.drawRect(graphic.markerX - 1, headerH + graphic.markerY - 1, 3, 3, WHITE);
+    }
+  }
+
+  // 座標は Layout で決めてあるので、文字の大きさを変えて書くだけ
+  void drawPage(const Frame::Page &page) {
+    for (uint8_t i = 0; i < page.count; i++) {
+      const Layout::Item &item  = page.items[i];
+      const char         *value = page.values[i];
+      const int16_t       width = item.getValueWidth(value);
+      const int16_t       left  = item.getLeft(width);
+      oled.setTextSize(item.textSize);
+      oled.setCursor(left, item.y);
+      oled.print(value);
+      if (item.unitW == 0) continue;
+      oled.setTextSize(1);
+      oled.setCursor(left + width + Layout::UNIT_GAP, item.unitY);
+      oled.print(item.unit);
+    }
+  }
+
+  void drawItem(const Frame::Item &item, int16_t y, uint8_t valSize, uint8_t unitSize,
+                bool alignBottom) {
+    const int16_t spacing = 4;
+
+    oled.setTextSize(valSize);
+    OLED::Rect valRect = oled.getTextBounds(item.value);
+    oled.setTextSize(unitSize);
+    OLED::Rect unitRect = oled.getTextBounds(item.unit);
+
+    int16_t totalW = valRect.w;
+    if (0 < strlen(item.unit)) totalW += spacing + unitRect.w;
+
+    int16_t startX = (oled.getWidth() - totalW) / 2;
+
+    int16_t valY;
+    int16_t unitY;
+
+    if (alignBottom) {
+      valY  = y - valRect.h;
+      unitY = y - unitRect.h;
+    } else {
+      valY  = y - valRect.h / 2;
+      unitY = (y + valRect.h / 2) - unitRect.h;
+    }
+
+    oled.setTextSize(valSize);
+    oled.setCursor(startX, valY);
+    oled.print(item.value);
+
+    if (0 < strlen(item.unit)) {
+      oled.setTextSize(unitSize);
+      oled.setCursor(startX + valRect.w + spacing, unitY);
+      oled.print(item.unit);
+    }
+  }
+
+  void drawTextLeft(int16_t y, const char *text) {
+    oled.setCursor(0, y);
+    oled.print(text);
+  }
+
+  void drawTextCenter(int16_t y, const char *text) {
+    OLED::Rect rect = oled.getTextBounds(text);
+    oled.setCursor((oled.getWidth() - rect.w) / 2, y);
+    oled.print(text);
+  }
+
+  void drawTextRight(int16_t y, const char *text) {
+    OLED::Rect rect = oled.getTextBounds(text);
+    oled.setCursor(oled.getWidth() - rect.w, y);
+    oled.print(text);
+  }
+};
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "../hardware/SevenSeg.h"
+#include "DisplayBackend.h"
+
+// 4 桁の 7 セグメント表示器に Frame の main の値だけを出す
+class SevenSegBackend : public DisplayBackend<SevenSegBackend> {
+  friend class DisplayBackend<SevenSegBackend>;
+
+private:
+  SevenSeg sevenSeg;
+
+public:
+  static constexpr uint8_t DOT = 0x80;
+
+  // 4 桁に右詰めする。'.' は直前の桁の小数点、':' は 2 桁目と 3 桁目の間のコロンにする
+  // 収まらなければ小数部、次に最後の ':' 以降 (秒) を落とし、それでも収まらなければ "----"
+  static SevenSeg::Segments encode(const char *text) {
+    uint8_t glyphs[16];
+    int     colonAt[4]; // その ':' より前にある桁の数
+    int     count  = 0;
+    int     colons = 0;
+    int     dotAt  = -1; // 小数点の付いた桁
+    for (const char *p = text; *p && count < 16; p++) {
+      if (*p == '.') {
+        if (count == 0) glyphs[count++] = 0;
+        glyphs[count - 1] |= DOT;
+        if (dotAt < 0) dotAt = count - 1;
+      } else if (*p == ':') {
+        if (colons < 4) colonAt[colons++] = count;
+      } else if (*p != ' ' || 0 < count) {
+        glyphs[count++] = glyphOf(*p);
+      }
+    }
+
+    while (SevenSeg::DIGITS < count && 0 < colons) count = colonAt[--colons];
+    if (SevenSeg::DIGITS < count) {
+      if (dotAt < 0 || SevenSeg::DIGITS <= dotAt) return overflow();
+      count = SevenSeg::DIGITS;
+    }
+
+    SevenSeg::Segments segments;
+    const int          offset = SevenSeg::DIGITS - count;
+    for (int i = 0; i < count; i++) segments.digits[offset + i] = glyphs[i];
+    for (int i = 0; i < colons; i++) {
+      if (offset + colonAt[i] == SevenSeg::DIGITS / 2) segments.colon = true;
+    }
+    return segments;
+  }
+
+  static uint8_t glyphOf(char c) {
+    static const uint8_t DIGIT_GLYPHS[] = {0x3F, 0x06, 0x5B, 0x4F, 0x66,
+                                           0x6D, 0x7D, 0x07, 0x7F, 0x6F};
+    if ('0' <= c && c <= '9') return DIGIT_GLYPHS[c - '0'];
+    switch (c) {
+    case '-':
+      return 0x40;
+    case '_':
+      return 0x08;
+    case 'A':
+    case 'a':
+      return 0x77;
+    case 'B':
+    case 'b':
+      return 0x7C;
+    case 'C':
+    case 'c':
+      return 0x39;
+    case 'D':
+    case 'd':
+      return 0x5E;
+    case 'E':
+    case 'e':
+      return 0x79;
+    case 'F':
+    case 'f':
+      return 0x71;
+    case 'G':
+    case 'g':
+      return 0x3D;
+    case 'H':
+    case 'h':
+      return 0x76;
+    case 'L':
+    case 'l':
+      return 0x38;
+    case 'N':
+    case 'n':
+      return 0x54;
+    case 'O':
+    case 'o':
+      return 0x5C;
+    case 'P':
+    case 'p':
+      return 0x73;
+    case 'R':
+    case 'r':
+      return 0x50;
+    case 'T':
+    case 't':
+      return 0x78;
+    case 'U':
+    case 'u':
+      return 0x3E;
+    default:
+      return 0; // 表せない文字は消灯
+    }
+  }
+
+private:
+  static SevenSeg::Segments overflow() {
+    SevenSeg::Segments segments;
+    for (int i = 0; i < SevenSeg::DIGITS; i++) segments.digits[i] = glyphOf('-');
+    return segments;
+  }
+
+  bool beginDisplay() {
+    sevenSeg.begin();
+    return true;
+  }
+
+  void drawFrame(const Frame &frame) {
+    sevenSeg.show(encode(frame.main.value));
+  }
+};
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <stdint.h>
+
+// 1 列ぶんの最小値・最大値を COLUMNS 列のリングバッファに持つ折れ線グラフの系列
+// 表示範囲は step 単位で決め、範囲が変わったときだけ全体の描き直しを求める
+template <int COLUMNS> class Sparkline {
+private:
+  struct Column {
+    int16_t min;
+    int16_t max; // min > max なら値なし
+  };
+
+  Column        columns[COLUMNS];
+  int           head = 0; // 最新の列
+  Column        pending;
+  const int16_t step;
+  int16_t       low;
+  int16_t       high;
+
+public:
+  explicit Sparkline(int16_t step) : step(step), low(0), high(step) {
+    clear();
+  }
+
+  void clear() {
+    for (int i = 0; i < COLUMNS; i++) columns[i] = empty();
+    pending = empty();
+    low     = 0;
+    high    = step;
+  }
+
+  void add(int16_t value) {
+    if (value < pending.min) pending.min = value;
+    if (pending.max < value) pending.max = value;
+  }
+
+  // 書き込み中の列を確定して次の列へ進む。表示範囲が変わったら true
+  bool commit() {
+    head          = (head + 1) % COLUMNS;
+    columns[head] = pending;
+    pending       = empty();
+    return updateRange();
+  }
+
+  int16_t getLow() const {
+    return low;
+  }
+
+  int16_t getHigh() const {
+    return high;
+  }
+
+  // age 列前 (0 が最新) の列を x に描く
+  template <typename Image>
+  void drawColumn(Image &image, int x, int age, int top, int height) const {
+    const Column &column = columns[(head - age + COLUMNS) % COLUMNS];
+    if (column.max < column.min) return;
+    image.drawLine(x, toY(column.min, top, height), x, toY(column.max, top, height));
+  }
+
+  template <typename Image> void drawAll(Image &image, int top, int height) const {
+    for (int age = 0; age < COLUMNS && age < Image::WIDTH; age++) {
+      drawColumn(image, Image::WIDTH - 1 - age, age, top, height);
+    }
+  }
+
+private:
+  static Column empty() {
+    Column column;
+    column.min = INT16_MAX;
+    column.max = INT16_MIN;
+    return column;
+  }
+
+  int toY(int16_t value, int top, int height) const {
+    const int32_t offset = static_cast<int32_t>(value - low) * (height - 1) / (high - low);
+    return top + height - 1 - offset;
+  }
+
+  int16_t floorStep(int16_t value) const {
+    const int16_t q = value / step;
+    return (value < 0 && q * step != value ? q - 1 : q) * step;
+  }
+
+  bool updateRange() {
+    int16_t min = INT16_MAX;
+    int16_t max = INT16_MIN;
+    for (int i = 0; i < COLUMNS; i++) {
+      if (columns[i].max < columns[i].min) continue;
+      if (columns[i].min < min) min = columns[i].min;
+      if (max < columns[i].max) max = columns[i].max;
+    }
+    if (max < min) return false;
+
+    const int16_t newLow  = floorStep(min);
+    const int16_t newHigh = floorStep(max) + step;
+    if (newLow == low && newHigh == high) return false;
+    low  = newLow;
+    high = newHigh;
+    return true;
+  }
+};
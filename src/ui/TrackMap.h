@@ -0,0 +1,148 @@
+#pragma once
+
+#include <math.h>
+#include <stdint.h>
+
+#include "../Config.h"
+#include "../domain/Breadcrumb.h"
+#include "Bitmap.h"
+
+// 走行軌跡をヘッダ下の領域に描く地図。画像はキャッシュし、新しく増えた区間だけを描き足す
+// 全体を描き直すのは、表示範囲の移動・縮尺の変更・軌跡の間引きがあったときだけ
+class TrackMap {
+public:
+  typedef MainAreaBitmap Image;
+
+  struct Stats {
+    uint32_t updates     = 0;
+    uint32_t fullRedraws = 0;
+    uint32_t segments    = 0;
+    uint32_t pixels      = 0;
+  };
+
+  static constexpr size_t ZOOM_LEVELS =
+      sizeof(Config::MapView::SCALES_M_PER_PX) / sizeof(Config::MapView::SCALES_M_PER_PX[0]);
+
+private:
+  Image    image;
+  size_t   zoom      = 0;
+  bool     isValid   = false; // false なら次の update で全体を描き直す
+  int32_t  centerLat = 0;     // 1e-7 度
+  int32_t  centerLon = 0;
+  int32_t  pxPerE7X  = 0; // 1e-7 度あたりの画素数 (Q16)
+  int32_t  pxPerE7Y  = 0;
+  size_t   drawn     = 0; // 描画済みの点数
+  uint32_t rewrites  = 0;
+  uint32_t revision  = 0;
+  Stats    stats;
+
+public:
+  // 画像が変わったら true
+  bool update(const Breadcrumb &crumb) {
+    stats.updates++;
+    const size_t count = crumb.size();
+    if (count == 0) {
+      if (drawn == 0 && isValid) return false;
+      image.clear();
+      drawn   = 0;
+      isValid = true;
+      revision++;
+      return true;
+    }
+
+    const Breadcrumb::Point &head = crumb[count - 1];
+    if (!isValid || crumb.getRewriteCount() != rewrites || count < drawn || !isInside(head)) {
+      redraw(crumb, !isValid || !isInside(head));
+      return true;
+    }
+    if (count == drawn) return false;
+
+    for (size_t i = drawn == 0 ? 1 : drawn; i < count; i++) drawSegment(crumb[i - 1], crumb[i]);
+    drawn = count;
+    revision++;
+    return true;
+  }
+
+  void nextZoom() {
+    zoom    = (zoom + 1) % ZOOM_LEVELS;
+    isValid = false;
+  }
+
+  int getScaleMPerPx() const {
+    return Config::MapView::SCALES_M_PER_PX[zoom];
+  }
+
+  const Image &getImage() const {
+    return image;
+  }
+
+  // 画像を描き換えるたびに増える
+  uint32_t getRevision() const {
+    return revision;
+  }
+
+  const Stats &getStats() const {
+    return stats;
+  }
+
+  // 最新の点の画面座標。描画済みの点がなければ false
+  bool getHead(const Breadcrumb &crumb, int16_t &x, int16_t &y) const {
+    if (crumb.size() == 0 || !isValid) return false;
+    const Breadcrumb::Point &head = crumb[crumb.size() - 1];
+    x                             = static_cast<int16_t>(projectX(head.lonE7));
+    y                             = static_cast<int16_t>(projectY(head.latE7));
+    return Image::contains(x, y);
+  }
+
+private:
+  void redraw(const Breadcrumb &crumb, bool recenter) {
+    if (recenter) setCenter(crumb[crumb.size() - 1]);
+
+    image.clear();
+    stats.fullRedraws++;
+    for (size_t i = 1; i < crumb.size(); i++) drawSegment(crumb[i - 1], crumb[i]);
+    if (crumb.size() == 1) drawSegment(crumb[0], crumb[0]);
+
+    drawn    = crumb.size();
+    rewrites = crumb.getRewriteCount();
+    isValid  = true;
+    revision++;
+  }
+
+  // 三角関数と浮動小数点演算は中心を決め直すときだけ使う
+  void setCenter(const Breadcrumb::Point &point) {
+    const double mPerE7 = Config::Odometer::EARTH_RADIUS_M * PI / 180.0 / 1e7;
+    const double scale  = 65536.0 * mPerE7 / getScaleMPerPx();
+    centerLat           = point.latE7;
+    centerLon           = point.lonE7;
+    pxPerE7Y            = static_cast<int32_t>(lround(scale));
+    pxPerE7X            = static_cast<int32_t>(lround(scale * cos(point.latE7 / 1e7 * PI / 180.0)));
+  }
+
+  int32_t projectX(int32_t lonE7) const {
+    return Image::WIDTH / 2 + toPixels(static_cast<int64_t>(lonE7) - centerLon, pxPerE7X);
+  }
+
+  int32_t projectY(int32_t latE7) const {
+    return Image::HEIGHT / 2 - toPixels(static_cast<int64_t>(latE7) - centerLat, pxPerE7Y);
+  }
+
+  // 画面から遠く離れた点でも int32_t に収まるように丸める
+  static int32_t toPixels(int64_t deltaE7, int32_t pxPerE7) {
+    const int64_t px = (deltaE7 * pxPerE7) >> 16;
+    return static_cast<int32_t>(px < -32768 ? -32768 : (32767 < px ? 32767 : px));
+  }
+
+  bool isInside(const Breadcrumb::Point &point) const {
+    const int32_t x = projectX(point.lonE7);
+    const int32_t y = projectY(point.latE7);
+    const int32_t m = Config::MapView::MARGIN_PX;
+    return m <= x && x < Image::WIDTH - m && m <= y && y < Image::HEIGHT - m;
+  }
+
+  void drawSegment(const Breadcrumb::Point &a, const Breadcrumb::Point &b) {
+    stats.segments++;
+    stats.pixels += image.drawLine(projectX(a.lonE7), projectY(a.latE7), projectX(b.lonE7),
+                                   projectY(b.latE7));
+  }
+};
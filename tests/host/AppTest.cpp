@@ -0,0 +1,134 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <string>
+
+#include "App.h"
+#include "hardware/RecordStore.h"
+
+namespace {
+
+struct BootTimes {
+  long frameMs = -1;
+  long fixMs   = -1;
+  long readyMs = -1;
+};
+
+// 'b' を送って起動の所要時間を読む
+BootTimes readBootTimes(App &app) {
+  Serial.mockInput = "b";
+  testing::internal::CaptureStdout();
+  app.update();
+  const std::string output = testing::internal::GetCapturedStdout();
+
+  BootTimes         times;
+  const size_t      at = output.find("BOOT frame");
+  EXPECT_NE(at, std::string::npos) << output;
+  if (at != std::string::npos) {
+    sscanf(output.c_str() + at, "BOOT frame %ld fix %ld ready %ld", &times.frameMs, &times.fixMs,
+           &times.readyMs);
+  }
+  return times;
+}
+
+// 起動にかかる時間を与えて起動し、測位するまで 10 ms ごとに update() を回す
+BootTimes boot(unsigned long panelMs, unsigned long gnssMs, unsigned long openMs,
+               unsigned long ttffMs) {
+  FlashClass::mockReset();
+  Adafruit_SSD1306::mockBeginMs = panelMs;
+  SpGnss::mockBeginMs           = gnssMs;
+  SpGnss::mockTtffMs            = ttffMs;
+  FlashClass::mockOpenMs        = openMs;
+
+  App app;
+  app.begin();
+  for (int i = 0; i < 2000; i++) {
+    _mock_millis += 10;
+    app.update();
+  }
+  const BootTimes times = readBootTimes(app);
+
+  Adafruit_SSD1306::mockBeginMs = 0;
+  SpGnss::mockBeginMs           = 0;
+  SpGnss::mockTtffMs            = 0;
+  FlashClass::mockReset();
+  return times;
+}
+
+void run(App &app, unsigned long ms) {
+  for (unsigned long t = 0; t < ms; t += 10) {
+    _mock_millis += 10;
+    app.update();
+  }
+}
+
+// ボタンを押して離す。両方を同時に押すと RESET
+void press(App &app, bool select, bool pause) {
+  if (select) setPinState(Config::Pin::BTN_A, LOW);
+  if (pause) setPinState(Config::Pin::BTN_B, LOW);
+  run(app, 200);
+  setPinState(Config::Pin::BTN_A, HIGH);
+  setPinState(Config::Pin::BTN_B, HIGH);
+  run(app, 200);
+}
+
+Trip::Totals loadTotals() {
+  RecordStore  store(Config::Storage::TRIP_PATHS[0], Config::Storage::TRIP_PATHS[1],
+                     Config::Storage::TRIP_VERSION);
+  Trip::Totals totals;
+  EXPECT_TRUE(store.load(totals));
+  return totals;
+}
+
+} // namespace
+
+TEST(AppTest, ShowsFirstFrameBeforeSlowInit) {
+  const unsigned long panelMs = 30;
+  const unsigned long gnssMs  = 400;
+  const unsigned long openMs  = 50;
+  const unsigned long ttffMs  = 3000;
+  const BootTimes     times   = boot(panelMs, gnssMs, openMs, ttffMs);
+
+  // 画面は表示器の準備だけを待って出る。GNSS とファイルの準備はその後に回る
+  ASSERT_LE(0, times.frameMs);
+  EXPECT_LE(times.frameMs, static_cast<long>(panelMs));
+  EXPECT_LT(times.frameMs + static_cast<long>(gnssMs), times.readyMs);
+
+  // ファイルの読み込みは測位を待つ間に済み、最初の測位を遅らせない
+  ASSERT_LE(0, times.fixMs);
+  EXPECT_LT(times.readyMs, times.fixMs);
+  EXPECT_LE(times.fixMs, static_cast<long>(panelMs + gnssMs + ttffMs + 20));
+
+  const BootTimes instant = boot(0, 0, 0, 0);
+  EXPECT_EQ(instant.frameMs, 0);
+  EXPECT_LE(0, instant.fixMs);
+
+  std::cout << "[ BENCH    ] boot: first frame " << times.frameMs << " ms, ready "
+            << times.readyMs << " ms, first fix " << times.fixMs << " ms (sequential: frame "
+            << times.readyMs << " ms)" << std::endl;
+}
+
+TEST(AppTest, SavesCounterResetWhileParked) {
+  FlashClass::mockReset();
+  SpGnss::mockFixMode      = Fix3D;
+  SpGnss::mockVelocityData = 5.5f;
+  App app;
+  app.begin();
+  run(app, 70000); // 走行中の定期保存を 1 回
+
+  SpGnss::mockVelocityData = 0.0f; // 止めてから積算を保存し終える
+  run(app, 70000);
+  const Trip::Totals parked = loadTotals();
+  ASSERT_LT(0u, parked.counters.get(static_cast<size_t>(Trip::Counter::TRIP_A)).movingTimeMs);
+
+  // 止まったまま TRIP_A をリセットし、すぐに電源を切る
+  for (int i = 0; i < static_cast<int>(Mode::ID::TRIP_A); i++) press(app, true, false);
+  press(app, true, true);
+  const Trip::Totals saved = loadTotals();
+  EXPECT_EQ(saved.counters.get(static_cast<size_t>(Trip::Counter::TRIP_A)).movingTimeMs, 0u);
+  EXPECT_EQ(saved.counters.get(static_cast<size_t>(Trip::Counter::TRIP_B)).movingTimeMs,
+            parked.counters.get(static_cast<size_t>(Trip::Counter::TRIP_B)).movingTimeMs);
+
+  SpGnss::mockVelocityData = 5.5f;
+  FlashClass::mockReset();
+}
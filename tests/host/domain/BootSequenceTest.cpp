@@ -0,0 +1,49 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "domain/BootSequence.h"
+
+namespace {
+
+struct Sink {
+  std::string text;
+
+  void print(const char *s) {
+    text += s;
+  }
+};
+
+} // namespace
+
+TEST(BootSequenceTest, RecordsEachStage) {
+  BootSequence boot;
+  boot.begin(1000);
+  EXPECT_EQ(boot.get(), BootSequence::Stage::PANEL);
+
+  unsigned long ms = 0;
+  EXPECT_FALSE(boot.getFirstFrameMs(ms));
+  boot.finish(true, 1500, 1002);
+  boot.markFrame(1002);
+  boot.markFrame(1100); // 最初の 1 回だけ残す
+  boot.finish(true, 30, 1005);
+  boot.finish(false, 200, 1010);
+  EXPECT_EQ(boot.get(), BootSequence::Stage::BUTTONS);
+  EXPECT_TRUE(boot.isOk(BootSequence::Stage::PANEL));
+  EXPECT_TRUE(boot.isOk(BootSequence::Stage::CLOCK));
+  EXPECT_FALSE(boot.isOk(BootSequence::Stage::GNSS));
+  EXPECT_EQ(boot.getStageUs(BootSequence::Stage::GNSS), 200u);
+  EXPECT_TRUE(boot.getFirstFrameMs(ms));
+  EXPECT_EQ(ms, 2u);
+
+  while (!boot.isReady()) boot.finish(true, 10, 1050);
+  EXPECT_EQ(boot.getReadyMs(), 50u);
+  boot.finish(true, 10, 2000); // 起動後は何もしない
+  EXPECT_EQ(boot.getReadyMs(), 50u);
+
+  Sink sink;
+  boot.report(sink);
+  EXPECT_EQ(sink.text.compare(0, 19, "BOOT PANEL 1500 ok\n"), 0);
+  EXPECT_NE(sink.text.find("BOOT GNSS 200 failed\n"), std::string::npos);
+  EXPECT_NE(sink.text.find("BOOT frame 2 fix -1 ready 50\n"), std::string::npos);
+}
@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <vector>
+
+#include "domain/Breadcrumb.h"
+#include "domain/Odometer.h"
+#include "support/RideReplay.h"
+
+namespace {
+
+// 元の各点から、それを含む間引き後の線分までの距離の最大値
+float worstErrorM(const Breadcrumb &crumb, const std::vector<Breadcrumb::Point> &raw) {
+  size_t kept  = 0;
+  float  worst = 0.0f;
+  for (const Breadcrumb::Point &p : raw) {
+    const Breadcrumb::Point &a = crumb[kept];
+    if (p.latE7 == a.latE7 && p.lonE7 == a.lonE7) continue;
+    const Breadcrumb::Point &b = crumb[kept + 1];
+    if (p.latE7 == b.latE7 && p.lonE7 == b.lonE7) {
+      kept++;
+      continue;
+    }
+    worst = std::max(worst, crumb.distanceM(p, a, b));
+  }
+  EXPECT_EQ(kept + 1, crumb.size()) << "kept points must be a subsequence of the input";
+  return worst;
+}
+
+Breadcrumb::Point toPoint(double lat, double lon) {
+  return {static_cast<int32_t>(lround(lat * 1e7)), static_cast<int32_t>(lround(lon * 1e7))};
+}
+
+} // namespace
+
+TEST(BreadcrumbTest, StraightLineCollapsesToEndpoints) {
+  Breadcrumb crumb;
+  for (size_t i = 0; i < Breadcrumb::CAPACITY + 1; i++) crumb.add(35.0 + i * 1e-4, 139.0);
+  EXPECT_EQ(crumb.size(), 3u); // 間引いた 2 点と、その後に追加した 1 点
+  EXPECT_FLOAT_EQ(crumb.getToleranceM(), Config::Breadcrumb::TOLERANCE_M);
+}
+
+TEST(BreadcrumbTest, KeepsCorners) {
+  Breadcrumb crumb;
+  for (int i = 0; i < 600; i++) crumb.add(35.0 + i * 1e-5, 139.0);
+  for (int i = 1; i < 600; i++) crumb.add(35.0 + 599e-5, 139.0 + i * 1e-5);
+  for (int i = 0; i < 100; i++) crumb.add(35.0 + 599e-5 - i * 1e-5, 139.0 + 599e-5);
+
+  const Breadcrumb::Point corner = toPoint(35.0 + 599e-5, 139.0);
+  bool                    found  = false;
+  for (size_t i = 0; i < crumb.size(); i++) {
+    found |= crumb[i].latE7 == corner.latE7 && crumb[i].lonE7 == corner.lonE7;
+  }
+  EXPECT_TRUE(found);
+  EXPECT_EQ(crumb[0].latE7, toPoint(35.0, 139.0).latE7);
+  EXPECT_LT(crumb.size(), 1299u - Breadcrumb::CAPACITY + 4u);
+}
+
+TEST(BreadcrumbTest, ReplayStaysBoundedWithinTolerance) {
+  const unsigned long hours[] = {1, 4, 12};
+  for (unsigned long h : hours) {
+    RideReplay                     ride(RideProfiles::commute, 1.0f, 0.2f);
+    Odometer                       odometer;
+    Breadcrumb                     crumb;
+    std::vector<Breadcrumb::Point> raw;
+
+    ride.run(h * 3600 * 1000, 1000, [&](const SpNavData &nav, unsigned long, bool) {
+      if (!odometer.update(nav.latitude, nav.longitude, 0.0f < nav.velocity)) return;
+      const Breadcrumb::Point p = toPoint(nav.latitude, nav.longitude);
+      if (raw.empty() || p.latE7 != raw.back().latE7 || p.lonE7 != raw.back().lonE7) {
+        raw.push_back(p);
+      }
+      crumb.add(nav.latitude, nav.longitude);
+    });
+
+    const double km    = odometer.getTotalMm() / 1e6;
+    const float  worst = worstErrorM(crumb, raw);
+    std::cout << "[ REPLAY   ] " << h << " h, " << km << " km: " << raw.size() << " fixes -> "
+              << crumb.size() << " points (" << crumb.size() / km << " /km), tolerance "
+              << crumb.getToleranceM() << " m, worst error " << worst << " m" << std::endl;
+
+    EXPECT_LE(crumb.size(), Breadcrumb::CAPACITY);
+    EXPECT_LE(worst, crumb.getToleranceM() * 2.0f);
+  }
+}
+
+TEST(BreadcrumbTest, ResetRestoresTolerance) {
+  Breadcrumb crumb;
+  for (int i = 0; i < 20000; i++) {
+    crumb.add(35.0 + i * 1e-5, 139.0 + 1e-4 * sin(i * 0.3)); // 約 9 m 幅のジグザグ
+  }
+  EXPECT_GT(crumb.getToleranceM(), Config::Breadcrumb::TOLERANCE_M);
+  crumb.reset();
+  EXPECT_EQ(crumb.size(), 0u);
+  EXPECT_FLOAT_EQ(crumb.getToleranceM(), Config::Breadcrumb::TOLERANCE_M);
+}
@@ -0,0 +1,198 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdint>
+
+#include "domain/Clock.h"
+
+namespace {
+
+constexpr uint32_t UNIX_OFFSET = 946684800; // 1970-01-01 から 2000-01-01 までの秒
+
+int64_t msOf(int year, int month, int day, int hour, int minute, int second) {
+  const int32_t days = TimeZone::daysFromCivil(year, month, day) - TimeZone::EPOCH_DAYS;
+  return ((static_cast<int64_t>(days) * 24 + hour) * 3600 + minute * 60 + second) * 1000;
+}
+
+// 2000-01-01 UTC からの ms の時刻を GNSS が出したことにする
+SpNavData navAt(int64_t ms) {
+  const int64_t sec = ms / 1000;
+  SpNavData     nav = {};
+  TimeZone::civilFromDays(static_cast<int32_t>(sec / 86400 + TimeZone::EPOCH_DAYS), nav.time.year,
+                          nav.time.month, nav.time.day);
+  nav.time.hour   = static_cast<int>(sec / 3600 % 24);
+  nav.time.minute = static_cast<int>(sec / 60 % 60);
+  nav.time.sec    = static_cast<int>(sec % 60);
+  nav.time.usec   = static_cast<int>(ms % 1000) * 1000;
+  return nav;
+}
+
+// 前回の電源で合わせた RTC が ms を指している状態にする
+void setRtc(int64_t ms) {
+  RTC.mockReset();
+  RtcTime time(static_cast<uint32_t>(ms / 1000) + UNIX_OFFSET,
+               static_cast<long>(ms % 1000) * 1000000);
+  RTC.setTime(time);
+  RTC.mockSetCount = 0;
+}
+
+int64_t rtcMs() {
+  const RtcTime time = RTC.getTime();
+  return (static_cast<int64_t>(time.unixtime()) - UNIX_OFFSET) * 1000 + time.nsec() / 1000000;
+}
+
+} // namespace
+
+TEST(ClockTest, ShowsRtcTimeAtBoot) {
+  const int64_t start = msOf(2025, 6, 1, 3, 0, 0);
+  setRtc(start);
+
+  SpNavData noFix = {};
+  Clock     gnssOnly;
+  gnssOnly.update(noFix);
+  EXPECT_EQ(gnssOnly.getEpoch(), 0u); // begin() しなければ GNSS の時刻だけを使う
+
+  Clock clock;
+  ASSERT_TRUE(clock.begin());
+  EXPECT_EQ(clock.getEpoch(), static_cast<uint32_t>(start / 1000));
+  EXPECT_EQ(clock.getTime().hour, 12);
+
+  _mock_millis += 61500;
+  clock.update(noFix);
+  EXPECT_EQ(clock.getTime().hour, 12);
+  EXPECT_EQ(clock.getTime().minute, 1);
+  EXPECT_EQ(clock.getTime().second, 1);
+
+  // 電池が切れて RTC が時刻を失っていたら GNSS を待つ
+  RTC.mockReset();
+  Clock lost;
+  EXPECT_FALSE(lost.begin());
+  lost.update(noFix);
+  EXPECT_EQ(lost.getEpoch(), 0u);
+  lost.update(navAt(start));
+  EXPECT_EQ(lost.getEpoch(), static_cast<uint32_t>(start / 1000));
+  EXPECT_EQ(RTC.mockSetCount, 1u);
+  RTC.mockReset();
+}
+
+TEST(ClockTest, GnssCorrectsRtc) {
+  const int64_t truth = msOf(2025, 6, 1, 3, 0, 0);
+  setRtc(truth + 5 * 60 * 1000); // 5 分進んでいる
+
+  Clock clock;
+  ASSERT_TRUE(clock.begin());
+  clock.update(navAt(truth));
+  EXPECT_EQ(clock.getEpoch(), static_cast<uint32_t>(truth / 1000));
+  EXPECT_EQ(RTC.mockSetCount, 1u);
+  EXPECT_EQ(rtcMs(), truth);
+
+  // 小さなずれでは合わせ直さない
+  for (int i = 1; i <= 60; i++) {
+    _mock_millis += 1000;
+    clock.update(navAt(truth + i * 1000 + 200));
+  }
+  EXPECT_EQ(RTC.mockSetCount, 1u);
+
+  // GNSS がなくなっても合わせた時刻から進む
+  SpNavData noFix = {};
+  _mock_millis += 30000;
+  clock.update(noFix);
+  EXPECT_EQ(clock.getEpoch(), static_cast<uint32_t>(truth / 1000) + 90);
+  RTC.mockReset();
+}
+
+TEST(ClockTest, EstimatesRtcDrift) {
+  const float   drifts[] = {40.0f, -25.0f};
+  const int64_t start    = msOf(2025, 6, 1, 3, 0, 0);
+  for (float drift : drifts) {
+    setRtc(start);
+    RTC.mockDriftPpm = drift;
+
+    Clock clock;
+    ASSERT_TRUE(clock.begin());
+    const unsigned long t0 = _mock_millis;
+    // 3 時間は GNSS の時刻があり、その後の 6 時間は屋内で RTC だけになる
+    for (int i = 0; i < 3 * 3600; i++) {
+      _mock_millis += 1000;
+      clock.update(navAt(start + (_mock_millis - t0)));
+    }
+    float ppm = 0.0f;
+    ASSERT_TRUE(clock.getDriftPpm(ppm));
+    EXPECT_NEAR(ppm, drift, 1.0f);
+    EXPECT_LE(RTC.mockSetCount, 4u); // 最初と 1 時間ごと
+
+    // 1 分ごとに秒の半ばで比べる。補正しなければ 6 時間で 0.5 秒以上ずれる
+    SpNavData noFix = {};
+    int       wrong = 0;
+    for (int i = 0; i < 6 * 60; i++) {
+      _mock_millis += 59500;
+      clock.update(noFix);
+      if (clock.getEpoch() != static_cast<uint32_t>((start + (_mock_millis - t0)) / 1000)) wrong++;
+      _mock_millis += 500;
+      clock.update(noFix);
+    }
+    const int64_t truth = start + (_mock_millis - t0);
+    EXPECT_EQ(wrong, 0) << drift;
+    std::cout << "[ BENCH    ] RTC " << drift << " ppm: estimated " << ppm
+              << " ppm, after 6 h without GNSS raw RTC is off by " << rtcMs() - truth << " ms"
+              << std::endl;
+  }
+  RTC.mockReset();
+}
+
+TEST(ClockTest, CachesConversionsAcrossDst) {
+  TzFormat::Zone berlin = TzFormat::Zone();
+  berlin.stdOffsetMin   = 60;
+  berlin.dstSaveMin     = 60;
+  berlin.start          = {3, 5, 0, 0, 120};
+  berlin.end            = {10, 5, 0, 0, 180};
+
+  // 夏時間が始まる 1 分前から RTC だけで 10 Hz で回す
+  setRtc(msOf(2025, 3, 30, 0, 59, 0));
+  Clock clock;
+  ASSERT_TRUE(clock.begin());
+  clock.setZone(berlin);
+  EXPECT_EQ(clock.getTime().hour, 1);
+  EXPECT_EQ(clock.getTime().minute, 59);
+
+  SpNavData noFix = {};
+  int       last  = -1;
+  for (int i = 0; i < 1200; i++) {
+    _mock_millis += 100;
+    clock.update(noFix);
+    const Clock::Time t      = clock.getTime();
+    const int         second = t.hour * 3600 + t.minute * 60 + t.second;
+    if (0 <= last && second != last) {
+      // 01:59:59 の次は 03:00:00
+      EXPECT_EQ(second, last == 2 * 3600 - 1 ? 3 * 3600 : last + 1) << i;
+    }
+    last = second;
+  }
+  EXPECT_EQ(clock.getTime().hour, 3);
+  EXPECT_EQ(clock.getTime().minute, 1);
+
+  // 1 時間分の更新。秒が変わったときだけ時差と時分秒を求め直す場合と、毎回求める場合
+  const TimeZone zone(berlin);
+  const int      updates = 36000;
+  auto           t0      = std::chrono::steady_clock::now();
+  for (int i = 0; i < updates; i++) {
+    _mock_millis += 100;
+    clock.update(noFix);
+  }
+  auto t1  = std::chrono::steady_clock::now();
+  int  sum = 0;
+  for (int i = 0; i < updates; i++) {
+    _mock_millis += 100;
+    const uint32_t epoch = static_cast<uint32_t>(rtcMs() / 1000);
+    const uint32_t local = epoch + zone.getOffsetMin(epoch) * 60;
+    sum += static_cast<int>(local / 3600 % 24 + local / 60 % 60 + local % 60);
+  }
+  auto t2 = std::chrono::steady_clock::now();
+  EXPECT_LT(0, sum);
+  std::cout << "[ BENCH    ] clock update at 10 Hz: cached "
+            << std::chrono::duration<double, std::nano>(t1 - t0).count() / updates
+            << " ns/update, every update "
+            << std::chrono::duration<double, std::nano>(t2 - t1).count() / updates << " ns/update"
+            << std::endl;
+  RTC.mockReset();
+}
@@ -0,0 +1,172 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "domain/DistanceKernel.h"
+#include "domain/Odometer.h"
+#include "support/RideReplay.h"
+
+namespace {
+
+struct Track {
+  std::vector<double>     lat;
+  std::vector<double>     lon;
+  std::vector<SpNavData>  fixes;
+  std::unique_ptr<bool[]> isMoving; // Trip と同じ判定
+};
+
+Track record(RideReplay::Profile profile, unsigned long durationMs, float posNoiseM,
+             float velNoiseKmh) {
+  Track      track;
+  RideReplay replay(profile, posNoiseM, velNoiseKmh);
+  replay.run(durationMs, 1000, [&](const SpNavData &nav, unsigned long, bool) {
+    track.lat.push_back(nav.latitude);
+    track.lon.push_back(nav.longitude);
+    track.fixes.push_back(nav);
+  });
+  track.isMoving.reset(new bool[track.fixes.size()]);
+  for (size_t i = 0; i < track.fixes.size(); i++) {
+    track.isMoving[i] = Config::MIN_MOVING_SPEED_KMH < track.fixes[i].velocity * 3.6f;
+  }
+  return track;
+}
+
+Track tour(unsigned long durationMs) {
+  return record(RideProfiles::rolling, durationMs, 0.5f, 0.0f);
+}
+
+// 1 区間ずつ cosf を呼ぶ従来のスカラー実装
+float scalarStepM(double lat1, double lon1, double lat2, double lon2) {
+  const float latRad = static_cast<float>((lat1 + lat2) / 2.0) * PI / 180.0f;
+  const float dLat   = static_cast<float>(lat2 - lat1) * PI / 180.0f;
+  const float dLon   = static_cast<float>(lon2 - lon1) * PI / 180.0f;
+  const float x      = dLon * cosf(latRad) * 6378137.0f;
+  const float y      = dLat * 6378137.0f;
+  return sqrtf(x * x + y * y);
+}
+
+} // namespace
+
+TEST(DistanceKernelTest, MatchesScalarPerSegment) {
+  const Track        track = tour(3600UL * 1000);
+  const size_t       count = track.lat.size();
+  std::vector<float> steps(count - 1);
+
+  DistanceKernel::integrate(track.lat.data(), track.lon.data(), track.isMoving.get(), count,
+                            steps.data());
+  for (size_t i = 0; i + 1 < count; i++) {
+    const float expected =
+        scalarStepM(track.lat[i], track.lon[i], track.lat[i + 1], track.lon[i + 1]);
+    ASSERT_NEAR(steps[i], expected, 0.01f) << "segment " << i;
+  }
+}
+
+TEST(DistanceKernelTest, SkipsJumpsInSum) {
+  const double       lat[]      = {35.0, 35.0001, 36.0, 36.0001};
+  const double       lon[]      = {139.0, 139.0, 139.0, 139.0};
+  const bool         isMoving[] = {true, true, true, true};
+  std::vector<float> steps(3);
+
+  const double sum = DistanceKernel::integrate(lat, lon, isMoving, 4, steps.data());
+  EXPECT_GT(steps[1], Config::Odometer::MAX_STEP_M);
+  EXPECT_NEAR(sum, steps[0] + steps[2], 2e-3);
+}
+
+TEST(DistanceKernelTest, HoldsShortStepsAndIgnoresStops) {
+  // 0.9 m ずつ 3 回進むと 2.7 m の 1 区間として数え、止まっている間の揺れは数えない
+  const double       lat[]      = {35.0, 35.000008, 35.000016, 35.000024, 35.000037, 35.00003};
+  const double       lon[]      = {139.0, 139.0, 139.0, 139.0, 139.0, 139.0};
+  const bool         isMoving[] = {true, true, true, true, false, false};
+  std::vector<float> steps(5);
+
+  Odometer odometer;
+  for (size_t i = 0; i < 6; i++) odometer.update(lat[i], lon[i], isMoving[i]);
+  const double sum = DistanceKernel::integrate(lat, lon, isMoving, 6, steps.data());
+  EXPECT_NEAR(sum, odometer.getTotalMm() / 1000.0, 2e-3);
+  EXPECT_NEAR(sum, steps[0] + steps[1] + steps[2] + steps[3], 2e-3);
+}
+
+TEST(DistanceKernelTest, MatchesOdometerOnNoisyCommute) {
+  const Track        track = record(RideProfiles::commute, 3600UL * 1000, 1.5f, 1.0f);
+  const size_t       count = track.lat.size();
+  std::vector<float> steps(count - 1);
+
+  Odometer odometer;
+  for (size_t i = 0; i < count; i++) {
+    odometer.update(track.lat[i], track.lon[i], track.isMoving[i]);
+  }
+  const double sum = DistanceKernel::integrate(track.lat.data(), track.lon.data(),
+                                               track.isMoving.get(), count, steps.data());
+  const double odometerM = odometer.getTotalMm() / 1000.0;
+  EXPECT_NEAR(sum, odometerM, odometerM * 1e-3);
+
+  // 規則を当てずに足すと、信号待ちの揺れまで距離になる
+  double unfiltered = 0.0;
+  for (float step : steps) unfiltered += step;
+  EXPECT_GT(unfiltered, odometerM * 1.01);
+  std::cout << "[ REPLAY   ] batch " << sum / 1000.0 << " km, odometer " << odometerM / 1000.0
+            << " km, unfiltered " << unfiltered / 1000.0 << " km" << std::endl;
+}
+
+TEST(DistanceKernelTest, MatchesOdometerWhenBlockStartsBeforeFix) {
+  // 記録の先頭は測位前の (0, 0) が続く
+  const Track         track = tour(120UL * 1000);
+  const size_t        count = track.lat.size() + 5;
+  std::vector<double> lat(5, 0.0);
+  std::vector<double> lon(5, 0.0);
+  lat.insert(lat.end(), track.lat.begin(), track.lat.end());
+  lon.insert(lon.end(), track.lon.begin(), track.lon.end());
+  std::unique_ptr<bool[]> isMoving(new bool[count]);
+  for (size_t i = 0; i < count; i++) isMoving[i] = i < 5 || track.isMoving[i - 5];
+  std::vector<float> steps(count - 1);
+
+  Odometer odometer;
+  for (size_t i = 0; i < count; i++) odometer.update(lat[i], lon[i], isMoving[i]);
+  const double sum =
+      DistanceKernel::integrate(lat.data(), lon.data(), isMoving.get(), count, steps.data());
+  const double odometerM = odometer.getTotalMm() / 1000.0;
+  EXPECT_LT(100.0, odometerM);
+  EXPECT_NEAR(sum, odometerM, odometerM * 1e-3);
+}
+
+TEST(DistanceKernelTest, HandlesShortInput) {
+  const double lat[]      = {35.0};
+  const double lon[]      = {139.0};
+  const bool   isMoving[] = {true};
+  float        step       = -1.0f;
+  EXPECT_EQ(DistanceKernel::integrate(lat, lon, isMoving, 1, &step), 0.0);
+  EXPECT_EQ(step, -1.0f);
+}
+
+TEST(DistanceKernelTest, BenchmarkFixesPerSecond) {
+  const Track        track = tour(10UL * 3600 * 1000);
+  const size_t       count = track.lat.size();
+  const int          loops = 20;
+  std::vector<float> steps(count - 1);
+
+  double batchSum  = 0.0;
+  double scalarSum = 0.0;
+
+  const auto t0 = std::chrono::steady_clock::now();
+  for (int n = 0; n < loops; n++) {
+    batchSum = DistanceKernel::integrate(track.lat.data(), track.lon.data(), track.isMoving.get(),
+                                         count, steps.data());
+  }
+  const auto t1 = std::chrono::steady_clock::now();
+  for (int n = 0; n < loops; n++) {
+    scalarSum = 0.0;
+    for (size_t i = 0; i + 1 < count; i++) {
+      scalarSum += scalarStepM(track.lat[i], track.lon[i], track.lat[i + 1], track.lon[i + 1]);
+    }
+  }
+  const auto t2 = std::chrono::steady_clock::now();
+
+  const double fixes = static_cast<double>(count) * loops;
+  std::cout << "[ BENCH    ] batch " << fixes / std::chrono::duration<double>(t1 - t0).count()
+            << " fixes/s, scalar " << fixes / std::chrono::duration<double>(t2 - t1).count()
+            << " fixes/s" << std::endl;
+  EXPECT_NEAR(batchSum, scalarSum, scalarSum * 1e-4);
+}
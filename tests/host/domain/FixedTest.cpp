@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+#include "domain/Fixed.h"
+#include "domain/Trip.h"
+#include "support/RideReplay.h"
+
+typedef Fixed<16, 16> Q16;
+typedef Fixed<8, 8>   Q8;
+
+static_assert(Q16(1.5f).raw() == 98304, "constexpr conversion");
+static_assert((Q16(2.0f) * Q16(0.25f)).raw() == Q16(0.5f).raw(), "constexpr multiply");
+
+TEST(FixedTest, ConvertsRoundTrip) {
+  EXPECT_FLOAT_EQ(Q16(3.25f).toFloat(), 3.25f);
+  EXPECT_FLOAT_EQ(Q16(-3.25f).toFloat(), -3.25f);
+  EXPECT_NEAR(Q16::fromDouble(139.767125).toDouble(), 139.767125, 1.0 / Q16::ONE);
+}
+
+TEST(FixedTest, Arithmetic) {
+  EXPECT_FLOAT_EQ((Q16(1.5f) + Q16(2.25f)).toFloat(), 3.75f);
+  EXPECT_FLOAT_EQ((Q16(1.5f) - Q16(2.25f)).toFloat(), -0.75f);
+  EXPECT_FLOAT_EQ((Q16(-1.5f) * Q16(2.0f)).toFloat(), -3.0f);
+  EXPECT_FLOAT_EQ((Q16(7.0f) / Q16(2.0f)).toFloat(), 3.5f);
+  EXPECT_TRUE(Q16(1.0f) < Q16(1.5f));
+}
+
+TEST(FixedTest, Saturates) {
+  EXPECT_EQ(Q8(200.0f), Q8::max());
+  EXPECT_EQ(Q8(-200.0f), Q8::min());
+  EXPECT_EQ(Q8(100.0f) + Q8(100.0f), Q8::max());
+  EXPECT_EQ(Q8(-100.0f) - Q8(100.0f), Q8::min());
+  EXPECT_EQ(Q8(20.0f) * Q8(20.0f), Q8::max());
+  EXPECT_EQ(Q8(1.0f) / Q8(), Q8::max());
+  EXPECT_EQ(Q8(-1.0f) / Q8(), Q8::min());
+  EXPECT_EQ(-Q8::min(), Q8::max());
+}
+
+TEST(FixedTest, HypotDoesNotOverflow) {
+  const Q16 d = Numeric<Q16>::hypot(Q16(3000.0f), Q16(4000.0f));
+  EXPECT_NEAR(d.toFloat(), 5000.0f, 1e-3f);
+  EXPECT_EQ(Numeric<Q16>::toMillis(Q16(1.25f)), 1250ULL);
+  EXPECT_EQ(Numeric<Q16>::toMillis(Q16(-1.0f)), 0ULL);
+}
+
+namespace {
+
+struct Report {
+  double km;
+  float  avgKmh;
+  float  maxKmh;
+  double nsPerUpdate;
+};
+
+template <typename Num> Report replay(const std::vector<SpNavData> &fixes) {
+  BasicTrip<Num> trip;
+  trip.begin();
+
+  const auto    t0  = std::chrono::steady_clock::now();
+  unsigned long now = 0;
+  for (const SpNavData &nav : fixes) trip.update(nav, now += 100);
+  const auto t1 = std::chrono::steady_clock::now();
+
+  return {trip.odometer.getTotalMm() / 1e6, trip.speedometer.getAvg(), trip.speedometer.getMax(),
+          std::chrono::duration<double, std::nano>(t1 - t0).count() / fixes.size()};
+}
+
+} // namespace
+
+TEST(FixedTest, BackendAccuracyAndBenchmark) {
+  std::vector<SpNavData> fixes;
+  RideReplay             ride(RideProfiles::commute, 0.5f, 0.2f);
+  ride.setIntervalMs(100);
+  ride.run(4UL * 3600 * 1000, 100, [&](const SpNavData &nav, unsigned long, bool) {
+    fixes.push_back(nav);
+  });
+
+  const Report reference = replay<double>(fixes);
+  const Report results[] = {replay<float>(fixes), replay<Q16>(fixes)};
+  const char  *names[]   = {"float", "Fixed<16,16>"};
+
+  std::cout << "[ BENCH    ] double: " << reference.km << " km, avg " << reference.avgKmh
+            << " km/h, " << reference.nsPerUpdate << " ns/update" << std::endl;
+  for (int i = 0; i < 2; i++) {
+    const Report &r = results[i];
+    std::cout << "[ BENCH    ] " << names[i] << ": distance error " << (r.km - reference.km) * 1000
+              << " m, avg error " << r.avgKmh - reference.avgKmh << " km/h, max error "
+              << r.maxKmh - reference.maxKmh << " km/h, " << r.nsPerUpdate << " ns/update"
+              << std::endl;
+
+    EXPECT_NEAR(r.km, reference.km, reference.km * 1e-3);
+    EXPECT_NEAR(r.avgKmh, reference.avgKmh, 0.05f);
+    EXPECT_NEAR(r.maxKmh, reference.maxKmh, 0.01f);
+  }
+}
@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cmath>
+#include <random>
+
+#include "domain/GradientEstimator.h"
+#include "domain/Trip.h"
+#include "support/RideReplay.h"
+
+TEST(GradientEstimatorTest, ConstantSlope) {
+  GradientEstimator estimator;
+  EXPECT_FLOAT_EQ(estimator.getGradientPercent(), 0.0f);
+
+  for (int i = 1; i <= 500; i++) estimator.update(4000, 0.05f * 4.0f * i); // 4 m ごとに 5 %
+  EXPECT_NEAR(estimator.getGradientPercent(), 5.0f, 0.01f);
+  EXPECT_LT(estimator.getNoiseM(), 0.01f);
+
+  // 獲得標高は窓の中央の高度で数えるので、窓の長さだけ平坦に走ると追いつく
+  for (int i = 1; i <= 50; i++) estimator.update(4000, 100.0f);
+  EXPECT_NEAR(estimator.getAscentM(), 100.0f, Config::Gradient::MIN_HYST_M + 0.2f);
+}
+
+TEST(GradientEstimatorTest, StoppedKeepsGradient) {
+  GradientEstimator estimator;
+  for (int i = 1; i <= 100; i++) estimator.update(5000, -0.03f * 5.0f * i);
+  const float gradient = estimator.getGradientPercent();
+  for (int i = 0; i < 600; i++) estimator.update(0, -15.0f); // 信号待ち
+  EXPECT_FLOAT_EQ(estimator.getGradientPercent(), gradient);
+  EXPECT_NEAR(gradient, -3.0f, 0.01f);
+  EXPECT_FLOAT_EQ(estimator.getAscentM(), 0.0f);
+}
+
+TEST(GradientEstimatorTest, NoisyFlatRoadAddsLittleAscent) {
+  std::mt19937                    rng(7);
+  std::normal_distribution<float> noise(0.0f, 2.0f);
+
+  GradientEstimator estimator;
+  float             naiveM = 0.0f; // 測位ごとの上りをそのまま足した値
+  float             lastM  = 0.0f;
+  for (int i = 0; i < 5000; i++) { // 2 m ごとに 10 km
+    const float altitudeM = 20.0f + noise(rng);
+    estimator.update(2000, altitudeM);
+    if (0 < i && lastM < altitudeM) naiveM += altitudeM - lastM;
+    lastM = altitudeM;
+  }
+  std::cout << "[ REPLAY   ] flat 10 km, noise 2 m: ascent " << estimator.getAscentM()
+            << " m (naive " << naiveM << " m)" << std::endl;
+  EXPECT_LT(estimator.getAscentM(), 20.0f);
+  EXPECT_LT(fabsf(estimator.getGradientPercent()), 2.0f);
+}
+
+TEST(GradientEstimatorTest, SumsSurviveLongRides) {
+  GradientEstimator estimator;
+  // 1 km ごとに ±3 % を繰り返す 500 km。原点の付け替えを何度も通る
+  // 山頂と谷で窓の平均が角を丸めるぶんと、ヒステリシスのぶんだけ少なく数える
+  float altitudeM = 0.0f;
+  for (int i = 0; i < 100000; i++) {
+    const bool isUp = (i / 200) % 2 == 0;
+    altitudeM += isUp ? 0.15f : -0.15f;
+    estimator.update(5000, altitudeM);
+    if (i % 200 == 150) {
+      ASSERT_NEAR(estimator.getGradientPercent(), isUp ? 3.0f : -3.0f, 0.05f);
+    }
+  }
+  EXPECT_NEAR(estimator.getAscentM(), 250 * 30.0f, 250 * 3.0f);
+}
+
+TEST(GradientEstimatorTest, ReplayedHillyRide) {
+  RideReplay ride(RideProfiles::rolling, 0.5f, 0.2f);
+  ride.setElevation(RideProfiles::hills, 1.5f);
+  Trip trip;
+  trip.begin();
+
+  double        trueAscentM = 0.0;
+  double        lastTrueM   = RideProfiles::hills(0.0);
+  double        sumSquared  = 0.0;
+  int           compared    = 0;
+  double        updateNs    = 0.0;
+  unsigned long updates     = 0;
+  ride.run(3600UL * 1000, 100, [&](const SpNavData &nav, unsigned long now, bool) {
+    const auto t0 = std::chrono::steady_clock::now();
+    trip.update(nav, now);
+    updateNs += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0)
+                    .count();
+    updates++;
+
+    const double trueM = ride.getTrueAltitudeM();
+    if (lastTrueM < trueM) trueAscentM += trueM - lastTrueM;
+    lastTrueM = trueM;
+
+    // 回帰の傾きは窓の中央 (WINDOW_M / 2 手前) の勾配に相当する
+    const double centerM = ride.getTrueDistanceKm() * 1000.0 - Config::Gradient::WINDOW_M / 2;
+    if (Config::Gradient::WINDOW_M < centerM && now % 1000 == 0) {
+      const double trueGradient =
+          (RideProfiles::hills(centerM + 1.0) - RideProfiles::hills(centerM - 1.0)) / 2.0 * 100.0;
+      const double error = trip.gradient.getGradientPercent() - trueGradient;
+      sumSquared += error * error;
+      compared++;
+    }
+  });
+
+  const double rms = sqrt(sumSquared / compared);
+  std::cout << "[ REPLAY   ] hills " << ride.getTrueDistanceKm() << " km: ascent "
+            << trip.gradient.getAscentM() << " m (truth " << trueAscentM << " m), gradient rms "
+            << rms << " %, trip update " << updateNs / updates << " ns" << std::endl;
+  EXPECT_NEAR(trip.gradient.getAscentM(), trueAscentM, trueAscentM * 0.1);
+  EXPECT_LT(rms, 1.0);
+}
+
+TEST(GradientEstimatorTest, AscentIsPersisted) {
+  Trip trip;
+  trip.begin();
+  Trip::Totals totals;
+  totals.ascentM = 123.0f;
+  trip.restore(totals);
+  EXPECT_FLOAT_EQ(trip.gradient.getAscentM(), 123.0f);
+  EXPECT_FLOAT_EQ(trip.getTotals().ascentM, 123.0f);
+
+  trip.resetOdometerAndMovingTime();
+  EXPECT_FLOAT_EQ(trip.gradient.getAscentM(), 0.0f);
+}
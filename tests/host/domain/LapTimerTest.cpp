@@ -0,0 +1,151 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+#include "domain/Trip.h"
+#include "support/RideReplay.h"
+
+namespace {
+
+void runRide(Trip &trip, unsigned long durationMs) {
+  RideReplay ride(RideProfiles::commute, 0.5f, 0.2f);
+  ride.run(durationMs, 100, [&](const SpNavData &nav, unsigned long nowMs, bool) {
+    trip.update(nav, nowMs);
+  });
+}
+
+// 半径 radiusM の周回コースを kmh で走る
+void runLoop(Trip &trip, double radiusM, float kmh, unsigned long durationMs) {
+  const double lat0    = 35.0;
+  const double lon0    = 139.0;
+  const double mPerDeg = RideReplay::EARTH_RADIUS_M * M_PI / 180.0;
+
+  SpNavData nav  = {};
+  nav.posFixMode = Fix3D;
+  nav.velocity   = kmh / 3.6f;
+  for (unsigned long t = 0; t <= durationMs; t += 1000) {
+    const double angle = kmh / 3.6 * t / 1000.0 / radiusM;
+    nav.latitude       = lat0 + radiusM * (1.0 - cos(angle)) / mPerDeg;
+    nav.longitude      = lon0 + radiusM * sin(angle) / (mPerDeg * cos(lat0 * M_PI / 180.0));
+    nav.time.sec       = static_cast<int>(t / 1000 % 60);
+    nav.time.minute    = static_cast<int>(t / 60000 % 60);
+    trip.update(nav, t);
+  }
+}
+
+} // namespace
+
+TEST(LapTimerTest, ManualLapsSumToTripTotals) {
+  Trip trip;
+  trip.begin();
+  RideReplay ride(RideProfiles::commute, 0.5f, 0.2f);
+  for (int lap = 0; lap < 5; lap++) {
+    ride.run(7UL * 60 * 1000, 100, [&](const SpNavData &nav, unsigned long nowMs, bool) {
+      trip.update(nav, nowMs);
+    });
+    trip.lap();
+  }
+
+  ASSERT_EQ(trip.laps.getCount(), 5u);
+  uint64_t      mm     = 0;
+  unsigned long moving = 0;
+  for (size_t i = 0; i < trip.laps.getCount(); i++) {
+    const LapTimer::Lap *lap = trip.laps.get(i);
+    ASSERT_NE(lap, nullptr);
+    EXPECT_EQ(lap->trigger, LapTimer::Trigger::MANUAL);
+    EXPECT_GT(lap->getMaxKmh(), lap->getAvgKmh());
+    mm += lap->distanceMm;
+    moving += lap->movingTimeMs;
+  }
+  EXPECT_EQ(mm, trip.odometer.getTotalMm());
+  EXPECT_EQ(moving, trip.stopwatch.getMovingTimeMs());
+  EXPECT_EQ(trip.getCurrentLap().distanceMm, 0u);
+}
+
+TEST(LapTimerTest, AutoLapByDistance) {
+  Trip trip;
+  trip.begin();
+  trip.laps.setAuto(LapTimer::Trigger::DISTANCE, 1000000); // 1 km
+  runRide(trip, 3600UL * 1000);
+
+  const double km = trip.odometer.getTotalMm() / 1e6;
+  EXPECT_EQ(trip.laps.getCount(), static_cast<size_t>(km));
+  for (size_t i = 0; i < trip.laps.getCount(); i++) {
+    EXPECT_GE(trip.laps.get(i)->distanceMm, 1000000u);
+    EXPECT_LT(trip.laps.get(i)->distanceMm, 1000000u + 20000u); // 1 回の更新で進む距離以内
+    EXPECT_EQ(trip.laps.get(i)->trigger, LapTimer::Trigger::DISTANCE);
+  }
+}
+
+TEST(LapTimerTest, DefaultAutoFollowsConfig) {
+  Trip trip;
+  trip.begin();
+  trip.laps.setDefaultAuto();
+  EXPECT_EQ(trip.laps.getAutoTrigger(), LapTimer::Trigger::DISTANCE);
+  runRide(trip, 3600UL * 1000);
+
+  ASSERT_LT(0u, trip.laps.getCount());
+  EXPECT_GE(trip.laps.getLast()->distanceMm, Config::Lap::AUTO_DISTANCE_M * 1000);
+  trip.reset(); // リセットしても自動区切りの設定は残る
+  EXPECT_EQ(trip.laps.getAutoTrigger(), LapTimer::Trigger::DISTANCE);
+}
+
+TEST(LapTimerTest, AutoLapByTime) {
+  Trip trip;
+  trip.begin();
+  trip.laps.setAuto(LapTimer::Trigger::TIME, 5UL * 60 * 1000);
+  runRide(trip, 3600UL * 1000);
+
+  EXPECT_EQ(trip.laps.getCount(), 11u); // 最初の更新は時間を進めない
+  EXPECT_EQ(trip.laps.getLast()->elapsedTimeMs, 5UL * 60 * 1000);
+}
+
+TEST(LapTimerTest, AutoLapByPosition) {
+  Trip trip;
+  trip.begin();
+  trip.laps.setAuto(LapTimer::Trigger::POSITION);
+
+  const double radiusM = 300.0;
+  const float  kmh     = 30.0f;
+  const double periodS = 2.0 * M_PI * radiusM / (kmh / 3.6);
+  runLoop(trip, radiusM, kmh, static_cast<unsigned long>(periodS * 5.5 * 1000));
+
+  ASSERT_EQ(trip.laps.getCount(), 5u);
+  for (size_t i = 1; i < trip.laps.getCount(); i++) {
+    EXPECT_NEAR(trip.laps.get(i)->elapsedTimeMs / 1000.0, periodS, 2.0);
+    EXPECT_NEAR(trip.laps.get(i)->distanceMm / 1000.0, 2.0 * M_PI * radiusM, 15.0);
+  }
+}
+
+TEST(LapTimerTest, ArenaOverwritesOldestLaps) {
+  LapTimer         laps;
+  LapTimer::Totals totals;
+  laps.reset(totals);
+
+  const size_t total = Config::Lap::CAPACITY * 3 + 10;
+  for (size_t i = 0; i < total; i++) {
+    totals.totalMm += 1000 + i;
+    totals.elapsedTimeMs += 1000;
+    laps.mark(totals);
+  }
+
+  EXPECT_EQ(laps.getCount(), total);
+  EXPECT_EQ(laps.getFirstIndex(), total - Config::Lap::CAPACITY);
+  EXPECT_EQ(laps.get(laps.getFirstIndex() - 1), nullptr);
+  EXPECT_EQ(laps.get(total), nullptr);
+  EXPECT_EQ(laps.get(laps.getFirstIndex())->distanceMm, 1000u + laps.getFirstIndex());
+  EXPECT_EQ(laps.getLast()->distanceMm, 1000u + total - 1);
+  EXPECT_LE(sizeof(LapTimer), Config::Lap::CAPACITY * 16 + 128);
+}
+
+TEST(LapTimerTest, TripResetClearsLaps) {
+  Trip trip;
+  trip.begin();
+  runRide(trip, 10UL * 60 * 1000);
+  trip.lap();
+  trip.resetOdometerAndMovingTime();
+
+  EXPECT_EQ(trip.laps.getCount(), 0u);
+  EXPECT_EQ(trip.laps.getLast(), nullptr);
+  EXPECT_EQ(trip.getCurrentLap().distanceMm, 0u);
+}
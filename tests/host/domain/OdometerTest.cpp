@@ -0,0 +1,170 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+#include "domain/Odometer.h"
+#include "support/RideReplay.h"
+
+namespace {
+
+constexpr double LAT = 35.681236;
+constexpr double LON = 139.767125;
+
+double northDeg(double meters) {
+  return meters / RideReplay::EARTH_RADIUS_M * 180.0 / M_PI;
+}
+
+double haversineM(double lat1, double lon1, double lat2, double lon2) {
+  const double p1 = lat1 * M_PI / 180.0;
+  const double p2 = lat2 * M_PI / 180.0;
+  const double dp = p2 - p1;
+  const double dl = (lon2 - lon1) * M_PI / 180.0;
+  const double a  = sin(dp / 2) * sin(dp / 2) + cos(p1) * cos(p2) * sin(dl / 2) * sin(dl / 2);
+  return 2.0 * RideReplay::EARTH_RADIUS_M * asin(sqrt(a));
+}
+
+// 変更前の実装 (float 座標、更新ごとの cosf、float 積算)
+class LegacyOdometer {
+  float totalKm = 0.0f;
+  float lastLat = 0.0f;
+  float lastLon = 0.0f;
+  bool  hasLast = false;
+
+public:
+  void update(float lat, float lon, bool isMoving) {
+    if (!hasLast) {
+      lastLat = lat;
+      lastLon = lon;
+      hasLast = true;
+      return;
+    }
+    if (isMoving) {
+      const float latRad = (lat + lastLat) / 2.0f * PI / 180.0f;
+      const float x      = (lon - lastLon) * PI / 180.0f * cosf(latRad) * 6378137.0f;
+      const float y      = (lat - lastLat) * PI / 180.0f * 6378137.0f;
+      const float d      = sqrtf(x * x + y * y) / 1000.0f;
+      if (0.002f < d && d < 1.0f) totalKm += d;
+    }
+    lastLat = lat;
+    lastLon = lon;
+  }
+
+  float getTotalDistance() const {
+    return totalKm;
+  }
+};
+
+struct Fix {
+  double lat;
+  double lon;
+};
+
+// 1 Hz で数日分のツーリングを生成する
+std::vector<Fix> tour(unsigned long durationMs) {
+  std::vector<Fix> fixes;
+  RideReplay       replay(RideProfiles::rolling);
+  replay.run(durationMs, 1000, [&](const SpNavData &nav, unsigned long, bool) {
+    fixes.push_back({nav.latitude, nav.longitude});
+  });
+  return fixes;
+}
+
+} // namespace
+
+TEST(OdometerTest, IgnoresInvalidCoordinates) {
+  Odometer odometer;
+  odometer.update(0.0, 0.0, true);
+  odometer.update(LAT, LON, true);
+  odometer.update(LAT + northDeg(10.0), LON, true);
+  EXPECT_NEAR(odometer.getTotalMm(), 10000.0, 5.0);
+}
+
+TEST(OdometerTest, AccumulatesSubThresholdSteps) {
+  Odometer odometer;
+  for (int i = 0; i <= 100; i++) odometer.update(LAT + northDeg(0.5 * i), LON, true);
+  EXPECT_NEAR(odometer.getTotalMm(), 50000.0, 10.0);
+}
+
+TEST(OdometerTest, CommitsPendingStepWhenStopping) {
+  Odometer odometer;
+  odometer.update(LAT, LON, true);
+  odometer.update(LAT + northDeg(1.5), LON, true);
+  EXPECT_EQ(odometer.getTotalMm(), 0ULL);
+
+  odometer.update(LAT + northDeg(1.5), LON, false);
+  EXPECT_NEAR(odometer.getTotalMm(), 1500.0, 5.0);
+
+  odometer.update(LAT + northDeg(3.0), LON, false); // 停止中のドリフトは数えない
+  EXPECT_NEAR(odometer.getTotalMm(), 1500.0, 5.0);
+}
+
+TEST(OdometerTest, RejectsJumps) {
+  Odometer odometer;
+  odometer.update(LAT, LON, true);
+  odometer.update(LAT + northDeg(5000.0), LON, true);
+  EXPECT_EQ(odometer.getTotalMm(), 0ULL);
+}
+
+TEST(OdometerTest, Reset) {
+  Odometer odometer;
+  odometer.update(LAT, LON, true);
+  odometer.update(LAT + northDeg(10.0), LON, true);
+  odometer.reset();
+  EXPECT_EQ(odometer.getTotalMm(), 0ULL);
+  EXPECT_FLOAT_EQ(odometer.getTotalDistance(), 0.0f);
+}
+
+TEST(OdometerTest, MultiDayTourAgainstHaversine) {
+  const std::vector<Fix> fixes = tour(40UL * 3600 * 1000);
+
+  double truthM = 0.0;
+  for (size_t i = 1; i < fixes.size(); i++) {
+    truthM += haversineM(fixes[i - 1].lat, fixes[i - 1].lon, fixes[i].lat, fixes[i].lon);
+  }
+
+  Odometer       odometer;
+  LegacyOdometer legacy;
+  for (const Fix &fix : fixes) {
+    odometer.update(fix.lat, fix.lon, true);
+    legacy.update(static_cast<float>(fix.lat), static_cast<float>(fix.lon), true);
+  }
+
+  const double errorM  = odometer.getTotalMm() / 1000.0 - truthM;
+  const double legacyM = legacy.getTotalDistance() * 1000.0 - truthM;
+  std::cout << "[ ACCURACY ] " << fixes.size() << " fixes, " << truthM / 1000.0
+            << " km: odometer " << errorM << " m, legacy " << legacyM << " m" << std::endl;
+
+  EXPECT_LT(fabs(errorM), truthM * 1e-5);
+  EXPECT_LT(fabs(errorM), fabs(legacyM));
+}
+
+TEST(OdometerTest, BenchmarkUpdate) {
+  const std::vector<Fix> fixes = tour(10UL * 3600 * 1000);
+  const int              loops = 20;
+
+  Odometer       odometer;
+  LegacyOdometer legacy;
+
+  const auto t0 = std::chrono::steady_clock::now();
+  for (int n = 0; n < loops; n++) {
+    for (const Fix &fix : fixes) odometer.update(fix.lat, fix.lon, true);
+  }
+  const auto t1 = std::chrono::steady_clock::now();
+  for (int n = 0; n < loops; n++) {
+    for (const Fix &fix : fixes) {
+      legacy.update(static_cast<float>(fix.lat), static_cast<float>(fix.lon), true);
+    }
+  }
+  const auto t2 = std::chrono::steady_clock::now();
+
+  const double count = static_cast<double>(fixes.size()) * loops;
+  std::cout << "[ BENCH    ] odometer "
+            << std::chrono::duration<double, std::nano>(t1 - t0).count() / count
+            << " ns/update, legacy "
+            << std::chrono::duration<double, std::nano>(t2 - t1).count() / count
+            << " ns/update" << std::endl;
+  EXPECT_GT(odometer.getTotalMm(), 0ULL);
+  EXPECT_GT(legacy.getTotalDistance(), 0.0f);
+}
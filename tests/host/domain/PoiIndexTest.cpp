@@ -0,0 +1,219 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "domain/PoiAlert.h"
+#include "domain/PoiIndex.h"
+#include "hardware/FlashFileSource.h"
+#include "poi/PoiIndexBuilder.h"
+
+namespace {
+
+constexpr double BASE_LAT = 35.0;
+constexpr double BASE_LON = 139.0;
+
+std::vector<PoiIndexBuilder::Poi> scatter(size_t count, double spanDeg, unsigned seed) {
+  std::mt19937                           rng(seed);
+  std::uniform_real_distribution<double> offset(0.0, spanDeg);
+
+  std::vector<PoiIndexBuilder::Poi> pois;
+  for (size_t i = 0; i < count; i++) {
+    PoiIndexBuilder::Poi poi;
+    poi.lat  = BASE_LAT + offset(rng);
+    poi.lon  = BASE_LON + offset(rng);
+    poi.kind = static_cast<PoiFormat::Kind>(i % 4);
+    poi.name = "P" + std::to_string(i);
+    pois.push_back(poi);
+  }
+  return pois;
+}
+
+std::vector<uint8_t> build(const std::vector<PoiIndexBuilder::Poi> &pois) {
+  PoiIndexBuilder builder;
+  for (const PoiIndexBuilder::Poi &poi : pois) builder.add(poi);
+  return builder.build();
+}
+
+// 索引を使わずに全件を調べる。距離の式は PoiIndex と同じ
+bool nearestLinear(const std::vector<PoiIndexBuilder::Poi> &pois, double lat, double lon,
+                   float radiusM, std::string &name, float &distanceM) {
+  const double  mPerE7    = Config::Odometer::EARTH_RADIUS_M * PI / 180.0 / 1e7;
+  const float   mPerE7Lat = static_cast<float>(mPerE7);
+  const float   mPerE7Lon = static_cast<float>(mPerE7 * cos(lat * PI / 180.0));
+  const int32_t latE7     = static_cast<int32_t>(lround(lat * 1e7));
+  const int32_t lonE7     = static_cast<int32_t>(lround(lon * 1e7));
+
+  bool found = false;
+  for (const PoiIndexBuilder::Poi &poi : pois) {
+    const float north = (static_cast<int32_t>(lround(poi.lat * 1e7)) - latE7) * mPerE7Lat;
+    const float east  = (static_cast<int32_t>(lround(poi.lon * 1e7)) - lonE7) * mPerE7Lon;
+    const float d     = sqrtf(north * north + east * east);
+    if (radiusM < d || (found && distanceM <= d)) continue;
+    found     = true;
+    name      = poi.name;
+    distanceM = d;
+  }
+  return found;
+}
+
+std::string nameOf(const PoiFormat::Record &record) {
+  return std::string(record.name, strnlen(record.name, PoiFormat::NAME_LEN));
+}
+
+} // namespace
+
+TEST(PoiIndexTest, RejectsBrokenImage) {
+  std::vector<uint8_t> image = build(scatter(10, 0.1, 1));
+  image[0] ^= 0xFF;
+  MemorySource           source(image.data(), image.size());
+  PoiIndex<MemorySource> index(source);
+  EXPECT_FALSE(index.open());
+
+  MemorySource           shortSource(image.data(), 8);
+  PoiIndex<MemorySource> shortIndex(shortSource);
+  EXPECT_FALSE(shortIndex.open());
+}
+
+TEST(PoiIndexTest, MatchesLinearScan) {
+  const std::vector<PoiIndexBuilder::Poi> pois  = scatter(2000, 0.2, 2);
+  const std::vector<uint8_t>              image = build(pois);
+
+  MemorySource           source(image.data(), image.size());
+  PoiIndex<MemorySource> index(source);
+  ASSERT_TRUE(index.open());
+  EXPECT_EQ(index.getCount(), 2000u);
+
+  std::mt19937                           rng(3);
+  std::uniform_real_distribution<double> offset(-0.02, 0.22); // グリッドの外も含める
+  for (int i = 0; i < 2000; i++) {
+    const double lat = BASE_LAT + offset(rng);
+    const double lon = BASE_LON + offset(rng);
+
+    std::string                      expectedName;
+    float                            expectedM = 0.0f;
+    PoiIndex<MemorySource>::Match match;
+    const bool isExpected = nearestLinear(pois, lat, lon, 500.0f, expectedName, expectedM);
+    ASSERT_EQ(index.findNearest(lat, lon, 500.0f, match), isExpected) << "query " << i;
+    if (!isExpected) continue;
+    EXPECT_FLOAT_EQ(match.distanceM, expectedM) << "query " << i;
+    EXPECT_EQ(nameOf(match.record), expectedName) << "query " << i;
+  }
+}
+
+TEST(PoiIndexTest, ReadsFromFlashFile) {
+  const std::vector<uint8_t> image = build(scatter(100, 0.05, 4));
+  FlashClass::mockReset();
+  FlashClass::mockFiles[Config::Poi::PATH] = image;
+
+  FlashFileSource           source;
+  PoiIndex<FlashFileSource> index(source);
+  ASSERT_TRUE(source.begin(Config::Poi::PATH));
+  ASSERT_TRUE(index.open());
+  EXPECT_EQ(index.getCount(), 100u);
+
+  FlashFileSource missing;
+  EXPECT_FALSE(missing.begin("missing.bin"));
+}
+
+TEST(PoiAlertTest, AlertsOnceUntilRearmed) {
+  PoiIndexBuilder::Poi poi;
+  poi.lat  = BASE_LAT;
+  poi.lon  = BASE_LON;
+  poi.kind = PoiFormat::Kind::WATER;
+  poi.name = "Fountain";
+  const std::vector<uint8_t> image = build({poi});
+
+  MemorySource           source(image.data(), image.size());
+  PoiIndex<MemorySource> index(source);
+  ASSERT_TRUE(index.open());
+
+  PoiAlert      alert;
+  unsigned long now    = 0;
+  int           alerts = 0;
+  // 地点を通る南北の道を fromM から toM [m] まで走る
+  auto ride = [&](double fromM, double toM) {
+    const double step = fromM < toM ? 10.0 : -10.0;
+    for (double m = fromM; (step < 0) ? toM <= m : m <= toM; m += step) {
+      const double lat = BASE_LAT + m / (Config::Odometer::EARTH_RADIUS_M * PI / 180.0);
+
+      PoiIndex<MemorySource>::Match match = PoiIndex<MemorySource>::Match();
+      const bool isFound = index.findNearest(lat, BASE_LON, Config::Poi::REARM_RADIUS_M, match);
+      if (alert.update(isFound, match.index, match.record, match.distanceM, now += 1000)) {
+        alerts++;
+        EXPECT_LE(alert.getDistanceM(), Config::Poi::ALERT_RADIUS_M);
+        EXPECT_EQ(nameOf(alert.getRecord()), "Fountain");
+        EXPECT_TRUE(alert.isShowing(now));
+      }
+    }
+  };
+
+  ride(-1000.0, 200.0);
+  EXPECT_EQ(alerts, 1);
+  ride(200.0, -250.0); // 通知半径の外だが再通知の半径の内側で折り返す
+  ride(-250.0, 0.0);
+  EXPECT_EQ(alerts, 1);
+  ride(0.0, -1000.0);
+  ride(-1000.0, 0.0);
+  EXPECT_EQ(alerts, 2);
+  EXPECT_FALSE(alert.isShowing(now + Config::Poi::ALERT_SHOW_MS));
+}
+
+TEST(PoiIndexTest, BenchmarkAgainstLinearScan) {
+  const size_t counts[] = {100, 1000, 10000, 100000};
+  for (size_t count : counts) {
+    // 約 50 km 四方に散らばる地点に対し、その中を走る想定で問い合わせる
+    const std::vector<PoiIndexBuilder::Poi> pois  = scatter(count, 0.45, 5);
+    const std::vector<uint8_t>              image = build(pois);
+
+    MemorySource           source(image.data(), image.size());
+    PoiIndex<MemorySource> index(source);
+    ASSERT_TRUE(index.open());
+
+    std::mt19937                           rng(6);
+    std::uniform_real_distribution<double> offset(0.0, 0.45);
+    std::vector<double>                    lats;
+    std::vector<double>                    lons;
+    for (int i = 0; i < 1000; i++) {
+      lats.push_back(BASE_LAT + offset(rng));
+      lons.push_back(BASE_LON + offset(rng));
+    }
+
+    uint64_t   records = 0;
+    uint64_t   cells   = 0;
+    int        hits    = 0;
+    const auto t0      = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < lats.size(); i++) {
+      PoiIndex<MemorySource>::Match match;
+      hits += index.findNearest(lats[i], lons[i], Config::Poi::REARM_RADIUS_M, match);
+      records += index.getStats().records;
+      cells += index.getStats().cells;
+    }
+    const auto t1 = std::chrono::steady_clock::now();
+
+    int linearHits = 0;
+    for (size_t i = 0; i < lats.size(); i++) {
+      std::string name;
+      float       distanceM = 0.0f;
+      linearHits += nearestLinear(pois, lats[i], lons[i], Config::Poi::REARM_RADIUS_M, name,
+                                  distanceM);
+    }
+    const auto t2 = std::chrono::steady_clock::now();
+
+    const double queries = static_cast<double>(lats.size());
+    std::cout << "[ BENCH    ] " << count << " POIs: " << image.size() << " bytes, "
+              << cells / queries << " cells and " << records / queries << " records/query, "
+              << std::chrono::duration<double, std::nano>(t1 - t0).count() / queries
+              << " ns/query, linear "
+              << std::chrono::duration<double, std::nano>(t2 - t1).count() / queries
+              << " ns/query" << std::endl;
+
+    EXPECT_EQ(hits, linearHits);
+    // 調べる地点は地点数に比例せず、周囲のセルの分だけになる
+    if (1000 <= count) {
+      EXPECT_LT(records / queries, count / 20.0);
+    }
+  }
+}
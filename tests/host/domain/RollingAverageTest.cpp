@@ -0,0 +1,145 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <deque>
+
+#include "domain/RollingAverage.h"
+#include "domain/Speedometer.h"
+
+namespace {
+
+// 窓内の全サンプルを保持して毎回足し直す素朴な実装 (比較用)
+class NaiveAverage {
+private:
+  struct Sample {
+    float         kmh;
+    unsigned long dtMs;
+  };
+
+  const unsigned long windowMs;
+  std::deque<Sample>  samples;
+  mutable uint64_t    visits = 0; // 足し直したサンプルの延べ数
+
+public:
+  explicit NaiveAverage(unsigned long windowMs) : windowMs(windowMs) {}
+
+  void add(float kmh, unsigned long dtMs) {
+    samples.push_back({kmh, dtMs});
+    unsigned long total = 0;
+    for (const Sample &s : samples) total += s.dtMs;
+    visits += samples.size();
+    while (windowMs <= total - samples.front().dtMs) {
+      total -= samples.front().dtMs;
+      samples.pop_front();
+    }
+  }
+
+  float get() const {
+    double        sum   = 0.0;
+    unsigned long total = 0;
+    for (const Sample &s : samples) {
+      sum += static_cast<double>(s.kmh) * s.dtMs;
+      total += s.dtMs;
+    }
+    visits += samples.size();
+    return total == 0 ? 0.0f : static_cast<float>(sum / total);
+  }
+
+  uint64_t getVisits() const {
+    return visits;
+  }
+};
+
+float rideSpeed(unsigned long t) {
+  return 25.0f + 8.0f * sinf(t / 7000.0f) + 3.0f * sinf(t / 900.0f);
+}
+
+} // namespace
+
+TEST(RollingAverageTest, EmptyIsZero) {
+  RollingAverage<11> avg(1000);
+  EXPECT_FLOAT_EQ(avg.get(), 0.0f);
+}
+
+TEST(RollingAverageTest, ConstantSpeed) {
+  RollingAverage<11> avg(1000);
+  for (int i = 0; i < 1000; i++) avg.add(23.4f, 100);
+  EXPECT_NEAR(avg.get(), 23.4f, 0.01f);
+}
+
+TEST(RollingAverageTest, OldSamplesLeaveTheWindow) {
+  RollingAverage<11> avg(1000);
+  for (int i = 0; i < 300; i++) avg.add(10.0f, 100); // 30 秒
+  for (int i = 0; i < 50; i++) avg.add(30.0f, 100);  // 5 秒
+  EXPECT_GT(avg.get(), 18.0f);
+  EXPECT_LT(avg.get(), 22.0f);
+  for (int i = 0; i < 110; i++) avg.add(30.0f, 100);
+  EXPECT_NEAR(avg.get(), 30.0f, 0.01f);
+}
+
+TEST(RollingAverageTest, LongGapRestartsWindow) {
+  RollingAverage<11> avg(1000);
+  for (int i = 0; i < 100; i++) avg.add(40.0f, 100);
+  avg.add(5.0f, 60000);
+  EXPECT_NEAR(avg.get(), 5.0f, 0.01f);
+}
+
+TEST(RollingAverageTest, MatchesNaiveWindowAtHighRates) {
+  const unsigned long rates[] = {100, 10, 1}; // 10 Hz, 100 Hz, 1 kHz
+  for (unsigned long dtMs : rates) {
+    RollingAverage<11> avg(1000);
+    NaiveAverage       naive(10000);
+    for (unsigned long t = 0; t < 120000; t += dtMs) {
+      avg.add(rideSpeed(t), dtMs);
+      naive.add(rideSpeed(t), dtMs);
+    }
+    // バケット 1 個分 (窓の 1/10) だけ古いサンプルを含む差を許容する
+    EXPECT_NEAR(avg.get(), naive.get(), 0.5f) << dtMs << " ms";
+  }
+}
+
+TEST(RollingAverageTest, SpeedometerWindows) {
+  Speedometer speedometer;
+  for (int i = 0; i < 3000; i++) { // 5 分間 20 km/h
+    speedometer.update(Numeric<DomainNumber>::from(20.0), 100, 0, 0);
+  }
+  for (int i = 0; i < 600; i++) { // 1 分間 35 km/h
+    speedometer.update(Numeric<DomainNumber>::from(35.0), 100, 0, 0);
+  }
+  EXPECT_NEAR(speedometer.getAvg10s(), 35.0f, 0.01f);
+  EXPECT_NEAR(speedometer.getAvg1min(), 35.0f, 0.3f);
+  EXPECT_NEAR(speedometer.getAvg5min(), 23.0f, 0.3f);
+}
+
+TEST(RollingAverageTest, Benchmark) {
+  const unsigned long samples = 60UL * 60 * 100; // 100 Hz で 1 時間
+
+  RollingAverage<61> avg(5000);
+  float              sink = 0.0f;
+  const auto         t0   = std::chrono::steady_clock::now();
+  for (unsigned long i = 0; i < samples; i++) {
+    avg.add(rideSpeed(i * 10), 10);
+    sink += avg.get();
+  }
+  const auto t1 = std::chrono::steady_clock::now();
+
+  NaiveAverage naive(300000);
+  const auto   t2 = std::chrono::steady_clock::now();
+  for (unsigned long i = 0; i < samples / 100; i++) { // 素朴な実装は 1/100 の件数で計測
+    naive.add(rideSpeed(i * 10), 10);
+    sink += naive.get();
+  }
+  const auto t3 = std::chrono::steady_clock::now();
+
+  const double bucketNs = std::chrono::duration<double, std::nano>(t1 - t0).count() / samples;
+  const double naiveNs =
+      std::chrono::duration<double, std::nano>(t3 - t2).count() / (samples / 100);
+  std::cout << "[ BENCH    ] 5 min window @100 Hz: bucketed " << bucketNs << " ns/sample, naive "
+            << naiveNs << " ns/sample (" << sizeof(avg) << " bytes)" << std::endl;
+  EXPECT_TRUE(std::isfinite(sink));
+  // 時間は負荷で揺れるので、仕事量で比べる。バケット版は 1 回あたり高々全バケット分しか触らない
+  const uint64_t naivePerSample = naive.getVisits() / (samples / 100);
+  EXPECT_LT(61u, naivePerSample);
+}
@@ -0,0 +1,203 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "domain/MemorySource.h"
+#include "domain/Route.h"
+#include "domain/RouteMatcher.h"
+#include "route/RouteBuilder.h"
+#include "support/RideReplay.h"
+
+namespace {
+
+constexpr double BASE_LAT  = 35.0;
+constexpr double BASE_LON  = 139.0;
+constexpr double M_PER_DEG = RideReplay::EARTH_RADIUS_M * M_PI / 180.0;
+
+struct Position {
+  double lat;
+  double lon;
+};
+
+Position at(double northM, double eastM) {
+  const double cosLat = cos(BASE_LAT * M_PI / 180.0);
+  return {BASE_LAT + northM / M_PER_DEG, BASE_LON + eastM / (M_PER_DEG * cosLat)};
+}
+
+RouteFormat::Point toPoint(const Position &p) {
+  return {static_cast<int32_t>(lround(p.lat * 1e7)), static_cast<int32_t>(lround(p.lon * 1e7))};
+}
+
+// 北へ lengthM 進み、outAndBack なら同じ道を戻る (spacingM ごとの点)
+std::vector<RouteFormat::Point> straight(double lengthM, double spacingM, bool outAndBack) {
+  std::vector<RouteFormat::Point> points;
+  for (double m = 0.0; m <= lengthM; m += spacingM) points.push_back(toPoint(at(m, 0.0)));
+  if (outAndBack) {
+    for (double m = lengthM - spacingM; 0.0 <= m; m -= spacingM) {
+      points.push_back(toPoint(at(m, 3.0))); // 反対車線
+    }
+  }
+  return points;
+}
+
+} // namespace
+
+TEST(RouteMatcherTest, LoadsBuiltImage) {
+  RouteBuilder builder;
+  for (int i = 0; i <= 10; i++) {
+    const Position p = at(i * 100.0, 0.0);
+    builder.add(p.lat, p.lon);
+    builder.add(p.lat, p.lon); // 重複は除かれる
+  }
+  const std::vector<uint8_t> image = builder.build();
+  EXPECT_EQ(builder.size(), 11u);
+
+  std::unique_ptr<Route> route(new Route());
+  MemorySource           source(image.data(), image.size());
+  ASSERT_TRUE(route->load(source));
+  EXPECT_EQ(route->getCount(), 11u);
+  EXPECT_NEAR(route->getLengthM(), 1000.0f, 1.0f);
+
+  MemorySource truncated(image.data(), image.size() - 1);
+  EXPECT_FALSE(route->load(truncated));
+  EXPECT_EQ(route->getCount(), 0u);
+}
+
+TEST(RouteMatcherTest, TracksDistanceToGo) {
+  const std::vector<RouteFormat::Point> points = straight(10000.0, 50.0, false);
+  std::unique_ptr<Route>                route(new Route());
+  ASSERT_TRUE(route->set(points.data(), points.size()));
+
+  RouteMatcher matcher(*route);
+  for (double m = 0.0; m <= 10000.0; m += 7.0) {
+    const Position p = at(m, 10.0 * sin(m / 300.0)); // 道幅の中で揺れる
+    matcher.update(p.lat, p.lon);
+    ASSERT_TRUE(matcher.isMatching());
+    ASSERT_FALSE(matcher.isOff());
+    ASSERT_NEAR(matcher.getDistanceToGoM(), 10000.0 - m, 2.0) << m;
+    if (0.0 < m) {
+      EXPECT_FALSE(matcher.getStats().usedGrid) << m;
+      EXPECT_LE(matcher.getStats().segments,
+                Config::Route::WINDOW_BACK + Config::Route::WINDOW_AHEAD + 1);
+    }
+  }
+}
+
+TEST(RouteMatcherTest, DetectsDetourAndReacquiresAhead) {
+  const std::vector<RouteFormat::Point> points = straight(10000.0, 50.0, false);
+  std::unique_ptr<Route>                route(new Route());
+  ASSERT_TRUE(route->set(points.data(), points.size()));
+
+  RouteMatcher matcher(*route);
+  for (double m = 0.0; m <= 2000.0; m += 10.0) {
+    const Position p = at(m, 0.0);
+    matcher.update(p.lat, p.lon);
+  }
+  EXPECT_FALSE(matcher.isOff());
+
+  // 東へ外れて並行する道を 5 km 走り、戻る
+  bool wasOff = false;
+  for (double e = 0.0; e <= 300.0; e += 10.0) {
+    const Position p = at(2000.0, e);
+    matcher.update(p.lat, p.lon);
+    wasOff = wasOff || matcher.isOff();
+  }
+  EXPECT_TRUE(wasOff);
+  const float distanceToGo = matcher.getDistanceToGoM();
+  for (double m = 2000.0; m <= 7000.0; m += 10.0) {
+    const Position p = at(m, 300.0);
+    matcher.update(p.lat, p.lon);
+    ASSERT_TRUE(matcher.isOff());
+  }
+  EXPECT_FLOAT_EQ(matcher.getDistanceToGoM(), distanceToGo); // 外れている間は止める
+
+  for (double e = 300.0; 0.0 <= e; e -= 10.0) {
+    const Position p = at(7000.0, e);
+    matcher.update(p.lat, p.lon);
+  }
+  EXPECT_FALSE(matcher.isOff());
+  EXPECT_NEAR(matcher.getDistanceToGoM(), 3000.0f, 2.0f);
+}
+
+TEST(RouteMatcherTest, OutAndBackKeepsDirection) {
+  const std::vector<RouteFormat::Point> points = straight(3000.0, 20.0, true);
+  std::unique_ptr<Route>                route(new Route());
+  ASSERT_TRUE(route->set(points.data(), points.size()));
+  const float lengthM = route->getLengthM();
+
+  RouteMatcher matcher(*route);
+  float        previous = lengthM + 1.0f;
+  for (double m = 0.0; m <= 6000.0; m += 5.0) {
+    const double   north = m <= 3000.0 ? m : 6000.0 - m;
+    const Position p     = at(north, m <= 3000.0 ? 0.0 : 3.0);
+    matcher.update(p.lat, p.lon);
+    ASSERT_FALSE(matcher.isOff());
+    ASSERT_LE(matcher.getDistanceToGoM(), previous + 1.0f) << m; // 往路に戻らない
+    previous = matcher.getDistanceToGoM();
+  }
+  EXPECT_LT(previous, 10.0f);
+}
+
+TEST(RouteMatcherTest, ReplayedRideAndBenchmark) {
+  // 雑音のない走行から経路を作り、雑音のある同じ走行を対応付ける
+  RouteBuilder builder;
+  RideReplay   truth(RideProfiles::rolling);
+  double       lastKm = -1.0;
+  truth.run(3600UL * 1000, 1000, [&](const SpNavData &nav, unsigned long, bool) {
+    if (truth.getTrueDistanceKm() - lastKm < 0.025) return;
+    lastKm = truth.getTrueDistanceKm();
+    builder.add(nav.latitude, nav.longitude);
+  });
+  ASSERT_TRUE(builder.isValid());
+
+  const std::vector<uint8_t> image = builder.build();
+  std::unique_ptr<Route>     route(new Route());
+  MemorySource               source(image.data(), image.size());
+  ASSERT_TRUE(route->load(source));
+
+  std::vector<SpNavData> fixes;
+  RideReplay             ride(RideProfiles::rolling, 3.0f);
+  ride.run(3600UL * 1000, 1000, [&](const SpNavData &nav, unsigned long, bool isNewFix) {
+    if (isNewFix) fixes.push_back(nav);
+  });
+
+  RouteMatcher matcher(*route);
+  uint64_t     segments = 0;
+  int          offs     = 0;
+  const auto   t0       = std::chrono::steady_clock::now();
+  for (const SpNavData &nav : fixes) {
+    matcher.update(nav.latitude, nav.longitude);
+    segments += matcher.getStats().segments;
+    offs += matcher.isOff();
+  }
+  const auto t1 = std::chrono::steady_clock::now();
+
+  // 比較: 毎回すべての線分を調べる
+  float sink = 0.0f;
+  for (const SpNavData &nav : fixes) {
+    const int32_t latE7 = static_cast<int32_t>(lround(nav.latitude * 1e7));
+    const int32_t lonE7 = static_cast<int32_t>(lround(nav.longitude * 1e7));
+    float         best  = INFINITY;
+    for (size_t i = 0; i < route->getSegmentCount(); i++) {
+      best = fminf(best, route->project(latE7, lonE7, i).distanceM);
+    }
+    sink += best;
+  }
+  const auto t2 = std::chrono::steady_clock::now();
+
+  const double n = static_cast<double>(fixes.size());
+  std::cout << "[ BENCH    ] " << route->getCount() << " points, " << route->getLengthM() / 1000
+            << " km: window " << segments / n << " segments, "
+            << std::chrono::duration<double, std::nano>(t1 - t0).count() / n
+            << " ns/fix, full scan "
+            << std::chrono::duration<double, std::nano>(t2 - t1).count() / n << " ns/fix ("
+            << sizeof(Route) << " bytes)" << std::endl;
+
+  EXPECT_EQ(offs, 0);
+  EXPECT_LT(matcher.getDistanceToGoM(), 50.0f);
+  EXPECT_LT(segments / n, 40.0);
+  EXPECT_GT(sink, 0.0f);
+}
@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+#include "domain/SpeedEstimator.h"
+#include "domain/Trip.h"
+#include "support/RideReplay.h"
+
+TEST(SpeedEstimatorTest, ZeroWithoutSamples) {
+  SpeedEstimator estimator;
+  estimator.update(1000);
+  EXPECT_FLOAT_EQ(estimator.get(), 0.0f);
+}
+
+TEST(SpeedEstimatorTest, ExtrapolatesBetweenSamples) {
+  SpeedEstimator estimator;
+  for (unsigned long t = 0; t <= 5000; t += 1000) estimator.addSample(10.0f + t / 1000.0f, t);
+
+  estimator.update(5000);
+  const float atSample = estimator.get();
+  estimator.update(5500);
+  EXPECT_GT(estimator.get(), atSample);
+}
+
+TEST(SpeedEstimatorTest, HoldsAfterMaxExtrapolation) {
+  SpeedEstimator estimator;
+  for (unsigned long t = 0; t <= 5000; t += 1000) estimator.addSample(t / 100.0f, t);
+
+  estimator.update(5000 + Config::SpeedEstimator::MAX_EXTRAPOLATION_MS);
+  const float limit = estimator.get();
+  estimator.update(60000);
+  EXPECT_FLOAT_EQ(estimator.get(), limit);
+}
+
+TEST(SpeedEstimatorTest, SnapsToZeroWhenStopped) {
+  SpeedEstimator estimator;
+  estimator.addSample(30.0f, 0);
+  estimator.addSample(20.0f, 1000);
+  estimator.addSample(0.0f, 2000);
+  estimator.update(2500);
+  EXPECT_FLOAT_EQ(estimator.get(), 0.0f);
+}
+
+TEST(SpeedEstimatorTest, TripFeedsOnlyNewEpochs) {
+  Trip      trip;
+  SpNavData nav = {};
+  trip.begin();
+
+  nav.posFixMode = Fix3D;
+  nav.velocity   = 20.0f / 3.6f;
+  nav.time.sec   = 1;
+  trip.update(nav, 0);
+  trip.update(nav, 500);
+  EXPECT_NEAR(trip.speedEstimator.get(), 20.0f, 0.01f);
+
+  nav.posFixMode = FixInvalid;
+  trip.update(nav, 600);
+  EXPECT_FLOAT_EQ(trip.speedEstimator.get(), 0.0f);
+}
+
+namespace {
+
+struct Error {
+  double meanAbs   = 0.0;
+  double overshoot = 0.0;
+};
+
+// 表示周期ごとに真値との誤差を集計する
+template <typename Display> Error evaluate(RideReplay::Profile profile, Display display) {
+  RideReplay replay(profile, 0.0f, 0.2f);
+  Error      error;
+  double     sum   = 0.0;
+  int        count = 0;
+
+  replay.run(600000, Config::DISPLAY_UPDATE_INTERVAL_MS,
+             [&](const SpNavData &nav, unsigned long now, bool isNewFix) {
+               const float shown = display(nav, now, isNewFix);
+               const float truth = replay.getTrueKmh();
+               sum += fabs(shown - truth);
+               count++;
+               if (error.overshoot < shown - truth) error.overshoot = shown - truth;
+             });
+
+  error.meanAbs = sum / count;
+  return error;
+}
+
+} // namespace
+
+TEST(SpeedEstimatorTest, ReplayLagAndOvershoot) {
+  const RideReplay::Profile profiles[] = {RideProfiles::commute, RideProfiles::rolling};
+
+  for (RideReplay::Profile profile : profiles) {
+    float held = 0.0f;
+    Error hold = evaluate(profile, [&](const SpNavData &nav, unsigned long, bool isNewFix) {
+      if (isNewFix) held = nav.velocity * 3.6f;
+      return held;
+    });
+
+    SpeedEstimator estimator;
+    Error          smooth = evaluate(profile, [&](const SpNavData &nav, unsigned long now,
+                                         bool isNewFix) {
+      if (isNewFix) estimator.addSample(nav.velocity * 3.6f, now);
+      estimator.update(now);
+      return estimator.get();
+    });
+
+    std::cout << "[ REPLAY   ] hold: mean " << hold.meanAbs << " km/h, overshoot " << hold.overshoot
+              << " km/h / estimator: mean " << smooth.meanAbs << " km/h, overshoot "
+              << smooth.overshoot << " km/h" << std::endl;
+
+    EXPECT_LT(smooth.meanAbs, hold.meanAbs);
+    EXPECT_LT(smooth.overshoot, hold.overshoot);
+  }
+}
@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include "domain/SpeedHistogram.h"
+#include "domain/Trip.h"
+#include "support/RideReplay.h"
+
+TEST(SpeedHistogramTest, EmptyIsZero) {
+  SpeedHistogram histogram;
+  EXPECT_FLOAT_EQ(histogram.getPercentile(0.5f), 0.0f);
+  EXPECT_EQ(histogram.getTimeInRangeMs(0.0f, 100.0f), 0u);
+}
+
+TEST(SpeedHistogramTest, PercentileInterpolatesWithinBin) {
+  SpeedHistogram histogram;
+  histogram.add(10.5f, 1000); // 10 - 12 km/h のビン
+  histogram.add(20.5f, 3000); // 20 - 22 km/h のビン
+  EXPECT_NEAR(histogram.getPercentile(0.125f), 11.0f, 1e-4f);
+  EXPECT_NEAR(histogram.getPercentile(0.5f), 20.0f + 2.0f / 3.0f, 1e-4f);
+  EXPECT_NEAR(histogram.getPercentile(1.0f), 22.0f, 1e-4f);
+}
+
+TEST(SpeedHistogramTest, TimeInRangeSplitsPartialBins) {
+  SpeedHistogram histogram;
+  histogram.add(10.5f, 1000);
+  histogram.add(20.5f, 3000);
+  EXPECT_EQ(histogram.getTimeInRangeMs(0.0f, 15.0f), 1000u);
+  EXPECT_EQ(histogram.getTimeInRangeMs(11.0f, 21.0f), 500u + 1500u);
+  EXPECT_EQ(histogram.getTotalMs(), 4000u);
+}
+
+TEST(SpeedHistogramTest, FastestBinIsOpenEnded) {
+  SpeedHistogram histogram;
+  histogram.add(90.0f, 2000);
+  EXPECT_EQ(histogram.getBinMs(SpeedHistogram::BINS - 1), 2000u);
+  EXPECT_EQ(histogram.getZoneMs(SpeedHistogram::ZONE_COUNT - 1), 2000u);
+  EXPECT_EQ(histogram.getTimeInRangeMs(40.0f, 1000.0f), 2000u);
+}
+
+TEST(SpeedHistogramTest, TripWeightsByMovingTime) {
+  Trip      trip;
+  SpNavData nav = {};
+  nav.posFixMode = Fix3D;
+  nav.latitude   = 35.0;
+  nav.longitude  = 139.0;
+  trip.begin();
+
+  unsigned long now = 0;
+  for (int i = 0; i < 100; i++) { // 10 秒停止
+    trip.update(nav, now += 100);
+  }
+  nav.velocity = 5.0f; // 18 km/h
+  for (int i = 0; i < 200; i++) {
+    nav.time.usec = i;
+    trip.update(nav, now += 100);
+  }
+
+  EXPECT_EQ(trip.speedHistogram.getTotalMs(), trip.stopwatch.getMovingTimeMs());
+  EXPECT_EQ(trip.speedHistogram.getTimeInRangeMs(18.0f, 20.0f), 20000u);
+
+  const Trip::Totals totals = trip.getTotals();
+  Trip               restored;
+  restored.begin();
+  restored.restore(totals);
+  EXPECT_EQ(restored.speedHistogram.getTotalMs(), 20000u);
+  EXPECT_EQ(restored.odometer.getTotalMm(), trip.odometer.getTotalMm());
+  EXPECT_FLOAT_EQ(restored.speedometer.getMax(), trip.speedometer.getMax());
+}
+
+TEST(SpeedHistogramTest, MultiHourReplayBenchmark) {
+  std::vector<float> speeds;
+  RideReplay         ride(RideProfiles::commute, 0.5f, 0.2f);
+  ride.setIntervalMs(100);
+  ride.run(6UL * 3600 * 1000, 100, [&](const SpNavData &nav, unsigned long, bool isNewFix) {
+    if (isNewFix && 1.0f < nav.velocity * 3.6f) speeds.push_back(nav.velocity * 3.6f);
+  });
+
+  SpeedHistogram histogram;
+  const auto     t0 = std::chrono::steady_clock::now();
+  for (float kmh : speeds) histogram.add(kmh, 100);
+  const auto  t1  = std::chrono::steady_clock::now();
+  const float p50 = histogram.getPercentile(0.5f);
+  const float p95 = histogram.getPercentile(0.95f);
+  const auto  t2  = std::chrono::steady_clock::now();
+
+  // 全サンプルを保持して並べ替える場合との比較
+  std::vector<float> sorted(speeds);
+  const auto         t3 = std::chrono::steady_clock::now();
+  std::sort(sorted.begin(), sorted.end());
+  const float exact50 = sorted[sorted.size() / 2];
+  const float exact95 = sorted[sorted.size() * 95 / 100];
+  const auto  t4      = std::chrono::steady_clock::now();
+
+  const double addNs   = std::chrono::duration<double, std::nano>(t1 - t0).count() / speeds.size();
+  const double queryNs = std::chrono::duration<double, std::nano>(t2 - t1).count() / 2;
+  const double sortUs  = std::chrono::duration<double, std::micro>(t4 - t3).count();
+  std::cout << "[ BENCH    ] " << speeds.size() << " samples: add " << addNs << " ns, query "
+            << queryNs << " ns (" << sizeof(histogram) << " bytes) / sort " << sortUs << " us ("
+            << speeds.size() * sizeof(float) << " bytes)" << std::endl;
+  std::cout << "[ BENCH    ] p50 " << p50 << " (exact " << exact50 << "), p95 " << p95
+            << " (exact " << exact95 << ") km/h" << std::endl;
+
+  EXPECT_NEAR(p50, exact50, Config::SpeedHistogram::BIN_KMH / 2);
+  EXPECT_NEAR(p95, exact95, Config::SpeedHistogram::BIN_KMH / 2);
+  uint32_t zoneSum = 0;
+  for (size_t zone = 0; zone < SpeedHistogram::ZONE_COUNT; zone++) {
+    zoneSum += histogram.getZoneMs(zone);
+  }
+  EXPECT_NEAR(zoneSum, histogram.getTotalMs(), SpeedHistogram::ZONE_COUNT);
+}
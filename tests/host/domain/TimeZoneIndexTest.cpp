@@ -0,0 +1,344 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "domain/Clock.h"
+#include "domain/MemorySource.h"
+#include "domain/TimeZoneIndex.h"
+#include "hardware/FlashFileSource.h"
+#include "tz/TimeZoneIndexBuilder.h"
+
+namespace {
+
+typedef TimeZoneIndexBuilder::Point Point;
+
+const char *const BERLIN   = "CET-1CEST,M3.5.0,M10.5.0/3";
+const char *const NEW_YORK = "EST5EDT,M3.2.0,M11.1.0";
+const char *const SYDNEY   = "AEST-10AEDT,M10.1.0,M4.1.0/3";
+
+uint32_t epochOf(int year, int month, int day, int hour, int minute) {
+  const int32_t days = TimeZone::daysFromCivil(year, month, day) - TimeZone::EPOCH_DAYS;
+  return static_cast<uint32_t>(days) * 86400 + hour * 3600 + minute * 60;
+}
+
+TzFormat::Zone parse(const char *tz) {
+  TzFormat::Zone zone = TzFormat::Zone();
+  EXPECT_TRUE(TimeZoneIndexBuilder::parsePosix(tz, zone)) << tz;
+  return zone;
+}
+
+std::vector<Point> box(double south, double west, double north, double east) {
+  return {{south, west}, {north, west}, {north, east}, {south, east}};
+}
+
+// 日本と中部ヨーロッパの矩形と、対角線で 2 つに分けた矩形
+std::vector<uint8_t> buildSample() {
+  TimeZoneIndexBuilder builder;
+  const int            tokyo  = builder.addZone("JST-9");
+  const int            berlin = builder.addZone(BERLIN);
+  const int            west   = builder.addZone("<+07>-7");
+  const int            east   = builder.addZone("<+08>-8");
+  EXPECT_TRUE(builder.addPolygon(tokyo, box(30.0, 129.0, 46.0, 146.0), 0.0));
+  EXPECT_TRUE(builder.addPolygon(berlin, box(47.0, 6.0, 55.0, 15.0), 0.0));
+  EXPECT_TRUE(builder.addPolygon(west, {{20.0, 100.0}, {30.0, 100.0}, {20.0, 110.0}}, 0.0));
+  EXPECT_TRUE(builder.addPolygon(east, {{30.0, 100.0}, {30.0, 110.0}, {20.0, 110.0}}, 0.0));
+  return builder.build(1.0);
+}
+
+// 南北に波打つ境界で経度 15 度ごとに分けた 24 の時間帯。半分は夏時間あり
+struct World {
+  std::vector<std::vector<Point>> polygons;
+  std::vector<int>                offsets;
+
+  static constexpr double SOUTH = -56.0;
+  static constexpr double NORTH = 72.0;
+
+  static double border(int k, double lat) {
+    if (k <= 0) return -180.0;
+    if (24 <= k) return 180.0;
+    return -180.0 + 15.0 * k + 2.0 * sin(lat * 0.3 + k) + 0.4 * sin(lat * 3.7 + 2.0 * k);
+  }
+
+  explicit World(double stepDeg) {
+    for (int k = 0; k < 24; k++) {
+      std::vector<Point> polygon;
+      for (double lat = SOUTH; lat <= NORTH; lat += stepDeg) {
+        polygon.push_back({lat, border(k, lat)});
+      }
+      for (double lat = NORTH; SOUTH <= lat; lat -= stepDeg) {
+        polygon.push_back({lat, border(k + 1, lat)});
+      }
+      polygons.push_back(polygon);
+      offsets.push_back((k - 12) * 60);
+    }
+  }
+
+  std::vector<uint8_t> build(double toleranceM, size_t &vertices) const {
+    TimeZoneIndexBuilder builder;
+    for (size_t k = 0; k < polygons.size(); k++) {
+      char tz[40];
+      if (k % 2 == 0) snprintf(tz, sizeof(tz), "<Z>%d", -offsets[k] / 60);
+      else snprintf(tz, sizeof(tz), "<Z>%d<S>,M3.5.0,M10.5.0/3", -offsets[k] / 60);
+      EXPECT_TRUE(builder.addPolygon(builder.addZone(tz), polygons[k], toleranceM)) << tz;
+    }
+    vertices = builder.getVertexCount();
+    return builder.build(1.0);
+  }
+
+  // 間引く前の多角形を全部調べる。見つからなければ 0 から 23 以外
+  int find(double lat, double lon) const {
+    for (size_t k = 0; k < polygons.size(); k++) {
+      bool                      inside = false;
+      const std::vector<Point> &p      = polygons[k];
+      for (size_t i = 0, j = p.size() - 1; i < p.size(); j = i++) {
+        if ((lat < p[i].lat) == (lat < p[j].lat)) continue;
+        const double x =
+            p[j].lon + (lat - p[j].lat) * (p[i].lon - p[j].lon) / (p[i].lat - p[j].lat);
+        if (lon < x) inside = !inside;
+      }
+      if (inside) return static_cast<int>(k);
+    }
+    return -1;
+  }
+};
+
+constexpr double World::SOUTH;
+constexpr double World::NORTH;
+
+} // namespace
+
+TEST(TimeZoneTest, ParsesPosixRules) {
+  const TzFormat::Zone berlin = parse(BERLIN);
+  EXPECT_EQ(berlin.stdOffsetMin, 60);
+  EXPECT_EQ(berlin.dstSaveMin, 60);
+  EXPECT_EQ(berlin.start.month, 3);
+  EXPECT_EQ(berlin.start.week, 5);
+  EXPECT_EQ(berlin.start.weekday, 0);
+  EXPECT_EQ(berlin.start.minute, 120);
+  EXPECT_EQ(berlin.end.month, 10);
+  EXPECT_EQ(berlin.end.minute, 180);
+
+  EXPECT_EQ(parse(NEW_YORK).stdOffsetMin, -300);
+  EXPECT_EQ(parse("JST-9").stdOffsetMin, 540);
+  EXPECT_EQ(parse("JST-9").dstSaveMin, 0);
+  EXPECT_EQ(parse("IST-5:30").stdOffsetMin, 330);
+  EXPECT_EQ(parse("<+0545>-5:45").stdOffsetMin, 345);
+  EXPECT_EQ(parse("<+1030>-10:30<+11>-11,M10.1.0,M4.1.0").dstSaveMin, 30);
+
+  TzFormat::Zone    zone;
+  const char *const broken[] = {
+      "",
+      "JST",       // 時差がない
+      "J-9",       // 名前が短い
+      "JST-9x",
+      "CET-1CEST", // 規則がない
+      "CET-1CEST,M3.5.0",
+      "CET-1CEST,J60,J300", // 通日の規則は扱わない
+      "CET-1CEST,M13.5.0,M10.5.0",
+      "CET-1CEST,M3.6.0,M10.5.0",
+  };
+  for (const char *tz : broken) EXPECT_FALSE(TimeZoneIndexBuilder::parsePosix(tz, zone)) << tz;
+}
+
+TEST(TimeZoneTest, FollowsDstTransitions) {
+  struct Case {
+    const char *tz;
+    uint32_t    at; // 切り替えの時点 (UTC)
+    int         before;
+    int         after;
+  };
+  const Case cases[] = {
+      {BERLIN, epochOf(2025, 3, 30, 1, 0), 60, 120},     // 3 月の最終日曜
+      {BERLIN, epochOf(2025, 10, 26, 1, 0), 120, 60},    // 10 月は日曜が 4 回だけ
+      {BERLIN, epochOf(2026, 3, 29, 1, 0), 60, 120},     // 日曜が 5 回ある
+      {NEW_YORK, epochOf(2025, 3, 9, 7, 0), -300, -240}, // 3 月の第 2 日曜 02:00 EST
+      {NEW_YORK, epochOf(2025, 11, 2, 6, 0), -240, -300},
+      {SYDNEY, epochOf(2025, 4, 5, 16, 0), 660, 600}, // 南半球は年をまたいで夏時間
+      {SYDNEY, epochOf(2025, 10, 4, 16, 0), 600, 660},
+  };
+  for (const Case &c : cases) {
+    const TimeZone zone(parse(c.tz));
+    EXPECT_EQ(zone.getOffsetMin(c.at - 1), c.before) << c.tz << " " << c.at;
+    EXPECT_EQ(zone.getOffsetMin(c.at), c.after) << c.tz << " " << c.at;
+  }
+  EXPECT_EQ(TimeZone(parse(SYDNEY)).getOffsetMin(epochOf(2025, 1, 1, 0, 0)), 660);
+  EXPECT_EQ(TimeZone(parse(SYDNEY)).getOffsetMin(epochOf(2025, 7, 1, 0, 0)), 600);
+  EXPECT_EQ(TimeZone().getOffsetMin(epochOf(2025, 7, 1, 0, 0)), Config::Time::DEFAULT_OFFSET_MIN);
+}
+
+TEST(TimeZoneTest, ClockUsesZone) {
+  SpNavData nav = {};
+  nav.time      = {2025, 7, 1, 22, 30, 15, 0};
+
+  Clock clock;
+  clock.update(nav); // 時間帯がわかるまでは日本時間
+  EXPECT_EQ(clock.getTime().hour, 7);
+  EXPECT_EQ(clock.getLocalDate(clock.getEpoch()).day, 2);
+
+  clock.setZone(parse(BERLIN));
+  clock.update(nav);
+  EXPECT_EQ(clock.getTime().hour, 0);
+  EXPECT_EQ(clock.getTime().minute, 30);
+  EXPECT_EQ(clock.getTime().second, 15);
+  EXPECT_EQ(clock.getLocalDate(clock.getEpoch()).day, 2);
+  // 冬の記録はその時点の時差で日付にする
+  EXPECT_EQ(clock.getLocalDate(epochOf(2025, 1, 15, 23, 30)).day, 16);
+  EXPECT_EQ(clock.getLocalDate(epochOf(2025, 7, 15, 22, 30)).day, 16);
+  EXPECT_EQ(clock.getLocalDate(epochOf(2025, 1, 15, 22, 30)).day, 15);
+
+  clock.setZone(parse(NEW_YORK));
+  clock.update(nav);
+  EXPECT_EQ(clock.getTime().hour, 18);
+  EXPECT_EQ(clock.getLocalDate(clock.getEpoch()).day, 1);
+
+  nav.time.year = 2024; // 時刻が確定していない
+  clock.update(nav);
+  EXPECT_EQ(clock.getTime().hour, 0);
+  EXPECT_EQ(clock.getEpoch(), 0u);
+}
+
+TEST(TimeZoneIndexTest, LooksUpZones) {
+  const std::vector<uint8_t>  image = buildSample();
+  MemorySource                source(image.data(), image.size());
+  TimeZoneIndex<MemorySource> index(source);
+  ASSERT_TRUE(index.open());
+
+  TzFormat::Zone zone;
+  ASSERT_TRUE(index.lookup(35.68, 139.76, zone));
+  EXPECT_EQ(zone.stdOffsetMin, 540);
+  EXPECT_EQ(index.getStats().polygons, 0u); // セル全体が日本
+
+  ASSERT_TRUE(index.lookup(52.52, 13.40, zone));
+  EXPECT_EQ(TimeZone(zone).getOffsetMin(epochOf(2025, 7, 1, 0, 0)), 120);
+  ASSERT_TRUE(index.lookup(47.2, 6.5, zone)); // 境界を含むセル
+  EXPECT_EQ(zone.stdOffsetMin, 60);
+  EXPECT_LT(0u, index.getStats().polygons);
+
+  ASSERT_TRUE(index.lookup(21.0, 101.0, zone));
+  EXPECT_EQ(zone.stdOffsetMin, 420);
+  ASSERT_TRUE(index.lookup(29.0, 109.0, zone));
+  EXPECT_EQ(zone.stdOffsetMin, 480);
+  ASSERT_TRUE(index.lookup(24.9, 105.0, zone)); // 対角線のすぐ手前
+  EXPECT_EQ(zone.stdOffsetMin, 420);
+  ASSERT_TRUE(index.lookup(25.1, 105.0, zone));
+  EXPECT_EQ(zone.stdOffsetMin, 480);
+
+  // どの時間帯にも入らなければ海上の時差
+  EXPECT_FALSE(index.lookup(40.0, 100.0, zone));
+  EXPECT_EQ(zone.stdOffsetMin, 420);
+  EXPECT_FALSE(index.lookup(40.0, 160.0, zone)); // グリッドの外
+  EXPECT_EQ(zone.stdOffsetMin, 660);
+  EXPECT_FALSE(index.lookup(40.0, -172.6, zone));
+  EXPECT_EQ(zone.stdOffsetMin, -720);
+  EXPECT_EQ(zone.dstSaveMin, 0);
+}
+
+TEST(TimeZoneIndexTest, UpdatesOnlyWhenCellChanges) {
+  const std::vector<uint8_t>  image = buildSample();
+  MemorySource                source(image.data(), image.size());
+  TimeZoneIndex<MemorySource> index(source);
+  ASSERT_TRUE(index.open());
+
+  // 日本の中を 10 m/s で東へ 1 時間走る。時差は既定と同じなので変わらない
+  unsigned long now = 0;
+  for (int i = 0; i < 3600; i++, now += 1000) {
+    EXPECT_FALSE(index.update(35.5, 138.8 + i * 0.00011, now));
+  }
+  EXPECT_EQ(index.getZone().stdOffsetMin, 540);
+  EXPECT_EQ(index.getLookupCount(), 2u); // 1 度ごとのセルを 1 回またいだ
+
+  EXPECT_TRUE(index.update(52.52, 13.40, now));
+  EXPECT_EQ(index.getZone().stdOffsetMin, 60);
+  EXPECT_EQ(index.getLookupCount(), 3u);
+
+  // 境界を含むセルでは一定間隔で引き直す
+  EXPECT_TRUE(index.update(24.95, 105.0, now));
+  EXPECT_EQ(index.getZone().stdOffsetMin, 420);
+  EXPECT_FALSE(index.update(24.95, 105.1, now + Config::TimeZone::RECHECK_MS - 1));
+  EXPECT_TRUE(index.update(24.95, 105.1, now + Config::TimeZone::RECHECK_MS));
+  EXPECT_EQ(index.getZone().stdOffsetMin, 480);
+}
+
+TEST(TimeZoneIndexTest, RejectsBrokenImage) {
+  std::vector<uint8_t>        image = buildSample();
+  MemorySource                truncated(image.data(), image.size() - 1);
+  TimeZoneIndex<MemorySource> shortIndex(truncated);
+  EXPECT_FALSE(shortIndex.open());
+  EXPECT_FALSE(shortIndex.update(52.52, 13.40, 0));
+  EXPECT_EQ(shortIndex.getZone().stdOffsetMin, Config::Time::DEFAULT_OFFSET_MIN);
+
+  image[0] ^= 0xFF;
+  MemorySource                source(image.data(), image.size());
+  TimeZoneIndex<MemorySource> index(source);
+  EXPECT_FALSE(index.open());
+}
+
+TEST(TimeZoneIndexTest, ReadsFromFlashFile) {
+  FlashClass::mockReset();
+  FlashClass::mockFiles[Config::TimeZone::PATH] = buildSample();
+
+  FlashFileSource                source;
+  TimeZoneIndex<FlashFileSource> index(source);
+  ASSERT_TRUE(source.begin(Config::TimeZone::PATH));
+  ASSERT_TRUE(index.open());
+  EXPECT_TRUE(index.update(52.52, 13.40, 0));
+  EXPECT_EQ(index.getZone().stdOffsetMin, 60);
+  FlashClass::mockReset();
+}
+
+// 許容誤差ごとの索引の大きさ、1 回引く費用、間引く前の境界との食い違い
+TEST(TimeZoneIndexTest, LookupCost) {
+  const World                            world(0.05);
+  std::mt19937                           rng(7);
+  std::uniform_real_distribution<double> lat(World::SOUTH + 0.1, World::NORTH - 0.1);
+  std::uniform_real_distribution<double> lon(-180.0, 180.0);
+  std::vector<Point>                     points;
+  for (int i = 0; i < 20000; i++) points.push_back({lat(rng), lon(rng)});
+
+  const auto       t0 = std::chrono::steady_clock::now();
+  std::vector<int> expected(points.size());
+  for (size_t i = 0; i < points.size(); i++) expected[i] = world.find(points[i].lat, points[i].lon);
+  const double linearNs =
+      std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count() /
+      points.size();
+
+  for (double toleranceM : {0.0, 100.0, 1000.0}) {
+    size_t                      vertices = 0;
+    const std::vector<uint8_t>  image    = world.build(toleranceM, vertices);
+    MemorySource                source(image.data(), image.size());
+    TimeZoneIndex<MemorySource> index(source);
+    ASSERT_TRUE(index.open());
+
+    uint64_t   polygons = 0;
+    uint64_t   read     = 0;
+    int        wrong    = 0;
+    const auto t1       = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < points.size(); i++) {
+      TzFormat::Zone zone;
+      const bool     isFound = index.lookup(points[i].lat, points[i].lon, zone);
+      polygons += index.getStats().polygons;
+      read += index.getStats().vertices;
+      if (!isFound || zone.stdOffsetMin != world.offsets[expected[i]]) wrong++;
+    }
+    const double ns =
+        std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t1).count() /
+        points.size();
+
+    // 1 Hz の測位で 1 時間東へ走る (10 m/s)。引き直すのはセルが変わるときと境界の近くだけ
+    const uint32_t lookups = index.getLookupCount();
+    for (unsigned long s = 0; s < 3600; s++) index.update(45.0, 14.8 + s * 0.000127, s * 1000);
+
+    const double n = static_cast<double>(points.size());
+    std::cout << "[ BENCH    ] tolerance " << toleranceM << " m: " << vertices << " vertices, "
+              << image.size() << " bytes, " << ns << " ns/lookup (" << polygons / n
+              << " polygons, " << read / n << " vertices), linear " << linearNs
+              << " ns/lookup, mismatch " << 100.0 * wrong / n << " %, "
+              << index.getLookupCount() - lookups << " lookups/hour at 1 Hz" << std::endl;
+
+    EXPECT_LT(wrong, static_cast<int>(points.size() / 100)) << toleranceM;
+    EXPECT_LT(index.getLookupCount() - lookups, 3600u / 10);
+  }
+}
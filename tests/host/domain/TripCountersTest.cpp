@@ -0,0 +1,166 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include "domain/Trip.h"
+#include "domain/TripCounters.h"
+#include "support/RideReplay.h"
+
+namespace {
+
+std::vector<SpNavData> record(unsigned long durationMs) {
+  std::vector<SpNavData> fixes;
+  RideReplay             ride(RideProfiles::commute, 0.5f, 0.2f);
+  ride.run(durationMs, 1000, [&](const SpNavData &nav, unsigned long, bool) {
+    fixes.push_back(nav);
+  });
+  return fixes;
+}
+
+// 測位 1 回あたりの仕事。Trip の更新 (速度推定・ストップウォッチ・距離計) と、カウンタ 1 個への
+// 差分の加算を数える
+struct Cost {
+  double   ns          = 0.0; // 表示だけ
+  uint64_t tripUpdates = 0;
+  uint64_t counterAdds = 0;
+  uint64_t lastMm      = 0; // 最後のカウンタの距離
+};
+
+// 1 つの Trip の差分を N 個のカウンタに配る
+template <size_t N> Cost shared(const std::vector<SpNavData> &fixes) {
+  Trip            trip;
+  TripCounters<N> counters;
+  trip.begin();
+
+  Cost          cost;
+  unsigned long now = 0;
+  const auto    t0  = std::chrono::steady_clock::now();
+  for (const SpNavData &nav : fixes) {
+    trip.update(nav, now += 1000);
+    counters.add(trip.getLastDelta());
+    cost.tripUpdates++;
+    cost.counterAdds += N;
+  }
+  const auto t1 = std::chrono::steady_clock::now();
+  cost.ns     = std::chrono::duration<double, std::nano>(t1 - t0).count() / fixes.size();
+  cost.lastMm = counters.get(N - 1).totalMm;
+  return cost;
+}
+
+// 比較: カウンタごとに Trip を持つ
+Cost separate(const std::vector<SpNavData> &fixes, size_t n) {
+  std::vector<std::unique_ptr<Trip>> trips;
+  for (size_t i = 0; i < n; i++) {
+    trips.emplace_back(new Trip());
+    trips.back()->begin();
+  }
+
+  Cost          cost;
+  unsigned long now = 0;
+  const auto    t0  = std::chrono::steady_clock::now();
+  for (const SpNavData &nav : fixes) {
+    now += 1000;
+    for (std::unique_ptr<Trip> &trip : trips) {
+      trip->update(nav, now);
+      cost.tripUpdates++;
+    }
+  }
+  const auto t1 = std::chrono::steady_clock::now();
+  cost.ns     = std::chrono::duration<double, std::nano>(t1 - t0).count() / fixes.size();
+  cost.lastMm = trips.back()->odometer.getTotalMm();
+  return cost;
+}
+
+} // namespace
+
+TEST(TripCountersTest, CounterAddsDelta) {
+  TripCounter counter;
+  TripDelta   delta;
+  delta.distanceMm = 5000;
+  delta.movingMs   = 1000;
+  delta.elapsedMs  = 1000;
+  delta.kmh        = 18.0f;
+  counter.add(delta);
+  delta.kmh = 12.0f;
+  counter.add(delta);
+
+  EXPECT_EQ(counter.totalMm, 10000u);
+  EXPECT_EQ(counter.movingTimeMs, 2000u);
+  EXPECT_FLOAT_EQ(counter.maxKmh, 18.0f);
+  EXPECT_FLOAT_EQ(counter.getAvgKmh(), 18.0f); // 5 m/s
+}
+
+TEST(TripCountersTest, CountersAreIndependentOfTripResets) {
+  const std::vector<SpNavData> fixes = record(20UL * 60 * 1000);
+  Trip                         trip;
+  trip.begin();
+
+  unsigned long now = 0;
+  for (size_t i = 0; i < fixes.size(); i++) {
+    if (i == fixes.size() / 2) {
+      trip.resetCounter(Trip::Counter::TRIP_B);
+      trip.resetOdometerAndMovingTime();
+    }
+    trip.update(fixes[i], now += 1000);
+  }
+
+  const TripCounter a        = trip.getCounter(Trip::Counter::TRIP_A);
+  const TripCounter b        = trip.getCounter(Trip::Counter::TRIP_B);
+  const TripCounter lifetime = trip.getCounter(Trip::Counter::LIFETIME);
+  EXPECT_EQ(a.totalMm, lifetime.totalMm);
+  EXPECT_EQ(b.totalMm, trip.odometer.getTotalMm());
+  EXPECT_EQ(b.movingTimeMs, trip.stopwatch.getMovingTimeMs());
+  EXPECT_LT(b.totalMm, a.totalMm);
+  EXPECT_GT(b.totalMm, 0u);
+  EXPECT_FLOAT_EQ(a.maxKmh, trip.speedometer.getMax());
+}
+
+TEST(TripCountersTest, LifetimeSurvivesRestoreAndReset) {
+  const std::vector<SpNavData> fixes = record(5UL * 60 * 1000);
+  Trip                         trip;
+  trip.begin();
+  unsigned long now = 0;
+  for (const SpNavData &nav : fixes) trip.update(nav, now += 1000);
+
+  const Trip::Totals totals = trip.getTotals();
+  Trip               restored;
+  restored.begin();
+  restored.restore(totals);
+  restored.reset();
+  restored.resetCounter(Trip::Counter::TRIP_A);
+
+  EXPECT_EQ(restored.getCounter(Trip::Counter::LIFETIME).totalMm,
+            trip.getCounter(Trip::Counter::LIFETIME).totalMm);
+  EXPECT_EQ(restored.getCounter(Trip::Counter::TRIP_B).totalMm,
+            trip.getCounter(Trip::Counter::TRIP_B).totalMm);
+  EXPECT_EQ(restored.getCounter(Trip::Counter::TRIP_A).totalMm, 0u);
+}
+
+TEST(TripCountersTest, BenchmarkCostIsFlatInCounterCount) {
+  const std::vector<SpNavData> fixes = record(4UL * 3600 * 1000);
+  const uint64_t               count = fixes.size();
+
+  const Cost costs[]  = {shared<1>(fixes), shared<4>(fixes), shared<16>(fixes), shared<64>(fixes)};
+  const int  counts[] = {1, 4, 16, 64};
+  const Cost apart    = separate(fixes, 4);
+  for (int i = 0; i < 4; i++) {
+    std::cout << "[ BENCH    ] " << counts[i] << " counters: " << costs[i].ns << " ns/fix, "
+              << costs[i].tripUpdates / count << " trip updates/fix" << std::endl;
+  }
+  std::cout << "[ BENCH    ] 4 separate trips: " << apart.ns << " ns/fix, "
+            << apart.tripUpdates / count << " trip updates/fix, "
+            << sizeof(TripCounters<64>) / 64 << " bytes/counter" << std::endl;
+
+  // 時間は負荷で揺れるので表示だけにし、仕事の量で比べる。カウンタをいくつ増やしても Trip の
+  // 更新は測位 1 回につき 1 回のままで、増えるのはカウンタ 1 個につき 1 回の加算だけ
+  for (int i = 0; i < 4; i++) {
+    EXPECT_EQ(costs[i].tripUpdates, count);
+    EXPECT_EQ(costs[i].counterAdds, count * counts[i]);
+    EXPECT_EQ(costs[i].lastMm, apart.lastMm); // 結果は Trip を分けたときと同じ
+  }
+  EXPECT_EQ(apart.tripUpdates, count * 4);
+  EXPECT_GT(apart.lastMm, 0u);
+  EXPECT_LT(sizeof(TripCounters<64>) / 64 * 10, sizeof(Trip));
+}
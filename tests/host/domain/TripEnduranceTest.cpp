@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#include "domain/Trip.h"
+#include "support/RideReplay.h"
+#include "ui/Formatter.h"
+
+namespace {
+
+// 何週間も電源を入れたまま走り続ける状況を、仮想の時計で数秒のうちに再生する
+// millis() は 32 ビットで一周する値を渡し、真値は 64 ビットで別に数える
+class Endurance {
+public:
+  static constexpr double   CENTER_LAT = 35.681236;
+  static constexpr double   CENTER_LON = 139.767125;
+  static constexpr double   RADIUS_M   = 2000.0; // 周回コース
+  static constexpr uint32_t STEP_MS    = 2000;   // 0.5 Hz で測位する
+
+  Trip     trip;
+  uint64_t trueMovingMs  = 0;
+  uint64_t trueElapsedMs = 0;
+  double   trueDistanceM = 0.0;
+  uint32_t wraps         = 0;
+
+private:
+  uint32_t  millis;
+  uint64_t  virtualMs = 0;
+  double    angleRad  = 0.0;
+  double    lastLat   = 0.0;
+  double    lastLon   = 0.0;
+  SpNavData nav;
+
+public:
+  explicit Endurance(uint32_t startMillis) : millis(startMillis) {
+    memset(&nav, 0, sizeof(nav));
+    nav.posFixMode    = Fix3D;
+    nav.numSatellites = 12;
+    trip.begin();
+    sample(0.0f);
+    trip.update(nav, millis);
+  }
+
+  // 1 日のうち rideHours 時間は kmh で周回し、残りは止まっている
+  void run(int days, int rideHours, float kmh) {
+    const uint64_t endMs  = virtualMs + static_cast<uint64_t>(days) * 86400000;
+    const uint64_t rideMs = static_cast<uint64_t>(rideHours) * 3600000;
+    while (virtualMs < endMs) {
+      const bool isRiding = virtualMs % 86400000 < rideMs;
+      virtualMs += STEP_MS;
+      if (millis + STEP_MS < millis) wraps++;
+      millis += STEP_MS;
+      if (isRiding) angleRad += kmh / 3.6 * STEP_MS / 1000.0 / RADIUS_M;
+
+      sample(isRiding ? kmh : 0.0f);
+      trip.update(nav, millis);
+      trueElapsedMs += STEP_MS;
+      if (isRiding) trueMovingMs += STEP_MS;
+    }
+  }
+
+private:
+  void sample(float kmh) {
+    const double mPerDeg = RideReplay::EARTH_RADIUS_M * M_PI / 180.0;
+    const double lat     = CENTER_LAT + RADIUS_M * cos(angleRad) / mPerDeg;
+    const double lon =
+        CENTER_LON + RADIUS_M * sin(angleRad) / (mPerDeg * cos(CENTER_LAT * M_PI / 180.0));
+    if (0.0f < kmh) trueDistanceM += haversineM(lastLat, lastLon, lat, lon);
+    lastLat = lat;
+    lastLon = lon;
+
+    const uint64_t sec = virtualMs / 1000;
+    nav.latitude       = lat;
+    nav.longitude      = lon;
+    nav.velocity       = kmh / 3.6f;
+    nav.time.hour      = static_cast<int>(sec / 3600 % 24);
+    nav.time.minute    = static_cast<int>(sec / 60 % 60);
+    nav.time.sec       = static_cast<int>(sec % 60);
+    nav.time.usec      = static_cast<int>(virtualMs % 1000 * 1000);
+  }
+
+  static double haversineM(double lat1, double lon1, double lat2, double lon2) {
+    const double toRad = M_PI / 180.0;
+    const double dLat  = (lat2 - lat1) * toRad;
+    const double dLon  = (lon2 - lon1) * toRad;
+    const double a     = sin(dLat / 2) * sin(dLat / 2) +
+                     cos(lat1 * toRad) * cos(lat2 * toRad) * sin(dLon / 2) * sin(dLon / 2);
+    return 2.0 * RideReplay::EARTH_RADIUS_M * asin(sqrt(a));
+  }
+};
+
+} // namespace
+
+TEST(TripEnduranceTest, NineWeeksWithoutOverflowOrDrift) {
+  // 最初の 1 時間で millis() が一周し、49.7 日後にもう一度一周する
+  Endurance  endurance(UINT32_MAX - 3600000);
+  const auto t0 = std::chrono::steady_clock::now();
+  endurance.run(63, 20, 30.0f);
+  const auto t1 = std::chrono::steady_clock::now();
+  EXPECT_EQ(endurance.wraps, 2u);
+
+  // 時間は ms 単位で真値と一致する。どちらも 32 ビットなら 49.7 日で一周している
+  const Trip &trip = endurance.trip;
+  EXPECT_EQ(trip.stopwatch.getElapsedTimeMs(), endurance.trueElapsedMs);
+  EXPECT_EQ(trip.stopwatch.getMovingTimeMs(), endurance.trueMovingMs);
+  EXPECT_LT(static_cast<uint64_t>(UINT32_MAX), trip.stopwatch.getMovingTimeMs());
+  EXPECT_EQ(trip.speedHistogram.getTotalMs(), endurance.trueMovingMs);
+
+  const TripCounter lifetime = trip.getCounter(Trip::Counter::LIFETIME);
+  EXPECT_EQ(lifetime.movingTimeMs, endurance.trueMovingMs);
+  EXPECT_EQ(lifetime.elapsedTimeMs, endurance.trueElapsedMs);
+  EXPECT_EQ(lifetime.totalMm, trip.odometer.getTotalMm());
+
+  // 37,800 km を mm の整数で積算するので、距離と平均速度に誤差が溜まらない
+  const double distanceM = trip.odometer.getTotalMm() / 1000.0;
+  EXPECT_NEAR(distanceM, endurance.trueDistanceM, endurance.trueDistanceM * 1e-4);
+  EXPECT_NEAR(trip.speedometer.getAvg(), 30.0f, 0.03f);
+
+  char buffer[16];
+  Formatter::formatDuration(trip.stopwatch.getMovingTimeMs(), buffer, sizeof(buffer));
+  EXPECT_STREQ(buffer, "1260:00:00");
+  EXPECT_EQ(trip.getSummary().movingTimeMs, UINT32_MAX); // 履歴の形式では頭打ち
+
+  // 保存して読み戻しても 64 ビットのまま
+  Trip restored;
+  restored.begin();
+  restored.restore(trip.getTotals());
+  EXPECT_EQ(restored.stopwatch.getMovingTimeMs(), endurance.trueMovingMs);
+  EXPECT_EQ(restored.getCounter(Trip::Counter::LIFETIME).elapsedTimeMs, endurance.trueElapsedMs);
+
+  std::cout << "[ BENCH    ] endurance: 63 days (" << 63ULL * 86400000 / Endurance::STEP_MS
+            << " fixes) in " << std::chrono::duration<double>(t1 - t0).count()
+            << " s, distance " << distanceM / 1000.0 << " km (truth "
+            << endurance.trueDistanceM / 1000.0 << " km)" << std::endl;
+}
@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+#include "domain/Trip.h"
+#include "domain/UpdateRatePolicy.h"
+#include "hardware/Gnss.h"
+#include "support/RideReplay.h"
+
+TEST(UpdateRatePolicyTest, StartsAtOneHz) {
+  UpdateRatePolicy policy;
+  EXPECT_EQ(policy.update(0.0f, 0.0f, 0), 1000UL);
+}
+
+TEST(UpdateRatePolicyTest, RaisesImmediatelyWithSpeed) {
+  UpdateRatePolicy policy;
+  EXPECT_EQ(policy.update(10.0f, 0.0f, 0), 500UL);
+  EXPECT_EQ(policy.update(20.0f, 0.0f, 100), 200UL);
+  EXPECT_EQ(policy.update(40.0f, 0.0f, 200), 100UL);
+}
+
+TEST(UpdateRatePolicyTest, RaisesWhileAccelerating) {
+  UpdateRatePolicy policy;
+  EXPECT_EQ(policy.update(8.0f, 5.0f, 0), 100UL);
+}
+
+TEST(UpdateRatePolicyTest, LowersOnlyAfterHold) {
+  UpdateRatePolicy policy;
+  policy.update(40.0f, 0.0f, 0);
+
+  EXPECT_EQ(policy.update(0.0f, 0.0f, 1000), 100UL);
+  EXPECT_EQ(policy.update(0.0f, 0.0f, 1000 + Config::Gnss::RATE_DOWNSHIFT_HOLD_MS - 1), 100UL);
+  EXPECT_EQ(policy.update(0.0f, 0.0f, 1000 + Config::Gnss::RATE_DOWNSHIFT_HOLD_MS), 1000UL);
+}
+
+TEST(UpdateRatePolicyTest, HysteresisAroundThreshold) {
+  UpdateRatePolicy policy;
+  policy.update(Config::Gnss::RATE_MIN_KMH[3], 0.0f, 0);
+
+  const float justBelow = Config::Gnss::RATE_MIN_KMH[3] - Config::Gnss::RATE_HYSTERESIS_KMH / 2;
+  EXPECT_EQ(policy.update(justBelow, 0.0f, 10000), 100UL);
+  EXPECT_EQ(policy.update(justBelow, 0.0f, 20000), 100UL);
+}
+
+TEST(UpdateRatePolicyTest, GnssAppliesInterval) {
+  SpGnss::mockStartFailures = 0;
+  SpGnss::mockIsStarted     = false;
+  Gnss gnss;
+  ASSERT_TRUE(gnss.begin());
+  EXPECT_TRUE(gnss.setUpdateIntervalMs(200));
+  EXPECT_EQ(gnss.getUpdateIntervalMs(), 200UL);
+  EXPECT_EQ(SpGnss::mockInterval, SpInterval_5Hz);
+
+  EXPECT_TRUE(gnss.setUpdateIntervalMs(1000));
+  EXPECT_EQ(SpGnss::mockInterval, SpInterval_1Hz);
+}
+
+namespace {
+
+double replayDistanceKm(RideReplay &replay, unsigned long durationMs, bool isAdaptive) {
+  Trip             trip;
+  UpdateRatePolicy policy;
+  trip.begin();
+
+  replay.run(durationMs, 20, [&](const SpNavData &nav, unsigned long now, bool) {
+    trip.update(nav, now);
+    if (isAdaptive) {
+      const float speedKmh = trip.speedEstimator.get();
+      replay.setIntervalMs(policy.update(speedKmh, trip.speedEstimator.getAccel(), now));
+    }
+  });
+  return trip.odometer.getTotalDistance();
+}
+
+} // namespace
+
+TEST(UpdateRatePolicyTest, TripDistanceAtEveryRate) {
+  for (unsigned long intervalMs : Config::Gnss::UPDATE_INTERVALS_MS) {
+    RideReplay replay(RideProfiles::commute, 0.3f, 0.2f);
+    replay.setIntervalMs(intervalMs);
+    const double km = replayDistanceKm(replay, 600000, false);
+
+    std::cout << "[ REPLAY   ] " << 1000 / intervalMs << " Hz: " << km << " km (truth "
+              << replay.getTrueDistanceKm() << " km)" << std::endl;
+    EXPECT_NEAR(km, replay.getTrueDistanceKm(), replay.getTrueDistanceKm() * 0.02);
+  }
+}
+
+TEST(UpdateRatePolicyTest, TripDistanceWithAdaptiveRate) {
+  RideReplay replay(RideProfiles::commute, 0.3f, 0.2f);
+  const double km = replayDistanceKm(replay, 600000, true);
+
+  std::cout << "[ REPLAY   ] adaptive: " << km << " km (truth " << replay.getTrueDistanceKm()
+            << " km)" << std::endl;
+  EXPECT_NEAR(km, replay.getTrueDistanceKm(), replay.getTrueDistanceKm() * 0.02);
+}
@@ -0,0 +1,170 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "hardware/Gnss.h"
+
+namespace {
+
+struct Sink {
+  std::string text;
+
+  void print(const char *s) {
+    text += s;
+  }
+};
+
+constexpr uint32_t ALL_SYSTEMS = (1u << GPS) | (1u << GLONASS) | (1u << GALILEO) |
+                                 (1u << QZ_L1CA) | (1u << QZ_L1S);
+constexpr uint32_t LOW_POWER_SYSTEMS = (1u << GPS) | (1u << QZ_L1CA);
+
+class GnssTest : public ::testing::Test {
+protected:
+  Gnss gnss;
+
+  void SetUp() override {
+    _mock_millis              = 0;
+    SpGnss::mockFixMode       = FixInvalid;
+    SpGnss::mockSelected      = 0;
+    SpGnss::mockStartCount    = 0;
+    SpGnss::mockStartFailures = 0;
+    SpGnss::mockIsStarted     = false;
+  }
+
+  void runFor(unsigned long ms) {
+    for (unsigned long t = 0; t < ms; t += 1000) {
+      _mock_millis += 1000;
+      gnss.update();
+    }
+  }
+};
+
+} // namespace
+
+TEST_F(GnssTest, BeginSelectsAllConstellations) {
+  ASSERT_TRUE(gnss.begin());
+  EXPECT_EQ(SpGnss::mockSelected, ALL_SYSTEMS);
+  EXPECT_EQ(SpGnss::mockStartMode, COLD_START);
+  EXPECT_EQ(gnss.getProfile(), Gnss::Profile::MAX_ACCURACY);
+}
+
+TEST_F(GnssTest, RecordsColdTtff) {
+  gnss.begin();
+  runFor(30000);
+  SpGnss::mockFixMode = Fix3D;
+  runFor(1000);
+
+  const Gnss::ProfileStats &stats = gnss.getStats(Gnss::Profile::MAX_ACCURACY);
+  EXPECT_EQ(stats.coldTtffMs, 31000UL);
+  EXPECT_EQ(stats.epochs, 31UL);
+  EXPECT_EQ(stats.fix3dEpochs, 1UL);
+}
+
+TEST_F(GnssTest, DropsToLowPowerOnStableFixAndRecovers) {
+  gnss.begin();
+  SpGnss::mockFixMode = Fix3D;
+  runFor(Config::Gnss::STABLE_FIX_MS + 1000);
+  EXPECT_EQ(gnss.getProfile(), Gnss::Profile::LOW_POWER);
+  EXPECT_EQ(SpGnss::mockSelected, LOW_POWER_SYSTEMS);
+  EXPECT_EQ(SpGnss::mockStartMode, HOT_START);
+
+  runFor(2000);
+  EXPECT_EQ(gnss.getStats(Gnss::Profile::LOW_POWER).reacquired, 1UL);
+
+  SpGnss::mockFixMode = Fix2D;
+  runFor(Config::Gnss::FIX_LOST_MS + 1000);
+  EXPECT_EQ(gnss.getProfile(), Gnss::Profile::MAX_ACCURACY);
+  EXPECT_EQ(SpGnss::mockSelected, ALL_SYSTEMS);
+}
+
+TEST_F(GnssTest, ManualProfileStaysPut) {
+  gnss.begin();
+  ASSERT_TRUE(gnss.setProfile(Gnss::Profile::BALANCED, false));
+  EXPECT_EQ(SpGnss::mockSelected, (1u << GPS) | (1u << GLONASS) | (1u << QZ_L1CA));
+
+  SpGnss::mockFixMode = Fix3D;
+  runFor(Config::Gnss::STABLE_FIX_MS * 2);
+  EXPECT_EQ(gnss.getProfile(), Gnss::Profile::BALANCED);
+  EXPECT_EQ(SpGnss::mockStartCount, 2);
+}
+
+TEST_F(GnssTest, ChangesIntervalOnlyWhileStopped) {
+  gnss.setUpdateIntervalMs(200); // begin() の前は覚えておくだけ
+  EXPECT_EQ(SpGnss::mockStartCount, 0);
+  ASSERT_TRUE(gnss.begin());
+  EXPECT_EQ(SpGnss::mockInterval, SpInterval_5Hz);
+
+  // 受信中の setInterval() は受け付けられないので、止めて変えてから HOT_START で再開する
+  ASSERT_TRUE(gnss.setUpdateIntervalMs(1000));
+  EXPECT_EQ(SpGnss::mockInterval, SpInterval_1Hz);
+  EXPECT_EQ(SpGnss::mockStartMode, HOT_START);
+  EXPECT_TRUE(SpGnss::mockIsStarted);
+  EXPECT_EQ(gnss.getProfile(), Gnss::Profile::MAX_ACCURACY);
+  EXPECT_EQ(gnss.getStats(Gnss::Profile::MAX_ACCURACY).restarts, 0UL);
+
+  // 失敗したら元の間隔で受信を続け、同じ値で呼び直しても受信機には触れない
+  SpGnss::mockStartFailures = 1;
+  EXPECT_FALSE(gnss.setUpdateIntervalMs(100));
+  EXPECT_EQ(SpGnss::mockInterval, SpInterval_1Hz);
+  EXPECT_TRUE(SpGnss::mockIsStarted);
+  const int starts = SpGnss::mockStartCount;
+  EXPECT_FALSE(gnss.setUpdateIntervalMs(100));
+  EXPECT_EQ(SpGnss::mockStartCount, starts);
+  EXPECT_EQ(gnss.getUpdateIntervalMs(), 1000UL);
+
+  runFor(Config::Gnss::RETRY_MS);
+  EXPECT_EQ(SpGnss::mockInterval, SpInterval_10Hz);
+  EXPECT_EQ(gnss.getUpdateIntervalMs(), 100UL);
+  EXPECT_TRUE(gnss.setUpdateIntervalMs(100));
+}
+
+TEST_F(GnssTest, FailedSwitchKeepsReceivingAndRetries) {
+  gnss.begin();
+  SpGnss::mockFixMode       = Fix3D;
+  SpGnss::mockStartFailures = 1;
+  runFor(Config::Gnss::STABLE_FIX_MS + 1000);
+  // 切り替えられなければ元の組み合わせで受信を続ける
+  EXPECT_EQ(gnss.getProfile(), Gnss::Profile::MAX_ACCURACY);
+  EXPECT_EQ(SpGnss::mockSelected, ALL_SYSTEMS);
+  EXPECT_TRUE(SpGnss::mockIsStarted);
+  EXPECT_EQ(gnss.getStats(Gnss::Profile::LOW_POWER).restarts, 0UL);
+
+  runFor(Config::Gnss::RETRY_MS);
+  EXPECT_EQ(gnss.getProfile(), Gnss::Profile::LOW_POWER);
+  EXPECT_EQ(SpGnss::mockSelected, LOW_POWER_SYSTEMS);
+  EXPECT_EQ(gnss.getStats(Gnss::Profile::LOW_POWER).restarts, 1UL);
+}
+
+TEST_F(GnssTest, RestartsStoppedReceiverFromUpdate) {
+  gnss.begin();
+  SpGnss::mockFixMode       = Fix3D;
+  SpGnss::mockStartFailures = 2; // 新しい組み合わせも元の組み合わせも始められない
+  runFor(Config::Gnss::STABLE_FIX_MS + 1000);
+  EXPECT_FALSE(SpGnss::mockIsStarted);
+  EXPECT_EQ(gnss.getProfile(), Gnss::Profile::MAX_ACCURACY);
+
+  // 新しい測位が来なくても update() がやり直す
+  const unsigned long epochs = gnss.getStats(Gnss::Profile::MAX_ACCURACY).epochs;
+  runFor(Config::Gnss::RETRY_MS);
+  EXPECT_TRUE(SpGnss::mockIsStarted);
+  EXPECT_EQ(gnss.getProfile(), Gnss::Profile::LOW_POWER);
+  EXPECT_EQ(gnss.getStats(Gnss::Profile::MAX_ACCURACY).epochs, epochs);
+  EXPECT_EQ(gnss.getStats(Gnss::Profile::LOW_POWER).epochs, 1UL); // やり直した回から受信する
+}
+
+TEST_F(GnssTest, ReportsStatsPerProfile) {
+  gnss.begin();
+  runFor(29000);
+  SpGnss::mockFixMode = Fix3D;
+  runFor(Config::Gnss::STABLE_FIX_MS + 1000);
+  runFor(2000);
+
+  Sink sink;
+  gnss.report(sink);
+  EXPECT_EQ(sink.text.compare(0, 40, "GNSS MAX_ACCURACY ttff 30000 restarts 0 "), 0) << sink.text;
+  EXPECT_NE(sink.text.find("GNSS BALANCED ttff 0 restarts 0 reacquire 0 epochs 0 fix3d 0 sats 0\n"),
+            std::string::npos);
+  EXPECT_NE(sink.text.find("GNSS LOW_POWER* ttff 0 restarts 1 reacquire 1000 epochs 2 fix3d 100 "),
+            std::string::npos)
+      << sink.text;
+}
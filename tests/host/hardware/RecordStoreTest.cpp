@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+
+#include "hardware/RecordStore.h"
+
+namespace {
+
+struct Record {
+  uint32_t count = 0;
+  float    value = 0.0f;
+};
+
+class RecordStoreTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    FlashClass::mockReset();
+  }
+};
+
+} // namespace
+
+TEST_F(RecordStoreTest, LoadFailsWhenEmpty) {
+  RecordStore store("a.bin", "b.bin", 1);
+  Record      record;
+  EXPECT_FALSE(store.load(record));
+}
+
+TEST_F(RecordStoreTest, AlternatesSlotsAndLoadsNewest) {
+  RecordStore store("a.bin", "b.bin", 1);
+  for (uint32_t i = 1; i <= 3; i++) {
+    Record record;
+    record.count = i;
+    ASSERT_TRUE(store.save(record));
+  }
+  EXPECT_TRUE(Flash.exists("a.bin"));
+  EXPECT_TRUE(Flash.exists("b.bin"));
+
+  RecordStore reopened("a.bin", "b.bin", 1);
+  Record      record;
+  ASSERT_TRUE(reopened.load(record));
+  EXPECT_EQ(record.count, 3u);
+
+  record.count = 4; // 再起動後も古い方のスロットへ書く
+  ASSERT_TRUE(reopened.save(record));
+  ASSERT_TRUE(RecordStore("a.bin", "b.bin", 1).load(record));
+  EXPECT_EQ(record.count, 4u);
+}
+
+TEST_F(RecordStoreTest, TornWriteKeepsPreviousRecord) {
+  RecordStore store("a.bin", "b.bin", 1);
+  Record      record;
+  record.count = 1;
+  ASSERT_TRUE(store.save(record));
+  record.count = 2;
+  ASSERT_TRUE(store.save(record));
+
+  FlashClass::mockWriteBudget = 10; // ヘッダの途中で電源断
+  record.count                = 3;
+  EXPECT_FALSE(store.save(record));
+
+  ASSERT_TRUE(RecordStore("a.bin", "b.bin", 1).load(record));
+  EXPECT_EQ(record.count, 2u);
+}
+
+TEST_F(RecordStoreTest, RejectsCorruptionAndOtherVersions) {
+  RecordStore store("a.bin", "b.bin", 1);
+  Record      record;
+  record.count = 7;
+  ASSERT_TRUE(store.save(record));
+
+  EXPECT_FALSE(RecordStore("a.bin", "b.bin", 2).load(record));
+
+  FlashClass::mockFiles["a.bin"].back() ^= 0x01;
+  EXPECT_FALSE(RecordStore("a.bin", "b.bin", 1).load(record));
+}
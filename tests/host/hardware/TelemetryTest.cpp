@@ -0,0 +1,244 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "domain/Trip.h"
+#include "hardware/Telemetry.h"
+#include "support/RideReplay.h"
+#include "telemetry/TelemetryDecoder.h"
+
+namespace {
+
+// シリアルポートの代わり。送信 FIFO に積んだバイトを、ボーレートに応じた速さで回線へ送り出す
+class LoopbackPort {
+private:
+  const double         bytesPerMs;
+  const size_t         fifoBytes;
+  std::vector<uint8_t> fifo;
+  double               credit = 0.0;
+
+public:
+  std::vector<uint8_t> wire;
+
+  LoopbackPort(long baud, size_t fifoBytes)
+      : bytesPerMs(baud / 10.0 / 1000.0), fifoBytes(fifoBytes) {}
+
+  int availableForWrite() const {
+    return static_cast<int>(fifoBytes - fifo.size());
+  }
+
+  size_t write(const uint8_t *buffer, size_t size) {
+    if (fifoBytes - fifo.size() < size) size = fifoBytes - fifo.size();
+    fifo.insert(fifo.end(), buffer, buffer + size);
+    return size;
+  }
+
+  void advance(unsigned long ms) {
+    credit += bytesPerMs * ms;
+    size_t n = static_cast<size_t>(credit);
+    if (fifo.size() < n) n = fifo.size();
+    credit -= n;
+    if (fifo.empty()) credit = 0.0;
+    wire.insert(wire.end(), fifo.begin(), fifo.begin() + n);
+    fifo.erase(fifo.begin(), fifo.begin() + n);
+  }
+};
+
+struct Result {
+  unsigned long                  sent      = 0;
+  unsigned long                  dropped   = 0;
+  size_t                         maxQueued = 0;
+  std::vector<TelemetrySnapshot> received;
+  TelemetryDecoder::Stats        stats;
+  Trip                           trip;
+};
+
+void stream(LoopbackPort &port, unsigned long durationMs, Result &result) {
+  Clock      clock;
+  Telemetry  telemetry;
+  RideReplay ride(RideProfiles::commute);
+  ride.setIntervalMs(100);
+  result.trip.begin();
+
+  TelemetryDecoder decoder;
+  size_t           consumed = 0;
+  ride.run(durationMs, 10, [&](const SpNavData &nav, unsigned long now, bool) {
+    result.trip.update(nav, now);
+    clock.update(nav);
+    telemetry.update(result.trip, clock, nav, now);
+    telemetry.pump(port);
+    result.maxQueued = std::max(result.maxQueued, telemetry.getQueuedBytes());
+    port.advance(10);
+
+    for (; consumed < port.wire.size(); consumed++) {
+      TelemetrySnapshot snapshot;
+      if (decoder.feed(port.wire[consumed], snapshot)) result.received.push_back(snapshot);
+    }
+  });
+  result.sent    = durationMs / Config::Telemetry::INTERVAL_MS;
+  result.dropped = telemetry.getDropped();
+  result.stats   = decoder.getStats();
+}
+
+std::vector<uint8_t> frameOf(const TelemetrySnapshot &snapshot) {
+  uint8_t      frame[Telemetry::FRAME];
+  const size_t length = Telemetry::encode(snapshot, frame);
+  return std::vector<uint8_t>(frame, frame + length);
+}
+
+} // namespace
+
+TEST(TelemetryTest, CobsRoundTrips) {
+  std::mt19937                      rng(7);
+  std::vector<std::vector<uint8_t>> inputs = {{}, {0}, {0, 0}, {1, 0, 2}};
+  for (size_t run : {253, 254, 255, 600}) inputs.push_back(std::vector<uint8_t>(run, 0x55));
+  for (int i = 0; i < 200; i++) {
+    std::vector<uint8_t> data(rng() % 700);
+    for (uint8_t &b : data) b = rng() % 4 == 0 ? 0 : static_cast<uint8_t>(rng());
+    inputs.push_back(data);
+  }
+
+  for (const std::vector<uint8_t> &data : inputs) {
+    std::vector<uint8_t> encoded(Cobs::maxEncodedSize(data.size()));
+    const size_t         size = Cobs::encode(data.data(), data.size(), encoded.data());
+    ASSERT_LE(size, encoded.size());
+    for (size_t i = 0; i < size; i++) ASSERT_NE(encoded[i], 0);
+
+    std::vector<uint8_t> decoded(data.size() + 1);
+    size_t               length = 0;
+    ASSERT_TRUE(Cobs::decode(encoded.data(), size, decoded.data(), decoded.size(), length));
+    decoded.resize(length);
+    EXPECT_EQ(decoded, data);
+  }
+
+  const uint8_t broken[] = {0x05, 0x11, 0x22}; // 続くはずのバイトが足りない
+  uint8_t       out[8];
+  size_t        length = 0;
+  EXPECT_FALSE(Cobs::decode(broken, sizeof(broken), out, sizeof(out), length));
+}
+
+TEST(TelemetryTest, CaptureSaturatesLongTimes) {
+  Trip         trip;
+  Trip::Totals totals;
+  totals.movingTimeMs  = 60ULL * 86400000; // 60 日
+  totals.elapsedTimeMs = UINT32_MAX + 1000ULL;
+  trip.begin();
+  trip.restore(totals);
+
+  SpNavData navData;
+  memset(&navData, 0, sizeof(navData));
+  const TelemetrySnapshot snapshot = Telemetry::capture(trip, Clock(), navData, 0);
+  EXPECT_EQ(snapshot.movingTimeMs, UINT32_MAX);
+  EXPECT_EQ(snapshot.elapsedTimeMs, UINT32_MAX);
+
+  totals.movingTimeMs = UINT32_MAX - 1;
+  trip.restore(totals);
+  EXPECT_EQ(Telemetry::capture(trip, Clock(), navData, 0).movingTimeMs, UINT32_MAX - 1);
+}
+
+TEST(TelemetryTest, QueueDropsWholeFramesAndWraps) {
+  TxQueue<16>   queue;
+  LoopbackPort  port(115200, 5);
+  const uint8_t frame[6] = {1, 2, 3, 4, 5, 0};
+
+  EXPECT_TRUE(queue.push(frame, 6));
+  EXPECT_TRUE(queue.push(frame, 6));
+  EXPECT_FALSE(queue.push(frame, 6)); // 途中まで積むことはしない
+  EXPECT_EQ(queue.getSize(), 12u);
+  EXPECT_EQ(queue.getDropped(), 1u);
+
+  EXPECT_EQ(queue.pump(port), 5u); // FIFO の空きを超えて書かない
+  EXPECT_EQ(queue.pump(port), 0u);
+  port.advance(10);
+  EXPECT_EQ(queue.pump(port), 5u);
+  EXPECT_TRUE(queue.push(frame, 6)); // 末尾を折り返して積む
+  for (int i = 0; i < 4; i++) {
+    port.advance(10);
+    queue.pump(port);
+  }
+  port.advance(10);
+  EXPECT_EQ(queue.getSize(), 0u);
+
+  const std::vector<uint8_t> expected = {1, 2, 3, 4, 5, 0, 1, 2, 3, 4, 5, 0, 1, 2, 3, 4, 5, 0};
+  EXPECT_EQ(port.wire, expected);
+}
+
+TEST(TelemetryTest, LoopbackDeliversEveryFrame) {
+  LoopbackPort port(115200, 64);
+  Result       result;
+  stream(port, 10 * 60 * 1000, result);
+
+  EXPECT_EQ(result.dropped, 0u);
+  EXPECT_EQ(result.stats.corrupted, 0u);
+  EXPECT_EQ(result.stats.lost, 0u);
+  EXPECT_GE(result.received.size() + 1, result.sent);
+  for (size_t i = 0; i < result.received.size(); i++) {
+    ASSERT_EQ(result.received[i].sequence, static_cast<uint16_t>(i));
+  }
+
+  const TelemetrySnapshot &last = result.received.back();
+  EXPECT_NEAR(last.distanceM, result.trip.odometer.getTotalMm() / 1000.0, 10.0);
+  EXPECT_NEAR(last.maxCentiKmh / 100.0, result.trip.speedometer.getMax(), 0.01);
+  EXPECT_NE(last.epoch, 0u);
+  EXPECT_EQ(last.fixMode, Fix3D);
+
+  const TelemetrySnapshot snapshot = last;
+  uint8_t                 frame[Telemetry::FRAME];
+  const int               count = 100000;
+  const auto              t0    = std::chrono::steady_clock::now();
+  for (int i = 0; i < count; i++) Telemetry::encode(snapshot, frame);
+  const auto t1 = std::chrono::steady_clock::now();
+  std::cout << "[ BENCH    ] telemetry: " << port.wire.size() * 1000.0 / (10 * 60 * 1000)
+            << " B/s on the wire, encode "
+            << std::chrono::duration<double, std::nano>(t1 - t0).count() / count << " ns/frame ("
+            << Telemetry::encode(snapshot, frame) << " bytes)" << std::endl;
+}
+
+TEST(TelemetryTest, SlowLinkDropsInsteadOfStalling) {
+  LoopbackPort port(1200, 16); // 120 B/s では 5 Hz のフレームを送りきれない
+  Result       result;
+  stream(port, 60 * 1000, result);
+
+  EXPECT_GT(result.dropped, 0u);
+  EXPECT_LE(result.maxQueued, Config::Telemetry::QUEUE_BYTES);
+  EXPECT_EQ(result.stats.corrupted, 0u);
+  EXPECT_GT(result.received.size(), 0u);
+  // 捨てたフレームは sequence の欠けとして受信側に見える
+  EXPECT_EQ(result.stats.frames + result.stats.lost, result.received.back().sequence + 1u);
+  std::cout << "[ BENCH    ] 1200 baud: " << result.received.size() << " of " << result.sent
+            << " frames delivered, " << result.dropped << " dropped" << std::endl;
+}
+
+TEST(TelemetryTest, DecoderResyncsAfterNoise) {
+  TelemetrySnapshot snapshot;
+  snapshot.distanceM = 1234;
+
+  std::vector<uint8_t> bytes = {'T', 'R', 'A', 'C', 'E', '1', '\n'}; // 途中から受信した分
+  for (uint16_t i = 0; i < 3; i++) {
+    snapshot.sequence                = i;
+    const std::vector<uint8_t> frame = frameOf(snapshot);
+    bytes.insert(bytes.end(), frame.begin(), frame.end());
+  }
+  bytes[7 + 50 + 10] ^= 0x04; // 2 つ目のフレームを壊す
+  snapshot.sequence = 4;
+  const std::vector<uint8_t> last = frameOf(snapshot);
+  bytes.insert(bytes.end(), last.begin(), last.end());
+
+  TelemetryDecoder               decoder;
+  std::vector<TelemetrySnapshot> received;
+  for (uint8_t byte : bytes) {
+    TelemetrySnapshot out;
+    if (decoder.feed(byte, out)) received.push_back(out);
+  }
+
+  // 先頭の文字列は最初のフレームとまとめて 1 つの区切りになり、どちらも捨てる
+  ASSERT_EQ(received.size(), 2u);
+  EXPECT_EQ(received[0].sequence, 2);
+  EXPECT_EQ(received[0].distanceM, 1234u);
+  EXPECT_EQ(received[1].sequence, 4);
+  EXPECT_EQ(decoder.getStats().corrupted, 2u);
+  EXPECT_EQ(decoder.getStats().lost, 1u);
+}
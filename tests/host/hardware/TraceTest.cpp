@@ -0,0 +1,171 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <sstream>
+#include <string>
+
+#include "App.h"
+#include "hardware/Trace.h"
+#include "telemetry/TelemetryDecoder.h"
+#include "trace/TraceDecoder.h"
+
+namespace {
+
+struct Sink {
+  std::string text;
+
+  void print(const char *s) {
+    text += s;
+  }
+};
+
+TraceDecoder decode(const std::string &log) {
+  std::istringstream in(log);
+  TraceDecoder       decoder;
+  EXPECT_TRUE(decoder.parse(in));
+  return decoder;
+}
+
+} // namespace
+
+TEST(TraceTest, KeepsNewestRecords) {
+  TraceBuffer<8> buffer;
+  EXPECT_EQ(buffer.getCount(), 0u);
+  for (uint16_t i = 0; i < 20; i++) buffer.emit(i, TraceEvent::GNSS_FIX, 'i', i);
+
+  ASSERT_EQ(buffer.getCount(), 8u);
+  EXPECT_EQ(buffer.getDropped(), 12u);
+  for (size_t i = 0; i < 8; i++) EXPECT_EQ(buffer.at(i).arg, 12 + i);
+
+  buffer.clear();
+  EXPECT_EQ(buffer.getCount(), 0u);
+  EXPECT_EQ(buffer.getDropped(), 0u);
+}
+
+TEST(TraceTest, DecodesDumpIntoChromeTrace) {
+  TraceBuffer<8> buffer;
+  buffer.emit(0xFFFFFF00, TraceEvent::RENDER, 'B', 0); // 途中でカウンタが一周する
+  buffer.emit(0xFFFFFFC0, TraceEvent::RENDER_DISPLAY, 'B', 0);
+  buffer.emit(0x00000040, TraceEvent::RENDER_DISPLAY, 'E', 0);
+  buffer.emit(0x00000100, TraceEvent::RENDER, 'E', 0);
+  buffer.emit(0x00000180, TraceEvent::INPUT_EVENT, 'i', 3);
+
+  Sink sink;
+  sink.text = "boot log\r\n\x05\x01\x02"; // ダンプ以外の行や、見出しの前のバイナリは読み飛ばす
+  buffer.dump(sink, 32);
+  const TraceDecoder decoder = decode(sink.text);
+
+  const std::vector<TraceDecoder::Event> &events = decoder.getEvents();
+  ASSERT_EQ(events.size(), 5u);
+  EXPECT_DOUBLE_EQ(events[0].us, 0.0);
+  EXPECT_DOUBLE_EQ(events[2].us, 0x140 / 32.0);
+  EXPECT_DOUBLE_EQ(events[4].us, 0x280 / 32.0);
+  EXPECT_EQ(events[4].arg, 3);
+
+  const std::string json = decoder.toJson();
+  EXPECT_NE(json.find("{\"name\":\"RENDER_DISPLAY\",\"ph\":\"E\",\"ts\":10.000"),
+            std::string::npos);
+  EXPECT_NE(json.find("\"name\":\"INPUT_EVENT\",\"ph\":\"i\",\"ts\":20.000,\"pid\":1,\"tid\":1,"
+                      "\"s\":\"t\",\"args\":{\"arg\":3}"),
+            std::string::npos);
+}
+
+TEST(TraceTest, DropsEndsWhoseBeginWasOverwritten) {
+  TraceBuffer<4> buffer;
+  buffer.emit(0, TraceEvent::APP_UPDATE, 'B', 0);
+  buffer.emit(1, TraceEvent::RENDER, 'B', 0);
+  buffer.emit(2, TraceEvent::RENDER, 'E', 0);
+  buffer.emit(3, TraceEvent::APP_UPDATE, 'E', 0);
+  buffer.emit(4, TraceEvent::APP_UPDATE, 'B', 0);
+  buffer.emit(5, TraceEvent::APP_UPDATE, 'E', 0);
+
+  Sink sink;
+  buffer.dump(sink, 1);
+  const TraceDecoder decoder = decode(sink.text);
+  EXPECT_EQ(decoder.getDropped(), 2u);
+  ASSERT_EQ(decoder.getEvents().size(), 2u); // RENDER と最初の APP_UPDATE の終了は開始がない
+  EXPECT_EQ(decoder.getEvents()[0].phase, 'B');
+
+  std::istringstream truncated(sink.text.substr(0, sink.text.size() - 4));
+  TraceDecoder       partial;
+  EXPECT_FALSE(partial.parse(truncated));
+}
+
+TEST(TraceTest, AppDumpsStagesOverSerial) {
+  FlashClass::mockReset();
+  Trace::buffer().clear();
+  App app;
+  app.begin();
+  for (int i = 0; i < 20; i++) {
+    _mock_millis += 50;
+    app.update();
+  }
+
+  Sink sink;
+  Trace::dump(sink);
+  const TraceDecoder decoder = decode(sink.text);
+
+  bool seen[static_cast<int>(TraceEvent::Count)] = {};
+  for (const TraceDecoder::Event &event : decoder.getEvents()) seen[event.event] = true;
+  EXPECT_TRUE(seen[static_cast<int>(TraceEvent::APP_UPDATE)]);
+  EXPECT_TRUE(seen[static_cast<int>(TraceEvent::APP_TRIP)]);
+  EXPECT_TRUE(seen[static_cast<int>(TraceEvent::APP_RENDER)]);
+  EXPECT_TRUE(seen[static_cast<int>(TraceEvent::GNSS_UPDATE)]);
+  EXPECT_TRUE(seen[static_cast<int>(TraceEvent::INPUT_UPDATE)]);
+  EXPECT_TRUE(seen[static_cast<int>(TraceEvent::RENDER)]);
+
+  Serial.mockInput = "xt"; // 't' でダンプする
+  testing::internal::CaptureStdout();
+  app.update();
+  const std::string output = testing::internal::GetCapturedStdout();
+  EXPECT_EQ(output.compare(0, 8, "\nTRACE1 "), 0);
+  EXPECT_TRUE(Serial.mockInput.empty());
+}
+
+TEST(TraceTest, AppDumpsBetweenTelemetryFrames) {
+  FlashClass::mockReset();
+  Trace::buffer().clear();
+  App app;
+  app.begin();
+  for (int i = 0; i < 20; i++) {
+    _mock_millis += 50;
+    app.update();
+  }
+
+  // フレームを 20 バイトだけ送ったところでダンプを頼み、その後も流し続ける
+  Serial.mockEchoWrites = true;
+  testing::internal::CaptureStdout();
+  Serial.mockWriteRoom = 20;
+  _mock_millis += Config::Telemetry::INTERVAL_MS;
+  app.update();
+  Serial.mockWriteRoom = 1 << 16;
+  Serial.mockInput     = "t";
+  app.update();
+  _mock_millis += Config::Telemetry::INTERVAL_MS;
+  app.update();
+  const std::string output = testing::internal::GetCapturedStdout();
+  Serial.mockEchoWrites = false;
+
+  decode(output);
+
+  TelemetryDecoder  telemetry;
+  TelemetrySnapshot snapshot;
+  for (const char c : output) telemetry.feed(static_cast<uint8_t>(c), snapshot);
+  EXPECT_EQ(telemetry.getStats().frames, 2u);
+  EXPECT_EQ(telemetry.getStats().corrupted, 1u); // ダンプの文字だけ
+  EXPECT_EQ(telemetry.getStats().lost, 0u);
+}
+
+TEST(TraceTest, EmitOverhead) {
+  TraceBuffer<Config::Trace::CAPACITY> buffer;
+  const int                            count = 1000000;
+
+  const auto t0 = std::chrono::steady_clock::now();
+  for (int i = 0; i < count; i++) buffer.emit(i, TraceEvent::RENDER, 'B', 0);
+  const auto t1 = std::chrono::steady_clock::now();
+
+  std::cout << "[ BENCH    ] trace emit: "
+            << std::chrono::duration<double, std::nano>(t1 - t0).count() / count << " ns/event, "
+            << sizeof(buffer) << " bytes" << std::endl;
+  EXPECT_EQ(buffer.getDropped(), count - Config::Trace::CAPACITY);
+}
@@ -0,0 +1,200 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "domain/Clock.h"
+#include "hardware/TripHistory.h"
+
+namespace {
+
+const char *DATA = "history.dat";
+const char *KEYS = "history.key";
+
+RideSummary makeRide(uint32_t startEpoch, uint32_t distanceM) {
+  RideSummary ride;
+  ride.startEpoch   = startEpoch;
+  ride.distanceM    = distanceM;
+  ride.movingTimeMs = distanceM * 200; // 18 km/h
+  ride.avgKmh       = 18.0f;
+  return ride;
+}
+
+// Flash をホストの一時ディレクトリに置き、mockFiles を消すと再起動後の読み直しになる
+class TripHistoryTest : public ::testing::Test {
+protected:
+  std::string root;
+
+  void SetUp() override {
+    FlashClass::mockReset();
+    char dir[] = "/tmp/trip_history_XXXXXX";
+    ASSERT_NE(mkdtemp(dir), nullptr);
+    root                 = dir;
+    FlashClass::mockRoot = root;
+  }
+
+  void TearDown() override {
+    Flash.remove(DATA);
+    Flash.remove(KEYS);
+    rmdir(root.c_str());
+    FlashClass::mockReset();
+  }
+
+  static void reboot() {
+    FlashClass::mockFiles.clear();
+  }
+};
+
+} // namespace
+
+TEST_F(TripHistoryTest, KeepsThousandsOfRidesAcrossReboot) {
+  TripHistory history(DATA, KEYS);
+  ASSERT_TRUE(history.begin());
+  EXPECT_EQ(history.getCount(), 0u);
+  RideSummary ride;
+  EXPECT_FALSE(history.getRecent(0, ride));
+
+  const uint32_t count = 5000;
+  for (uint32_t i = 0; i < count; i++) ASSERT_TRUE(history.append(makeRide(1000 + i * 3600, i)));
+
+  reboot();
+  TripHistory reopened(DATA, KEYS);
+  ASSERT_TRUE(reopened.begin());
+  ASSERT_EQ(reopened.getCount(), count);
+  ASSERT_TRUE(reopened.getRecent(0, ride));
+  EXPECT_EQ(ride.distanceM, count - 1);
+  ASSERT_TRUE(reopened.getRecent(count - 1, ride));
+  EXPECT_EQ(ride.distanceM, 0u);
+  EXPECT_FALSE(reopened.getRecent(count, ride));
+
+  // 件数によらず 1 回の seek と read で取り出せる
+  const auto t0 = std::chrono::steady_clock::now();
+  for (uint32_t n = 0; n < count; n++) ASSERT_TRUE(reopened.getRecent(n, ride));
+  const auto t1 = std::chrono::steady_clock::now();
+  std::cout << "[ BENCH    ] getRecent: "
+            << std::chrono::duration<double, std::nano>(t1 - t0).count() / count << " ns/ride"
+            << std::endl;
+
+  ASSERT_TRUE(reopened.append(makeRide(1000 + count * 3600, count)));
+  ASSERT_TRUE(reopened.getRecent(0, ride));
+  EXPECT_EQ(ride.distanceM, count);
+}
+
+TEST_F(TripHistoryTest, FindsDateRangesLikeBruteForce) {
+  TripHistory history(DATA, KEYS);
+  ASSERT_TRUE(history.begin());
+
+  std::mt19937          rng(42);
+  std::vector<uint32_t> epochs;
+  uint32_t              epoch = 789004800; // 2025-01-01
+  for (uint32_t i = 0; i < 3000; i++) {
+    epoch += rng() % 3 == 0 ? 0 : rng() % (3 * 86400); // 同じ時刻の記録も混ぜる
+    epochs.push_back(epoch);
+    ASSERT_TRUE(history.append(makeRide(epoch, i)));
+  }
+
+  reboot();
+  TripHistory reopened(DATA, KEYS);
+  ASSERT_TRUE(reopened.begin());
+  for (int q = 0; q < 500; q++) {
+    uint32_t from = epochs.front() + rng() % (epochs.back() - epochs.front() + 86400);
+    uint32_t to   = from + rng() % (30 * 86400);
+    if (q % 10 == 0) to = from; // 空の範囲
+
+    uint32_t expectedFirst = 0;
+    while (expectedFirst < epochs.size() && epochs[expectedFirst] < from) expectedFirst++;
+    uint32_t expectedLast = expectedFirst;
+    while (expectedLast < epochs.size() && epochs[expectedLast] < to) expectedLast++;
+
+    uint32_t first = 0;
+    uint32_t last  = 0;
+    reopened.findRange(from, to, first, last);
+    ASSERT_EQ(first, expectedFirst) << "query " << q;
+    ASSERT_EQ(last, expectedLast) << "query " << q;
+  }
+}
+
+TEST_F(TripHistoryTest, UnknownStartTimeKeepsIndexSorted) {
+  TripHistory history(DATA, KEYS);
+  ASSERT_TRUE(history.begin());
+  ASSERT_TRUE(history.append(makeRide(789004800, 1)));
+  ASSERT_TRUE(history.append(makeRide(0, 2))); // 測位前に終えた走行
+  ASSERT_TRUE(history.append(makeRide(789091200, 3)));
+
+  uint32_t first = 0;
+  uint32_t last  = 0;
+  history.findRange(789004800, 789091200, first, last);
+  EXPECT_EQ(first, 0u);
+  EXPECT_EQ(last, 2u);
+}
+
+TEST_F(TripHistoryTest, RepairsTornAppends) {
+  TripHistory history(DATA, KEYS);
+  ASSERT_TRUE(history.begin());
+  for (uint32_t i = 0; i < 10; i++) ASSERT_TRUE(history.append(makeRide(1000 + i, i)));
+
+  FlashClass::mockWriteBudget = 10; // 記録の途中で電源断
+  EXPECT_FALSE(history.append(makeRide(2000, 10)));
+  FlashClass::mockWriteBudget = -1;
+
+  reboot();
+  TripHistory restarted(DATA, KEYS);
+  ASSERT_TRUE(restarted.begin());
+  ASSERT_EQ(restarted.getCount(), 11u);
+  RideSummary ride;
+  EXPECT_FALSE(restarted.get(10, ride)); // 埋めた 1 件は壊れた記録として読めない
+
+  FlashClass::mockWriteBudget = sizeof(RideSummary) + 2; // 索引の途中で電源断
+  EXPECT_FALSE(restarted.append(makeRide(3000, 11)));
+  EXPECT_FALSE(restarted.append(makeRide(3001, 99))); // 索引が揃うまでは追記しない
+  FlashClass::mockWriteBudget = -1;
+
+  reboot();
+  TripHistory reopened(DATA, KEYS);
+  ASSERT_TRUE(reopened.begin());
+  ASSERT_EQ(reopened.getCount(), 12u);
+  EXPECT_EQ(FlashClass::mockFiles[KEYS].size(), 12 * sizeof(uint32_t));
+
+  ASSERT_TRUE(reopened.getRecent(0, ride));
+  EXPECT_EQ(ride.distanceM, 11u);
+  ASSERT_TRUE(reopened.getRecent(2, ride));
+  EXPECT_EQ(ride.distanceM, 9u);
+
+  ASSERT_TRUE(reopened.append(makeRide(4000, 12)));
+  uint32_t first = 0;
+  uint32_t last  = 0;
+  reopened.findRange(2000, 4001, first, last);
+  EXPECT_EQ(first, 11u);
+  EXPECT_EQ(last, 13u);
+}
+
+TEST_F(TripHistoryTest, RefusesAppendWhenFull) {
+  TripHistory history(DATA, KEYS);
+  ASSERT_TRUE(history.begin());
+  FlashClass::mockFiles[DATA].resize(Config::History::CAPACITY * sizeof(RideSummary));
+  ASSERT_TRUE(history.begin());
+  EXPECT_EQ(history.getCount(), Config::History::CAPACITY);
+  EXPECT_FALSE(history.append(makeRide(1000, 1)));
+}
+
+TEST(ClockTest, EpochRoundTripsToLocalDate) {
+  SpNavData nav = {};
+  nav.time      = {2025, 2, 28, 16, 30, 0, 0}; // 日本時間では 3/1 01:30
+
+  Clock clock;
+  clock.update(nav);
+  EXPECT_EQ(clock.getEpoch(), 789004800u + 58 * 86400u + 16 * 3600u + 30 * 60u);
+
+  const Clock::Date date = clock.getLocalDate(clock.getEpoch());
+  EXPECT_EQ(date.year, 2025);
+  EXPECT_EQ(date.month, 3);
+  EXPECT_EQ(date.day, 1);
+
+  nav.time.year = 2024; // 時刻が確定していない
+  clock.update(nav);
+  EXPECT_EQ(clock.getEpoch(), 0u);
+}
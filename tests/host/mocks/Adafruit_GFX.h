@@ -13,4 +13,15 @@ public:
   virtual void drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
   virtual void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
   virtual void drawCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color);
+  void drawBitmap(int16_t x, int16_t y, const uint8_t bitmap[], int16_t w, int16_t h,
+                  uint16_t color);
+
+  // 描画コストの計測用
+  static unsigned long mockDrawCalls;    // 図形・文字・画像の描画呼び出し回数
+  static unsigned long mockBitmapPixels; // drawBitmap で走査した画素数
+
+  static void mockResetCounters() {
+    mockDrawCalls    = 0;
+    mockBitmapPixels = 0;
+  }
 };
@@ -6,12 +6,21 @@
 #include "Wire.h"
 
 #define SSD1306_SWITCHCAPVCC 0
+#define SSD1306_BLACK 0
 #define SSD1306_WHITE 1
+#define BLACK SSD1306_BLACK
+#define WHITE SSD1306_WHITE
 
 class Adafruit_SSD1306 : public Adafruit_GFX {
 public:
   Adafruit_SSD1306(int16_t w, int16_t h, TwoWire *twi = &Wire, int8_t rst_pin = -1);
 
+private:
+  int16_t width;
+  int16_t height;
+
+public:
+
   bool begin(uint8_t switchvcc = SSD1306_SWITCHCAPVCC, uint8_t i2caddr = 0, bool reset = true, bool periphBegin = true);
   void display();
   void clearDisplay();
@@ -27,5 +36,10 @@ public:
   void println(const String &s);
   void println(const char *s);
 
+  static unsigned long mockDisplayCount;
+  static unsigned long mockI2cBytes;    // display() が I2C で送るバイト数 (アドレスを含む)
+  static unsigned long mockBeginMs;     // begin() にかかる時間
+  static unsigned long mockBoundsCalls; // getTextBounds() の回数。実機では 1 文字ずつ寸法を求める
+
   void getTextBounds(const String &str, int16_t x, int16_t y, int16_t *x1, int16_t *y1, uint16_t *w, uint16_t *h);
 };
@@ -9,6 +9,8 @@
 #include <cstdio>
 #include <cstring>
 #include <iostream>
+#include <string>
+#include <vector>
 
 // Mock basic types
 using std::abs;
@@ -22,6 +24,8 @@ inline long map(long x, long in_min, long in_max, long out_min, long out_max) {
 
 typedef uint8_t byte;
 
+#define PI 3.1415926535897932384626433832795
+
 // dtostrf mock
 inline char *dtostrf(double val, signed char width, unsigned char prec, char *s) {
   char fmt[20];
@@ -73,11 +77,32 @@ inline void delay(unsigned long ms) {
 #define LSBFIRST 0
 #define MSBFIRST 1
 
+// 送ったバイトを順に残す
+extern std::vector<uint8_t> _mock_shift_bytes;
+
 inline void shiftOut(uint8_t dataPin, uint8_t clockPin, uint8_t bitOrder, uint8_t val) {
   (void)dataPin;
   (void)clockPin;
   (void)bitOrder;
-  (void)val;
+  _mock_shift_bytes.push_back(val);
+}
+
+// Timer interrupt mocks (Spresense: 戻り値が次の割り込みまでの us。0 で止まる)
+extern unsigned int (*_mock_timer_isr)();
+extern unsigned int _mock_timer_us;
+
+inline void attachTimerInterrupt(unsigned int (*isr)(), unsigned int us) {
+  _mock_timer_isr = isr;
+  _mock_timer_us  = us;
+}
+
+inline void detachTimerInterrupt() {
+  _mock_timer_isr = nullptr;
+}
+
+// 登録された割り込みを 1 回呼ぶ
+inline void fireTimerInterrupt() {
+  if (_mock_timer_isr) _mock_timer_us = _mock_timer_isr();
 }
 
 #include <map>
@@ -108,7 +133,31 @@ inline void setPinState(int pin, int state) {
 // Serial Mock
 class SerialMock {
 public:
-  void begin(int baud) {}
+  std::string   mockInput;                // read() で返す受信データ
+  int           mockWriteRoom    = 1 << 16; // availableForWrite() の値
+  unsigned long mockWrittenBytes = 0;
+  bool          mockEchoWrites   = false; // write() のバイト列も stdout に書く
+
+  void begin(long baud) {
+    (void)baud;
+  }
+  int available() {
+    return static_cast<int>(mockInput.size());
+  }
+  int read() {
+    if (mockInput.empty()) return -1;
+    const int c = static_cast<unsigned char>(mockInput[0]);
+    mockInput.erase(0, 1);
+    return c;
+  }
+  int availableForWrite() {
+    return mockWriteRoom;
+  }
+  size_t write(const uint8_t *buffer, size_t size) {
+    if (mockEchoWrites) std::cout.write(reinterpret_cast<const char *>(buffer), size);
+    mockWrittenBytes += size;
+    return size;
+  }
   void print(const char *s) {
     std::cout << s;
   }
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#define FILE_READ 0x01
+#define FILE_WRITE 0x02
+
+class File {
+private:
+  std::vector<uint8_t> *data     = nullptr;
+  size_t                offset   = 0;
+  bool                  writable = false;
+  std::string           path; // Flash 内のパス (ホストのファイルへ書き写すときに使う)
+
+public:
+  File() = default;
+  File(std::vector<uint8_t> *data, bool writable, const std::string &path = "")
+      : data(data), offset(writable ? data->size() : 0), writable(writable), path(path) {}
+
+  size_t write(const uint8_t *buf, size_t size);
+
+  int read(void *buf, size_t nbyte) {
+    if (!data) return -1;
+    const size_t n = offset + nbyte <= data->size() ? nbyte : data->size() - offset;
+    if (0 < n) memcpy(buf, data->data() + offset, n);
+    offset += n;
+    return static_cast<int>(n);
+  }
+
+  bool seek(uint32_t pos) {
+    if (!data || data->size() < pos) return false;
+    offset = pos;
+    return true;
+  }
+
+  uint32_t position() const {
+    return static_cast<uint32_t>(offset);
+  }
+
+  uint32_t size() const {
+    return data ? static_cast<uint32_t>(data->size()) : 0;
+  }
+
+  void close() {
+    data = nullptr;
+  }
+
+  operator bool() const {
+    return data != nullptr;
+  }
+};
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "File.h"
+
+class FlashClass {
+public:
+  File open(const char *path, uint8_t mode = FILE_READ);
+  bool exists(const char *path);
+  bool remove(const char *path);
+
+  // Mock control
+  static std::map<std::string, std::vector<uint8_t>> mockFiles;
+  static long mockWriteBudget; // 書き込めるバイト数。負なら無制限 (途中の電源断を再現する)
+  // 空でなければ、このディレクトリのファイルを Flash として使う。mockFiles はその読み込み済みの写し
+  // mockFiles だけを消すと、再起動後に Flash を読み直す状況を再現できる
+  static std::string mockRoot;
+  static unsigned long mockOpenMs; // open() 1 回にかかる時間
+
+  static void mockReset() {
+    mockFiles.clear();
+    mockWriteBudget = -1;
+    mockRoot.clear();
+    mockOpenMs = 0;
+  }
+
+  static std::string mockHostPath(const std::string &path) {
+    return mockRoot + "/" + path;
+  }
+
+  // mockRoot のファイルを mockFiles に読み込む。なければ false
+  static bool mockLoad(const std::string &path);
+};
+
+extern FlashClass Flash;
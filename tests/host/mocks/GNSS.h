@@ -11,6 +11,17 @@
 #define COLD_START 0
 #define HOT_START 1
 
+enum SpInterval {
+  SpInterval_1Hz  = 1000,
+  SpInterval_2Hz  = 500,
+  SpInterval_4Hz  = 250,
+  SpInterval_5Hz  = 200,
+  SpInterval_8Hz  = 125,
+  SpInterval_10Hz = 100,
+  SpInterval_16Hz = 63,
+  SpInterval_20Hz = 50,
+};
+
 enum SpGnssFixType { FixInvalid = 0, Fix2D = 1, Fix3D = 2 };
 typedef SpGnssFixType SpFixMode;
 
@@ -30,7 +41,7 @@ struct SpNavData {
   SpGnssFixType posFixMode;
   double        latitude;
   double        longitude;
-  float         altitude; // not used but good to have
+  float         altitude;
   int           numSatellites;
 };
 
@@ -40,10 +51,22 @@ public:
   int  start(int mode);
   int  stop();
   void select(int satelliteSystem);
+  void deselect(int satelliteSystem);
+  int  setInterval(SpInterval interval);
   bool waitUpdate(int timeout);
   void getNavData(SpNavData *navData);
 
   // Mock control
-  static SpNavTime mockTimeData;
-  static float     mockVelocityData;
+  static SpNavTime     mockTimeData;
+  static float         mockVelocityData;
+  static SpInterval    mockInterval;
+  static SpGnssFixType mockFixMode;
+  static uint32_t      mockSelected; // (1 << satelliteSystem) の集合
+  static int           mockStartMode;
+  static int           mockStartCount;
+  static int           mockStartFailures; // この回数だけ start() を失敗させる
+  static bool          mockIsStarted;     // false なら waitUpdate() は何も返さない
+  static unsigned long mockBeginMs;       // begin() にかかる時間
+  static unsigned long mockTtffMs;        // start() から測位するまでの時間。それまでは FixInvalid
+  static unsigned long mockStartMillis;
 };
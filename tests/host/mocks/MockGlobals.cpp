@@ -3,3 +3,7 @@
 unsigned long      _mock_millis = 0;
 std::map<int, int> _mock_pin_states;
 SerialMock         Serial;
+
+std::vector<uint8_t> _mock_shift_bytes;
+unsigned int (*_mock_timer_isr)() = nullptr;
+unsigned int _mock_timer_us       = 0;
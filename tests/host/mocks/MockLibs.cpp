@@ -2,8 +2,11 @@
 #include <iostream>
 
 #include "Adafruit_GFX.h"
+#include "Arduino.h"
 #include "Adafruit_SSD1306.h"
+#include "Flash.h"
 #include "GNSS.h"
+#include "RTC.h"
 #include "Wire.h"
 
 // --- Wire ---
@@ -20,8 +23,27 @@ Adafruit_GFX::Adafruit_GFX(int16_t w, int16_t h) {
   (void)h;
 }
 
+unsigned long Adafruit_GFX::mockDrawCalls    = 0;
+unsigned long Adafruit_GFX::mockBitmapPixels = 0;
+
+void Adafruit_GFX::drawBitmap(int16_t x, int16_t y, const uint8_t bitmap[], int16_t w, int16_t h,
+                              uint16_t color) {
+  (void)x;
+  (void)y;
+  (void)bitmap;
+  (void)color;
+  mockDrawCalls++;
+  mockBitmapPixels += static_cast<unsigned long>(w) * h;
+}
+
 // --- Adafruit_SSD1306 ---
-Adafruit_SSD1306::Adafruit_SSD1306(int16_t w, int16_t h, TwoWire *twi, int8_t rst_pin) : Adafruit_GFX(w, h) {
+unsigned long Adafruit_SSD1306::mockDisplayCount = 0;
+unsigned long Adafruit_SSD1306::mockI2cBytes     = 0;
+unsigned long Adafruit_SSD1306::mockBeginMs      = 0;
+unsigned long Adafruit_SSD1306::mockBoundsCalls  = 0;
+
+Adafruit_SSD1306::Adafruit_SSD1306(int16_t w, int16_t h, TwoWire *twi, int8_t rst_pin)
+    : Adafruit_GFX(w, h), width(w), height(h) {
   (void)twi;
   (void)rst_pin;
 }
@@ -31,11 +53,18 @@ bool Adafruit_SSD1306::begin(uint8_t switchvcc, uint8_t i2caddr, bool reset, boo
   (void)i2caddr;
   (void)reset;
   (void)periphBegin;
+  _mock_millis += mockBeginMs;
   return true; // Success
 }
 
+// Adafruit_SSD1306 と同じく範囲指定のコマンドを 2 回に分けて送り (5 + 1 バイト)、画面全体の
+// データを I2C バッファ (32 バイト) に収まるよう 31 バイトずつ、アドレスと制御バイトを付けて送る
 void Adafruit_SSD1306::display() {
-  // implementation
+  const unsigned long chunk = 31;
+  const unsigned long data  = static_cast<unsigned long>(width) * height / 8;
+  mockDisplayCount++;
+  mockI2cBytes += (1 + 1 + 5) + (1 + 1 + 1);
+  mockI2cBytes += data + (data + chunk - 1) / chunk * 2;
 }
 
 void Adafruit_SSD1306::clearDisplay() {
@@ -70,22 +99,27 @@ void Adafruit_SSD1306::setCursor(int16_t x, int16_t y) {
 }
 
 void Adafruit_SSD1306::print(const String &s) {
+  mockDrawCalls++;
   // std::cout << "OLED print: " << s.c_str() << std::endl;
 }
 
 void Adafruit_SSD1306::print(const char *s) {
+  mockDrawCalls++;
   // std::cout << "OLED print: " << s << std::endl;
 }
 
 void Adafruit_SSD1306::println(const String &s) {
+  mockDrawCalls++;
   // std::cout << "OLED println: " << s.c_str() << std::endl;
 }
 
 void Adafruit_SSD1306::println(const char *s) {
+  mockDrawCalls++;
   // std::cout << "OLED println: " << s << std::endl;
 }
 
 void Adafruit_SSD1306::getTextBounds(const String &str, int16_t x, int16_t y, int16_t *x1, int16_t *y1, uint16_t *w, uint16_t *h) {
+  mockBoundsCalls++;
   // Mock logic to return some reasonable bounds
   // Assume 6x8 chars for size 1
   *x1 = x;
@@ -96,6 +130,7 @@ void Adafruit_SSD1306::getTextBounds(const String &str, int16_t x, int16_t y, in
 
 // Adafruit_GFX implementations
 void Adafruit_GFX::drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color) {
+  mockDrawCalls++;
   (void)x0;
   (void)y0;
   (void)x1;
@@ -104,6 +139,7 @@ void Adafruit_GFX::drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint
   // Mock implementation
 }
 void Adafruit_GFX::drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+  mockDrawCalls++;
   (void)x;
   (void)y;
   (void)w;
@@ -112,6 +148,7 @@ void Adafruit_GFX::drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t
   // Mock implementation
 }
 void Adafruit_GFX::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+  mockDrawCalls++;
   (void)x;
   (void)y;
   (void)w;
@@ -120,6 +157,7 @@ void Adafruit_GFX::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t
   // Mock implementation
 }
 void Adafruit_GFX::drawCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color) {
+  mockDrawCalls++;
   (void)x0;
   (void)y0;
   (void)r;
@@ -128,31 +166,155 @@ void Adafruit_GFX::drawCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color)
 }
 
 // --- GNSS ---
-SpNavTime SpGnss::mockTimeData     = {2023, 10, 1, 12, 30, 0, 0};
-float     SpGnss::mockVelocityData = 5.5f;
+SpNavTime     SpGnss::mockTimeData      = {2023, 10, 1, 12, 30, 0, 0};
+float         SpGnss::mockVelocityData  = 5.5f;
+SpInterval    SpGnss::mockInterval      = SpInterval_1Hz;
+SpGnssFixType SpGnss::mockFixMode       = Fix3D;
+uint32_t      SpGnss::mockSelected      = 0;
+int           SpGnss::mockStartMode     = -1;
+int           SpGnss::mockStartCount    = 0;
+int           SpGnss::mockStartFailures = 0;
+bool          SpGnss::mockIsStarted     = false;
+unsigned long SpGnss::mockBeginMs       = 0;
+unsigned long SpGnss::mockTtffMs        = 0;
+unsigned long SpGnss::mockStartMillis   = 0;
 
 int SpGnss::begin() {
+  _mock_millis += mockBeginMs;
   return 0;
 }
 int SpGnss::start(int mode) {
-  (void)mode;
+  mockStartMode   = mode;
+  mockStartMillis = _mock_millis;
+  mockStartCount++;
+  if (0 < mockStartFailures) {
+    mockStartFailures--;
+    return -1;
+  }
+  mockIsStarted = true;
   return 0;
 }
 int SpGnss::stop() {
+  mockIsStarted = false;
   return 0;
 }
 void SpGnss::select(int satelliteSystem) {
-  (void)satelliteSystem;
+  mockSelected |= 1u << satelliteSystem;
+}
+void SpGnss::deselect(int satelliteSystem) {
+  mockSelected &= ~(1u << satelliteSystem);
+}
+int SpGnss::setInterval(SpInterval interval) {
+  if (mockIsStarted) return -1; // 受信中は変えられない
+  mockInterval = interval;
+  return 0;
 }
 bool SpGnss::waitUpdate(int timeout) {
   (void)timeout;
-  return true;
+  return mockIsStarted;
 }
 void SpGnss::getNavData(SpNavData *navData) {
   if (navData) {
     navData->velocity      = mockVelocityData;
     navData->time          = mockTimeData;
-    navData->posFixMode    = Fix3D;
+    navData->posFixMode    = _mock_millis - mockStartMillis < mockTtffMs ? FixInvalid : mockFixMode;
     navData->numSatellites = 8;
   }
 }
+
+// --- RTC ---
+RtcClass      RTC;
+bool          RtcClass::mockIsBegun   = false;
+double        RtcClass::mockDriftPpm  = 0.0;
+uint64_t      RtcClass::mockSetNs     = 0;
+unsigned long RtcClass::mockSetMillis = 0;
+unsigned long RtcClass::mockSetCount  = 0;
+
+void RtcClass::begin() {
+  mockIsBegun = true;
+}
+
+void RtcClass::setTime(RtcTime &time) {
+  mockSetNs     = time.unixtime() * 1000000000ULL + time.nsec();
+  mockSetMillis = _mock_millis;
+  mockSetCount++;
+}
+
+RtcTime RtcClass::getTime() {
+  const double   elapsedNs = (_mock_millis - mockSetMillis) * 1e6 * (1.0 + mockDriftPpm / 1e6);
+  const uint64_t ns        = mockSetNs + static_cast<uint64_t>(elapsedNs);
+  return RtcTime(static_cast<uint32_t>(ns / 1000000000ULL), static_cast<long>(ns % 1000000000ULL));
+}
+
+void RtcClass::mockReset() {
+  mockIsBegun   = false;
+  mockDriftPpm  = 0.0;
+  mockSetNs     = 0;
+  mockSetMillis = _mock_millis;
+  mockSetCount  = 0;
+}
+
+// --- Flash ---
+FlashClass                                  Flash;
+std::map<std::string, std::vector<uint8_t>> FlashClass::mockFiles;
+long                                        FlashClass::mockWriteBudget = -1;
+std::string                                 FlashClass::mockRoot;
+unsigned long                               FlashClass::mockOpenMs = 0;
+
+bool FlashClass::mockLoad(const std::string &path) {
+  if (mockFiles.count(path) != 0) return true;
+  if (mockRoot.empty()) return false;
+
+  FILE *fp = fopen(mockHostPath(path).c_str(), "rb");
+  if (!fp) return false;
+  std::vector<uint8_t> &data = mockFiles[path];
+  uint8_t               buf[4096];
+  size_t                n;
+  while (0 < (n = fread(buf, 1, sizeof(buf), fp))) data.insert(data.end(), buf, buf + n);
+  fclose(fp);
+  return true;
+}
+
+File FlashClass::open(const char *path, uint8_t mode) {
+  _mock_millis += mockOpenMs;
+  if (mode == FILE_READ) {
+    return mockLoad(path) ? File(&mockFiles[path], false) : File();
+  }
+  mockLoad(path);
+  return File(&mockFiles[path], true, path);
+}
+
+bool FlashClass::exists(const char *path) {
+  return mockLoad(path);
+}
+
+bool FlashClass::remove(const char *path) {
+  const bool isFound = mockLoad(path);
+  mockFiles.erase(path);
+  if (!mockRoot.empty()) std::remove(mockHostPath(path).c_str());
+  return isFound;
+}
+
+size_t File::write(const uint8_t *buf, size_t size) {
+  if (!data || !writable) return 0;
+  if (0 <= FlashClass::mockWriteBudget && FlashClass::mockWriteBudget < static_cast<long>(size)) {
+    size = FlashClass::mockWriteBudget;
+  }
+  if (0 <= FlashClass::mockWriteBudget) FlashClass::mockWriteBudget -= size;
+  if (data->size() < offset + size) data->resize(offset + size);
+  if (0 < size) memcpy(data->data() + offset, buf, size);
+
+  // ホストのファイルにも同じ位置へ書く
+  if (!FlashClass::mockRoot.empty() && !path.empty() && 0 < size) {
+    const std::string host = FlashClass::mockHostPath(path);
+    FILE             *fp   = fopen(host.c_str(), "r+b");
+    if (!fp) fp = fopen(host.c_str(), "w+b");
+    if (fp) {
+      fseek(fp, static_cast<long>(offset), SEEK_SET);
+      fwrite(buf, 1, size, fp);
+      fclose(fp);
+    }
+  }
+  offset += size;
+  return size;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <stdint.h>
+
+class RtcTime {
+private:
+  uint32_t sec;
+  long     ns;
+
+public:
+  RtcTime(uint32_t sec = 0, long nsec = 0) : sec(sec), ns(nsec) {}
+
+  uint32_t unixtime() const {
+    return sec;
+  }
+
+  long nsec() const {
+    return ns;
+  }
+};
+
+class RtcClass {
+public:
+  void    begin();
+  void    setTime(RtcTime &time);
+  RtcTime getTime();
+
+  // Mock control
+  // 最後に setTime() した時刻から millis() の経過に (1 + mockDriftPpm / 1e6) を掛けて進む。
+  // mockReset() の後は 1970-01-01 (電池がなく時刻を失った状態) から進む
+  static bool          mockIsBegun;
+  static double        mockDriftPpm;
+  static uint64_t      mockSetNs; // setTime() した時刻 [ns]
+  static unsigned long mockSetMillis;
+  static unsigned long mockSetCount;
+
+  static void mockReset();
+};
+
+extern RtcClass RTC;
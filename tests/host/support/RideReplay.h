@@ -0,0 +1,178 @@
+#pragma once
+
+#include <GNSS.h>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+// 実走ログの代わりに、速度プロファイルから決定論的に GNSS 出力を再生する
+class RideReplay {
+public:
+  typedef float (*Profile)(double elapsedSec);
+  typedef double (*Elevation)(double distanceM);
+
+  static constexpr double EARTH_RADIUS_M = 6378137.0;
+
+private:
+  Profile       profile;
+  double        lat;
+  double        lon;
+  double        distanceM   = 0.0;
+  float         kmh         = 0.0f;
+  unsigned long elapsedMs   = 0;
+  unsigned long intervalMs  = 1000;
+  unsigned long nextFixMs   = 0;
+  float         posNoiseM   = 0.0f;
+  float         velNoiseKmh = 0.0f;
+  Elevation     elevation   = nullptr;
+  float         altNoiseM   = 0.0f;
+  uint32_t      rng         = 12345;
+  SpNavData     nav;
+
+public:
+  explicit RideReplay(Profile profile, float posNoiseM = 0.0f, float velNoiseKmh = 0.0f,
+                      double startLat = 35.681236, double startLon = 139.767125)
+      : profile(profile), lat(startLat), lon(startLon), posNoiseM(posNoiseM),
+        velNoiseKmh(velNoiseKmh) {
+    memset(&nav, 0, sizeof(nav));
+    kmh = profile(0.0);
+  }
+
+  void setIntervalMs(unsigned long ms) {
+    intervalMs = ms;
+  }
+
+  // 走行距離に応じた高度を出力する。設定しなければ高度は 0
+  void setElevation(Elevation altitudeM, float noiseM) {
+    elevation = altitudeM;
+    altNoiseM = noiseM;
+  }
+
+  unsigned long getIntervalMs() const {
+    return intervalMs;
+  }
+
+  // loopMs ごとに App のループを模擬し、onLoop(nav, nowMs, isNewFix) を呼ぶ
+  template <typename F> void run(unsigned long durationMs, unsigned long loopMs, F onLoop) {
+    const unsigned long endMs = elapsedMs + durationMs;
+    while (elapsedMs < endMs) {
+      advance(loopMs);
+      bool isNewFix = false;
+      if (nextFixMs <= elapsedMs) {
+        sample();
+        nextFixMs = elapsedMs + intervalMs;
+        isNewFix  = true;
+      }
+      onLoop(static_cast<const SpNavData &>(nav), elapsedMs, isNewFix);
+    }
+  }
+
+  void advance(unsigned long dtMs) {
+    const double t0 = elapsedMs / 1000.0;
+    const double t1 = (elapsedMs + dtMs) / 1000.0;
+    const double v  = (profile(t0) + profile(t1)) / 2.0 / 3.6; // m/s (台形積分)
+    const double d  = v * (t1 - t0);
+    const double h  = headingRad(t0);
+
+    lat += d * cos(h) / EARTH_RADIUS_M * 180.0 / M_PI;
+    lon += d * sin(h) / (EARTH_RADIUS_M * cos(lat * M_PI / 180.0)) * 180.0 / M_PI;
+    distanceM += d;
+    elapsedMs += dtMs;
+    kmh = profile(t1);
+  }
+
+  // 現在の真値から GNSS 出力を作る
+  const SpNavData &sample() {
+    const double noiseN = gaussian() * posNoiseM;
+    const double noiseE = gaussian() * posNoiseM;
+
+    nav.posFixMode    = Fix3D;
+    nav.numSatellites = 12;
+    nav.latitude      = lat + noiseN / EARTH_RADIUS_M * 180.0 / M_PI;
+    nav.longitude     = lon + noiseE / (EARTH_RADIUS_M * cos(lat * M_PI / 180.0)) * 180.0 / M_PI;
+    nav.velocity      = fmaxf(0.0f, (kmh + static_cast<float>(gaussian()) * velNoiseKmh) / 3.6f);
+    if (kmh <= 0.0f) nav.velocity = 0.0f;
+    if (elevation) nav.altitude = static_cast<float>(elevation(distanceM) + gaussian() * altNoiseM);
+    setTime(elapsedMs);
+    return nav;
+  }
+
+  const SpNavData &getNavData() const {
+    return nav;
+  }
+
+  float getTrueKmh() const {
+    return kmh;
+  }
+
+  double getTrueAltitudeM() const {
+    return elevation ? elevation(distanceM) : 0.0;
+  }
+
+  double getTrueDistanceKm() const {
+    return distanceM / 1000.0;
+  }
+
+  unsigned long getElapsedMs() const {
+    return elapsedMs;
+  }
+
+private:
+  // 緩やかに曲がる道を模擬
+  static double headingRad(double t) {
+    return (30.0 + 40.0 * sin(t / 90.0)) * M_PI / 180.0;
+  }
+
+  void setTime(unsigned long ms) {
+    const unsigned long sec = 3 * 3600 + ms / 1000; // 2025-06-01 03:00:00 UTC 起点
+    nav.time.year           = 2025;
+    nav.time.month          = 6;
+    nav.time.day            = 1 + static_cast<int>(sec / 86400);
+    nav.time.hour           = static_cast<int>(sec / 3600 % 24);
+    nav.time.minute         = static_cast<int>(sec / 60 % 60);
+    nav.time.sec            = static_cast<int>(sec % 60);
+    nav.time.usec           = static_cast<int>(ms % 1000 * 1000);
+  }
+
+  double uniform() {
+    rng = rng * 1664525u + 1013904223u;
+    return (rng >> 8) / static_cast<double>(1u << 24);
+  }
+
+  double gaussian() {
+    double sum = 0.0;
+    for (int i = 0; i < 12; i++) sum += uniform();
+    return sum - 6.0;
+  }
+};
+
+namespace RideProfiles {
+
+// 信号で止まりながら走る市街地走行 (120 秒周期)
+inline float commute(double t) {
+  const double p = fmod(t, 120.0);
+  if (p < 10.0) return 0.0f;
+  if (p < 20.0) return static_cast<float>((p - 10.0) * 2.5);
+  if (p < 60.0) return 25.0f;
+  if (p < 65.0) return static_cast<float>(25.0 - (p - 60.0) * 5.0);
+  if (p < 75.0) return 0.0f;
+  if (p < 83.0) return static_cast<float>((p - 75.0) * 4.375);
+  if (p < 110.0) return 35.0f;
+  return static_cast<float>(35.0 - (p - 110.0) * 3.5);
+}
+
+// 速度が常に揺らぐ郊外走行
+inline float rolling(double t) {
+  return static_cast<float>(28.0 + 6.0 * sin(t / 7.0) + 3.0 * sin(t / 2.3));
+}
+
+inline float steady(double) {
+  return 30.0f;
+}
+
+// 数 km ごとに上り下りを繰り返す丘陵 (最大勾配 約 8 %)
+inline double hills(double distanceM) {
+  return 50.0 + 30.0 * sin(distanceM / 800.0) + 10.0 * sin(distanceM / 230.0);
+}
+
+} // namespace RideProfiles
@@ -0,0 +1,128 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cmath>
+
+#include "domain/Clock.h"
+#include "domain/Trip.h"
+#include "support/RideReplay.h"
+#include "ui/Frame.h"
+#include "ui/GraphView.h"
+#include "ui/Renderer.h"
+
+namespace {
+
+const unsigned long COLUMN_MS = Config::Graph::COLUMN_MS;
+
+int countColumn(const GraphView::Image &image, int x) {
+  int count = 0;
+  for (int y = 0; y < GraphView::Image::HEIGHT; y++) count += image.get(x, y);
+  return count;
+}
+
+} // namespace
+
+TEST(GraphViewTest, BitmapShiftsLeft) {
+  Bitmap<16, 2> bitmap;
+  bitmap.set(8, 0);
+  bitmap.set(15, 1);
+  bitmap.shiftLeft();
+  EXPECT_TRUE(bitmap.get(7, 0));
+  EXPECT_FALSE(bitmap.get(8, 0));
+  EXPECT_TRUE(bitmap.get(14, 1));
+  EXPECT_FALSE(bitmap.get(15, 1));
+}
+
+TEST(GraphViewTest, ScrollsOneColumnPerPeriod) {
+  GraphView view;
+  EXPECT_FALSE(view.update(20.0f, 50.0f, true, 0));
+  EXPECT_FALSE(view.update(20.0f, 50.0f, true, COLUMN_MS - 1));
+  EXPECT_TRUE(view.update(20.0f, 50.0f, true, COLUMN_MS));
+  EXPECT_EQ(view.getStats().fullRedraws, 1u); // 最初の値で表示範囲が決まる
+  EXPECT_EQ(view.getSpeed().getLow(), 200);
+  EXPECT_EQ(view.getSpeed().getHigh(), 300);
+
+  const int right = GraphView::Image::WIDTH - 1;
+  EXPECT_GT(countColumn(view.getImage(), right), 0);
+
+  for (unsigned long i = 2; i <= 10; i++) view.update(25.0f, 55.0f, true, i * COLUMN_MS);
+  EXPECT_EQ(view.getStats().fullRedraws, 1u);
+  EXPECT_EQ(view.getStats().columns, 10u);
+  EXPECT_GT(countColumn(view.getImage(), right - 9), 0);
+  EXPECT_EQ(countColumn(view.getImage(), right - 10), 0);
+}
+
+TEST(GraphViewTest, RescalesOnlyWhenRangeChanges) {
+  GraphView view;
+  view.update(20.0f, 50.0f, true, 0);
+  for (unsigned long i = 1; i <= 5; i++) view.update(20.0f + i * 0.5f, 50.0f, true, i * COLUMN_MS);
+  EXPECT_EQ(view.getStats().fullRedraws, 1u);
+
+  view.update(41.0f, 50.0f, true, 6 * COLUMN_MS);
+  EXPECT_EQ(view.getStats().fullRedraws, 2u);
+  EXPECT_EQ(view.getSpeed().getHigh(), 500);
+
+  // 速い区間が画面外へ流れ出たら範囲を戻す
+  unsigned long now = 6 * COLUMN_MS;
+  for (int i = 0; i < GraphView::Image::WIDTH; i++) {
+    view.update(22.0f, 50.0f, true, now += COLUMN_MS);
+  }
+  EXPECT_EQ(view.getSpeed().getLow(), 200);
+  EXPECT_EQ(view.getSpeed().getHigh(), 300);
+}
+
+TEST(GraphViewTest, GapsLeaveEmptyColumns) {
+  GraphView view;
+  view.update(20.0f, 50.0f, true, 0);
+  view.update(20.0f, 50.0f, true, COLUMN_MS);
+  view.update(0.0f, 0.0f, false, 5 * COLUMN_MS);
+  EXPECT_EQ(view.getStats().columns, 5u);
+  EXPECT_EQ(countColumn(view.getImage(), GraphView::Image::WIDTH - 1), 0);
+  EXPECT_GT(countColumn(view.getImage(), GraphView::Image::WIDTH - 5), 0);
+}
+
+TEST(GraphViewTest, ReplayRenderCostAndI2cBytes) {
+  const Mode::ID modes[] = {Mode::ID::SPD_TIME, Mode::ID::GRAPH};
+  const char    *names[] = {"SPD text", "graph"};
+  for (int m = 0; m < 2; m++) {
+    RideReplay  ride(RideProfiles::commute, 1.0f, 0.3f);
+    Trip        trip;
+    Clock       clock;
+    GraphView   view;
+    OledBackend oled;
+    Renderer    renderer;
+    trip.begin();
+
+    Adafruit_GFX::mockResetCounters();
+    Adafruit_SSD1306::mockDisplayCount = 0;
+    Adafruit_SSD1306::mockI2cBytes     = 0;
+
+    unsigned long updates = 0;
+    double        ns      = 0.0;
+    ride.run(3600UL * 1000, 100, [&](const SpNavData &nav, unsigned long nowMs, bool) {
+      const auto  t0       = std::chrono::steady_clock::now();
+      const float altitude = 40.0f + 15.0f * sinf(nowMs / 600000.0f);
+      trip.update(nav, nowMs);
+      view.update(trip.speedEstimator.get(), altitude, true, nowMs);
+
+      Frame::Views views;
+      views.graphView = &view;
+      Frame frame(trip, clock, modes[m], Fix3D, views);
+      renderer.render(oled, frame);
+      const auto t1 = std::chrono::steady_clock::now();
+      ns += std::chrono::duration<double, std::nano>(t1 - t0).count();
+      updates++;
+    });
+
+    std::cout << "[ BENCH    ] " << names[m] << ": " << ns / updates << " ns/update, "
+              << Adafruit_SSD1306::mockDisplayCount << " displays, "
+              << Adafruit_SSD1306::mockI2cBytes / static_cast<double>(updates)
+              << " I2C bytes/update, " << view.getStats().fullRedraws << " full redraws / "
+              << view.getStats().columns << " columns" << std::endl;
+
+    if (modes[m] == Mode::ID::GRAPH) {
+      EXPECT_EQ(Adafruit_SSD1306::mockDisplayCount, view.getStats().columns + 1); // 初回の描画
+      EXPECT_LT(view.getStats().fullRedraws, view.getStats().columns / 10);
+    }
+  }
+}
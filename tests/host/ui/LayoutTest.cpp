@@ -0,0 +1,194 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstring>
+#include <string>
+
+#include "domain/Clock.h"
+#include "domain/MemorySource.h"
+#include "domain/Trip.h"
+#include "support/RideReplay.h"
+#include "ui/Frame.h"
+#include "ui/Layout.h"
+#include "ui/OledBackend.h"
+
+namespace {
+
+// SPD_TIME と同じ項目を並べた画面と、2 つ目の画面
+const char *const RIDER_LAYOUT = "# speed page\n"
+                                 "page\n"
+                                 "SPEED 3 C\n"
+                                 "TIME  2 B\n"
+                                 "\n"
+                                 "page\r\n"
+                                 "DIST 2 TL\r\n"
+                                 "CLOCK 1 TR  # 時刻\r\n"
+                                 "GRADE 2 BR\r\n";
+
+bool compile(Layout &layout, const std::string &text) {
+  return layout.compile(text.c_str(), text.size());
+}
+
+} // namespace
+
+TEST(LayoutTest, ResolvesAnchorsOnce) {
+  Layout layout;
+  ASSERT_TRUE(compile(layout, RIDER_LAYOUT));
+  ASSERT_EQ(layout.getPageCount(), 2);
+
+  uint8_t             count = 0;
+  const Layout::Item *items = layout.getPage(0, count);
+  ASSERT_EQ(count, 2);
+  EXPECT_EQ(items[0].align, Layout::Align::CENTER);
+  EXPECT_EQ(items[0].x, Config::OLED::WIDTH / 2);
+  EXPECT_EQ(items[0].y, 12 + (52 - 24) / 2);
+  EXPECT_EQ(items[0].unitY, items[0].y + 16);
+  EXPECT_EQ(items[0].unitW, 4 + 4 * 6); // " km/h"
+  EXPECT_EQ(items[1].y, Config::OLED::HEIGHT - 16);
+  EXPECT_EQ(items[1].unitW, 0);
+
+  // "25.3" (大きさ 3) と "km/h" を合わせて中央に置く
+  const int16_t width = items[0].getValueWidth("25.3");
+  EXPECT_EQ(width, 4 * 18);
+  EXPECT_EQ(items[0].getLeft(width), 64 - (72 + 28) / 2);
+
+  items = layout.getPage(1, count);
+  ASSERT_EQ(count, 3);
+  EXPECT_EQ(items[0].x, 0);
+  EXPECT_EQ(items[0].y, Config::Renderer::HEADER_HEIGHT);
+  EXPECT_EQ(items[1].align, Layout::Align::RIGHT);
+  EXPECT_EQ(items[1].getLeft(items[1].getValueWidth("12:34")), 128 - 30);
+  EXPECT_EQ(items[2].getLeft(items[2].getValueWidth("+2.5")), 128 - (48 + 4 + 6));
+
+  EXPECT_EQ(layout.getPage(2, count), nullptr);
+  EXPECT_EQ(count, 0);
+}
+
+TEST(LayoutTest, RejectsMalformedLayouts) {
+  Layout layout;
+  const char *const broken[] = {
+      "SPEDO 3 C\n",       // 項目がない
+      "SPEED 0 C\n",       // 大きさが範囲外
+      "SPEED 5 C\n",
+      "SPEED 33 C\n",
+      "SPEED 3 CENTER\n",  // 位置がない
+      "SPEED 3\n",         // 足りない
+      "SPEED 3 C extra\n", // 多い
+      "page\npage\n",      // 空の画面だけ
+      "",
+      "SPEED_AND_DISTANCE_AND_TIME 1 C\n", // 語が長すぎる
+  };
+  for (const char *text : broken) {
+    ASSERT_TRUE(compile(layout, RIDER_LAYOUT));
+    EXPECT_FALSE(compile(layout, text)) << text;
+    EXPECT_EQ(layout.getPageCount(), 0) << text;
+  }
+
+  std::string crowded = "page\n";
+  for (size_t i = 0; i <= Config::Layout::MAX_PAGE_ITEMS; i++) crowded += "SPEED 1 C\n";
+  EXPECT_FALSE(compile(layout, crowded));
+
+  std::string pages;
+  for (size_t i = 0; i <= Config::Layout::MAX_PAGES; i++) pages += "page\nSPEED 1 C\n";
+  EXPECT_FALSE(compile(layout, pages));
+
+  // 先頭の "page" は省ける。末尾の空の画面は数えない
+  EXPECT_TRUE(compile(layout, "SPEED 3 C\npage\n"));
+  EXPECT_EQ(layout.getPageCount(), 1);
+}
+
+TEST(LayoutTest, LoadsFromSource) {
+  Layout       layout;
+  MemorySource source(reinterpret_cast<const uint8_t *>(RIDER_LAYOUT), strlen(RIDER_LAYOUT));
+  ASSERT_TRUE(layout.load(source));
+  EXPECT_EQ(layout.getPageCount(), 2);
+
+  const std::string huge(Config::Layout::MAX_BYTES + 1, ' ');
+  MemorySource      tooLarge(reinterpret_cast<const uint8_t *>(huge.data()), huge.size());
+  EXPECT_FALSE(layout.load(tooLarge));
+  EXPECT_EQ(layout.getPageCount(), 0);
+}
+
+TEST(LayoutTest, PageMatchesBuiltInScreen) {
+  RideReplay ride(RideProfiles::commute);
+  Trip       trip;
+  Clock      clock;
+  Layout     layout;
+  ASSERT_TRUE(compile(layout, RIDER_LAYOUT));
+  trip.begin();
+  ride.run(10 * 60 * 1000, 1000, [&](const SpNavData &nav, unsigned long now, bool) {
+    trip.update(nav, now);
+    clock.update(nav);
+  });
+
+  Frame::Views views;
+  views.layout = &layout;
+  const Frame builtIn(trip, clock, Mode::ID::SPD_TIME, Fix3D, views);
+  const Frame page(trip, clock, Mode::ID::PAGE, Fix3D, views);
+  ASSERT_EQ(page.page.count, 2);
+  EXPECT_STREQ(page.page.values[0], builtIn.main.value);
+  EXPECT_STREQ(page.page.values[1], builtIn.sub.value);
+  EXPECT_STREQ(page.main.value, builtIn.main.value);
+  EXPECT_STREQ(page.header.modeTime, "1/2");
+
+  views.layoutPage = 1;
+  const Frame second(trip, clock, Mode::ID::PAGE, Fix3D, views);
+  EXPECT_FALSE(second == page);
+  EXPECT_STREQ(second.header.modeTime, "2/2");
+
+  // 位置だけを変えて読み直しても、前の画面とは別の画面として描き直す
+  std::string moved(RIDER_LAYOUT);
+  moved.replace(moved.find("SPEED 3 C"), 9, "SPEED 3 T");
+  ASSERT_TRUE(compile(layout, moved));
+  views.layoutPage = 0;
+  const Frame reloaded(trip, clock, Mode::ID::PAGE, Fix3D, views);
+  EXPECT_EQ(reloaded.page.items, page.page.items);
+  EXPECT_STREQ(reloaded.page.values[0], page.page.values[0]);
+  EXPECT_FALSE(reloaded == page);
+
+  Layout       empty;
+  Frame::Views none;
+  none.layout = &empty;
+  const Frame missing(trip, clock, Mode::ID::PAGE, Fix3D, none);
+  EXPECT_EQ(missing.page.items, nullptr);
+  EXPECT_STREQ(missing.main.value, "--.--");
+}
+
+// 毎回描き直したときの 1 画面あたりの費用。組み込みの画面、解釈済みの画面、毎回解釈する場合を比べる
+TEST(LayoutTest, RenderCost) {
+  enum { BUILT_IN, COMPILED, INTERPRETED, PATHS };
+  const char *const names[] = {"built-in SPD_TIME", "compiled layout", "parse every frame"};
+
+  for (int path = 0; path < PATHS; path++) {
+    RideReplay  ride(RideProfiles::commute, 1.0f, 0.3f);
+    Trip        trip;
+    Clock       clock;
+    Layout      layout;
+    OledBackend oled;
+    ASSERT_TRUE(compile(layout, RIDER_LAYOUT));
+    trip.begin();
+    Adafruit_GFX::mockResetCounters();
+    Adafruit_SSD1306::mockBoundsCalls = 0;
+
+    unsigned long frames = 0;
+    double        ns     = 0.0;
+    ride.run(3600UL * 1000, 100, [&](const SpNavData &nav, unsigned long now, bool) {
+      trip.update(nav, now);
+      const auto t0 = std::chrono::steady_clock::now();
+      if (path == INTERPRETED) compile(layout, RIDER_LAYOUT);
+      Frame::Views views;
+      views.layout = &layout;
+      const Frame frame(trip, clock, path == BUILT_IN ? Mode::ID::SPD_TIME : Mode::ID::PAGE,
+                        Fix3D, views);
+      oled.draw(frame);
+      const auto t1 = std::chrono::steady_clock::now();
+      ns += std::chrono::duration<double, std::nano>(t1 - t0).count();
+      frames++;
+    });
+
+    std::cout << "[ BENCH    ] " << names[path] << ": " << ns / frames << " ns/frame, "
+              << static_cast<double>(Adafruit_GFX::mockDrawCalls) / frames << " draw calls, "
+              << static_cast<double>(Adafruit_SSD1306::mockBoundsCalls) / frames
+              << " text measurements/frame" << std::endl;
+  }
+}
@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "domain/Clock.h"
+#include "domain/Trip.h"
+#include "support/RideReplay.h"
+#include "ui/Frame.h"
+#include "ui/Renderer.h"
+
+namespace {
+
+// 表示に使う文字と小数点、コロンに戻す
+std::string toText(const SevenSeg::Segments &segments) {
+  const char *chars = "0123456789-_AbCdEFGHLnoPrtU";
+  std::string text;
+  for (int i = 0; i < SevenSeg::DIGITS; i++) {
+    const uint8_t glyph = segments.digits[i] & ~SevenSegBackend::DOT;
+    char          c     = glyph == 0 ? ' ' : '?';
+    for (const char *p = chars; *p; p++) {
+      if (SevenSegBackend::glyphOf(*p) == glyph) c = *p;
+    }
+    text += c;
+    if (segments.digits[i] & SevenSegBackend::DOT) text += '.';
+    if (i == 1 && segments.colon) text += ':';
+  }
+  return text;
+}
+
+// タイマー割り込みを 1 周分起こし、74HC595 へ送られたバイトと桁のピンから表示を読み取る
+SevenSeg::Segments scan() {
+  SevenSeg::Segments segments;
+  for (int n = 0; n < SevenSeg::DIGITS; n++) {
+    _mock_shift_bytes.clear();
+    fireTimerInterrupt();
+    EXPECT_EQ(_mock_shift_bytes.size(), 1u);
+    EXPECT_EQ(_mock_timer_us, Config::SevenSeg::MULTIPLEX_US);
+
+    int lit = -1;
+    for (int i = 0; i < SevenSeg::DIGITS; i++) {
+      if (digitalRead(Config::SevenSeg::DIGIT_PINS[i]) != HIGH) continue;
+      EXPECT_EQ(lit, -1) << "2 桁が同時に点いている";
+      lit = i;
+    }
+    if (lit < 0 || _mock_shift_bytes.empty()) continue;
+    segments.digits[lit] = static_cast<uint8_t>(~_mock_shift_bytes.back());
+    segments.colon       = digitalRead(Config::SevenSeg::COLON_PIN) == HIGH;
+  }
+  return segments;
+}
+
+} // namespace
+
+TEST(SevenSegTest, EncodesRightAligned) {
+  EXPECT_EQ(toText(SevenSegBackend::encode("25.3")), " 25.3");
+  EXPECT_EQ(toText(SevenSegBackend::encode("8.0")), "  8.0");
+  EXPECT_EQ(toText(SevenSegBackend::encode("12:34")), "12:34");
+  EXPECT_EQ(toText(SevenSegBackend::encode("9:05")), " 9:05");
+  EXPECT_EQ(toText(SevenSegBackend::encode("--.--")), "--.--");
+  EXPECT_EQ(toText(SevenSegBackend::encode("LOG")), " LoG");
+  EXPECT_EQ(toText(SevenSegBackend::encode("")), "    ");
+  EXPECT_EQ(toText(SevenSegBackend::encode("x1")), "   1"); // 表せない文字は消灯
+}
+
+TEST(SevenSegTest, DropsLeastSignificantPartWhenTooLong) {
+  EXPECT_EQ(toText(SevenSegBackend::encode("123.45")), "123.4");
+  EXPECT_EQ(toText(SevenSegBackend::encode("1:02:03")), " 1:02");
+  EXPECT_EQ(toText(SevenSegBackend::encode("12:34:56")), "12:34");
+  EXPECT_EQ(toText(SevenSegBackend::encode("12345")), "----");
+}
+
+TEST(SevenSegTest, InterruptOnlyShiftsPreparedBytes) {
+  _mock_shift_bytes.clear();
+  SevenSeg sevenSeg;
+  sevenSeg.begin();
+  ASSERT_NE(_mock_timer_isr, nullptr);
+
+  const SevenSeg::Segments segments = SevenSegBackend::encode("12:34");
+  sevenSeg.show(segments);
+  EXPECT_TRUE(_mock_shift_bytes.empty()); // show() はバッファを書き換えるだけ
+
+  for (int n = 0; n < 3 * SevenSeg::DIGITS; n++) {
+    _mock_shift_bytes.clear();
+    fireTimerInterrupt();
+    ASSERT_EQ(_mock_shift_bytes.size(), 1u);
+    EXPECT_EQ(_mock_shift_bytes[0], static_cast<uint8_t>(~segments.digits[sevenSeg.getDigit()]));
+  }
+  EXPECT_EQ(scan(), segments);
+  detachTimerInterrupt();
+}
+
+TEST(SevenSegTest, ShowsEveryModeOfReplayedRide) {
+  RideReplay                     ride(RideProfiles::commute);
+  Trip                           trip;
+  Clock                          clock;
+  SevenSegBackend                display;
+  BasicRenderer<SevenSegBackend> renderer;
+  trip.begin();
+  display.begin();
+
+  ride.run(20 * 60 * 1000, 1000, [&](const SpNavData &nav, unsigned long now, bool) {
+    trip.update(nav, now);
+    clock.update(nav);
+  });
+
+  for (int m = 0; m < static_cast<int>(Mode::ID::Count); m++) {
+    Frame::Views views;
+    Frame        frame(trip, clock, static_cast<Mode::ID>(m), Fix3D, views);
+    renderer.render(display, frame);
+
+    const SevenSeg::Segments shown = scan();
+    EXPECT_EQ(shown, SevenSegBackend::encode(frame.main.value)) << "mode " << m;
+    EXPECT_EQ(toText(shown).find('?'), std::string::npos)
+        << "mode " << m << ": " << frame.main.value;
+  }
+  detachTimerInterrupt();
+}
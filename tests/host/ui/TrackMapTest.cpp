@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+
+#include "domain/Clock.h"
+#include "domain/Trip.h"
+#include "support/RideReplay.h"
+#include "ui/Frame.h"
+#include "ui/Renderer.h"
+#include "ui/TrackMap.h"
+
+namespace {
+
+typedef Bitmap<16, 8> SmallBitmap;
+
+// 北へ 1 m ずつ進む軌跡
+void addNorth(Breadcrumb &crumb, int from, int count) {
+  for (int i = from; i < from + count; i++) crumb.add(35.0 + i * 9e-6, 139.0);
+}
+
+} // namespace
+
+TEST(TrackMapTest, BitmapDrawsAndClipsLines) {
+  SmallBitmap bitmap;
+  EXPECT_EQ(bitmap.drawLine(0, 0, 15, 0), 16u);
+  EXPECT_TRUE(bitmap.get(15, 0));
+  EXPECT_EQ(bitmap.drawLine(0, 0, 7, 7), 8u);
+  EXPECT_TRUE(bitmap.get(7, 7));
+  EXPECT_EQ(bitmap.drawLine(-100000, 3, 100000, 3), 16u);
+  EXPECT_EQ(bitmap.drawLine(-50, -50, -10, 100), 0u);
+  EXPECT_EQ(bitmap.data()[0], 0xFF);
+}
+
+TEST(TrackMapTest, DrawsOnlyNewSegments) {
+  Breadcrumb crumb;
+  TrackMap   map;
+  addNorth(crumb, 0, 2);
+  EXPECT_TRUE(map.update(crumb));
+  EXPECT_FALSE(map.update(crumb));
+
+  for (int i = 2; i < 20; i++) {
+    addNorth(crumb, i, 1);
+    EXPECT_TRUE(map.update(crumb));
+  }
+  EXPECT_EQ(map.getStats().fullRedraws, 1u);
+  EXPECT_EQ(map.getStats().segments, 19u);
+
+  int16_t x;
+  int16_t y;
+  ASSERT_TRUE(map.getHead(crumb, x, y));
+  EXPECT_TRUE(map.getImage().get(x, y));
+}
+
+TEST(TrackMapTest, RedrawsOnPanZoomAndRewrite) {
+  Breadcrumb crumb;
+  TrackMap   map;
+  addNorth(crumb, 0, 2);
+  map.update(crumb);
+
+  addNorth(crumb, 2, 60); // 2 m/px で 20 px 以上北へ進み、上端の余白に入る
+  map.update(crumb);
+  EXPECT_EQ(map.getStats().fullRedraws, 2u);
+
+  map.nextZoom();
+  map.update(crumb);
+  EXPECT_EQ(map.getStats().fullRedraws, 3u);
+  EXPECT_EQ(map.getScaleMPerPx(), Config::MapView::SCALES_M_PER_PX[1]);
+
+  crumb.reset();
+  addNorth(crumb, 0, 2);
+  map.update(crumb);
+  EXPECT_EQ(map.getStats().fullRedraws, 4u);
+}
+
+TEST(TrackMapTest, ReplayRenderCost) {
+  const bool forceFull[] = {false, true};
+  for (bool isFull : forceFull) {
+    RideReplay  ride(RideProfiles::commute, 1.0f, 0.2f);
+    Trip        trip;
+    Clock       clock;
+    TrackMap    map;
+    OledBackend oled;
+    Renderer    renderer;
+    trip.begin();
+    map.nextZoom();
+    map.nextZoom(); // 10 m/px
+
+    Adafruit_GFX::mockResetCounters();
+    Adafruit_SSD1306::mockDisplayCount = 0;
+
+    unsigned long renders = 0;
+    double        mapNs   = 0.0;
+    ride.run(3600UL * 1000, 1000, [&](const SpNavData &nav, unsigned long nowMs, bool) {
+      trip.update(nav, nowMs);
+      if (isFull) {
+        for (size_t i = 0; i < TrackMap::ZOOM_LEVELS; i++) map.nextZoom();
+      }
+
+      const auto t0 = std::chrono::steady_clock::now();
+      map.update(trip.breadcrumb);
+      const auto t1 = std::chrono::steady_clock::now();
+      mapNs += std::chrono::duration<double, std::nano>(t1 - t0).count();
+
+      Frame::Views views;
+      views.trackMap = &map;
+      Frame frame(trip, clock, Mode::ID::MAP, Fix3D, views);
+      renderer.render(oled, frame);
+      renders++;
+    });
+
+    const TrackMap::Stats &stats = map.getStats();
+    std::cout << "[ BENCH    ] " << (isFull ? "full redraw" : "incremental") << ": "
+              << mapNs / renders << " ns/update, " << stats.pixels / static_cast<double>(renders)
+              << " px/update, " << stats.fullRedraws << " full redraws, "
+              << Adafruit_GFX::mockDrawCalls / static_cast<double>(renders)
+              << " draw calls/update, " << Adafruit_SSD1306::mockDisplayCount << " displays"
+              << std::endl;
+
+    if (isFull) {
+      EXPECT_EQ(stats.fullRedraws, renders - 1); // 最初の更新ではまだ軌跡がない
+    } else {
+      EXPECT_LT(stats.fullRedraws, renders / 20);
+      EXPECT_LT(stats.segments, renders * 2);
+    }
+    EXPECT_EQ(map.getScaleMPerPx(), 10);
+  }
+}
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <math.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "domain/PoiIndex.h"
+
+// 地点の一覧から PoiIndex のファイルを作る (ホスト専用)
+// セルの大きさは、セル数が地点数の 2 倍程度に収まり、かつ通知半径より小さくならないように決める
+class PoiIndexBuilder {
+public:
+  struct Poi {
+    double          lat;
+    double          lon;
+    PoiFormat::Kind kind;
+    std::string     name;
+  };
+
+private:
+  static constexpr double MIN_CELL_M = Config::Poi::REARM_RADIUS_M;
+  static constexpr double M_PER_E7   = Config::Odometer::EARTH_RADIUS_M * PI / 180.0 / 1e7;
+
+  std::vector<Poi> pois;
+
+public:
+  void add(const Poi &poi) {
+    pois.push_back(poi);
+  }
+
+  size_t size() const {
+    return pois.size();
+  }
+
+  std::vector<uint8_t> build() const {
+    PoiFormat::Header header = PoiFormat::Header();
+    header.magic             = PoiFormat::MAGIC;
+    header.count             = static_cast<uint32_t>(pois.size());
+    layout(header);
+
+    // 行優先のセル番号で数え上げソートする。同じセルの中では入力順を保つ
+    const size_t          cells = static_cast<size_t>(header.rows) * header.cols;
+    std::vector<uint32_t> cellStart(cells + 1, 0);
+    std::vector<uint32_t> cellOf(pois.size());
+    for (size_t i = 0; i < pois.size(); i++) {
+      cellOf[i] = cellIndex(header, pois[i]);
+      cellStart[cellOf[i] + 1]++;
+    }
+    for (size_t i = 0; i < cells; i++) cellStart[i + 1] += cellStart[i];
+
+    std::vector<uint32_t> order(pois.size());
+    std::vector<uint32_t> next(cellStart.begin(), cellStart.end() - 1);
+    for (size_t i = 0; i < pois.size(); i++) order[next[cellOf[i]]++] = static_cast<uint32_t>(i);
+
+    std::vector<uint8_t> out;
+    put32(out, header.magic);
+    put32(out, header.count);
+    put32(out, header.originLatE7);
+    put32(out, header.originLonE7);
+    put32(out, header.cellLatE7);
+    put32(out, header.cellLonE7);
+    put16(out, header.rows);
+    put16(out, header.cols);
+    put32(out, header.reserved);
+    for (uint32_t start : cellStart) put32(out, start);
+    for (uint32_t i : order) {
+      const Poi &poi = pois[i];
+      put32(out, toE7(poi.lat));
+      put32(out, toE7(poi.lon));
+      out.push_back(static_cast<uint8_t>(poi.kind));
+      for (size_t c = 0; c < PoiFormat::NAME_LEN; c++) {
+        out.push_back(c < poi.name.size() ? static_cast<uint8_t>(poi.name[c]) : 0);
+      }
+    }
+    return out;
+  }
+
+private:
+  void layout(PoiFormat::Header &header) const {
+    header.rows      = 1;
+    header.cols      = 1;
+    header.cellLatE7 = 1;
+    header.cellLonE7 = 1;
+    if (pois.empty()) return;
+
+    int32_t latMin = toE7(pois[0].lat);
+    int32_t latMax = latMin;
+    int32_t lonMin = toE7(pois[0].lon);
+    int32_t lonMax = lonMin;
+    for (const Poi &poi : pois) {
+      const int32_t lat = toE7(poi.lat);
+      const int32_t lon = toE7(poi.lon);
+      if (lat < latMin) latMin = lat;
+      if (latMax < lat) latMax = lat;
+      if (lon < lonMin) lonMin = lon;
+      if (lonMax < lon) lonMax = lon;
+    }
+
+    const double cosMid   = cos((latMin + latMax) / 2e7 * PI / 180.0);
+    const double heightM  = (latMax - latMin) * M_PER_E7;
+    const double widthM   = (lonMax - lonMin) * M_PER_E7 * cosMid;
+    const double maxCells = 2.0 * pois.size() + 1.0;
+
+    double cellM = sqrt(heightM * widthM / pois.size());
+    if (cellM < MIN_CELL_M) cellM = MIN_CELL_M;
+    double rows = floor(heightM / cellM) + 1.0;
+    double cols = floor(widthM / cellM) + 1.0;
+    while (maxCells < rows * cols || UINT16_MAX < rows || UINT16_MAX < cols) {
+      cellM *= 1.25;
+      rows = floor(heightM / cellM) + 1.0;
+      cols = floor(widthM / cellM) + 1.0;
+    }
+
+    header.originLatE7 = latMin;
+    header.originLonE7 = lonMin;
+    header.cellLatE7   = static_cast<int32_t>(ceil(cellM / M_PER_E7));
+    header.cellLonE7   = static_cast<int32_t>(ceil(cellM / (M_PER_E7 * cosMid)));
+    header.rows        = static_cast<uint16_t>((latMax - latMin) / header.cellLatE7 + 1);
+    header.cols        = static_cast<uint16_t>((lonMax - lonMin) / header.cellLonE7 + 1);
+  }
+
+  static uint32_t cellIndex(const PoiFormat::Header &header, const Poi &poi) {
+    const uint32_t row = (toE7(poi.lat) - header.originLatE7) / header.cellLatE7;
+    const uint32_t col = (toE7(poi.lon) - header.originLonE7) / header.cellLonE7;
+    return row * header.cols + col;
+  }
+
+  static int32_t toE7(double degrees) {
+    return static_cast<int32_t>(lround(degrees * 1e7));
+  }
+
+  static void put16(std::vector<uint8_t> &out, uint16_t value) {
+    out.push_back(static_cast<uint8_t>(value));
+    out.push_back(static_cast<uint8_t>(value >> 8));
+  }
+
+  static void put32(std::vector<uint8_t> &out, uint32_t value) {
+    for (int shift = 0; shift < 32; shift += 8) out.push_back(static_cast<uint8_t>(value >> shift));
+  }
+};
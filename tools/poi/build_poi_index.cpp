@@ -0,0 +1,79 @@
+// CSV (lat,lon,kind,name) から PoiIndex のファイルを作る
+//   build_poi_index pois.csv poi.bin
+// kind は water / hazard / checkpoint / other。空行と '#' で始まる行は読み飛ばす
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include "PoiIndexBuilder.h"
+
+namespace {
+
+bool parseKind(const std::string &text, PoiFormat::Kind &kind) {
+  if (text == "water") kind = PoiFormat::Kind::WATER;
+  else if (text == "hazard") kind = PoiFormat::Kind::HAZARD;
+  else if (text == "checkpoint") kind = PoiFormat::Kind::CHECKPOINT;
+  else if (text == "other") kind = PoiFormat::Kind::OTHER;
+  else return false;
+  return true;
+}
+
+bool parseLine(const std::string &line, PoiIndexBuilder::Poi &poi) {
+  std::istringstream in(line);
+  std::string        lat;
+  std::string        lon;
+  std::string        kind;
+  if (!std::getline(in, lat, ',') || !std::getline(in, lon, ',') || !std::getline(in, kind, ',')) {
+    return false;
+  }
+  std::getline(in, poi.name);
+
+  char *end = nullptr;
+  poi.lat   = strtod(lat.c_str(), &end);
+  if (*end != '\0' || poi.lat < -90.0 || 90.0 < poi.lat) return false;
+  poi.lon = strtod(lon.c_str(), &end);
+  if (*end != '\0' || poi.lon < -180.0 || 180.0 < poi.lon) return false;
+  return parseKind(kind, poi.kind);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  if (argc != 3) {
+    std::cerr << "usage: " << argv[0] << " <pois.csv> <poi.bin>" << std::endl;
+    return 2;
+  }
+
+  std::ifstream in(argv[1]);
+  if (!in) {
+    std::cerr << "cannot open " << argv[1] << std::endl;
+    return 1;
+  }
+
+  PoiIndexBuilder builder;
+  std::string     line;
+  for (int lineNo = 1; std::getline(in, line); lineNo++) {
+    if (!line.empty() && line.back() == '\r') line.pop_back();
+    if (line.empty() || line[0] == '#') continue;
+
+    PoiIndexBuilder::Poi poi;
+    if (!parseLine(line, poi)) {
+      std::cerr << argv[1] << ":" << lineNo << ": invalid line" << std::endl;
+      return 1;
+    }
+    builder.add(poi);
+  }
+
+  const std::vector<uint8_t> image = builder.build();
+  std::ofstream              out(argv[2], std::ios::binary);
+  out.write(reinterpret_cast<const char *>(image.data()), image.size());
+  if (!out) {
+    std::cerr << "cannot write " << argv[2] << std::endl;
+    return 1;
+  }
+
+  std::cout << builder.size() << " POIs, " << image.size() << " bytes" << std::endl;
+  return 0;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <math.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include "domain/Route.h"
+
+// 経路の点列から Route のファイルを作る (ホスト専用)
+// 同じ位置が続く点は除き、Config::Route::CAPACITY を超える経路は受け付けない
+class RouteBuilder {
+private:
+  std::vector<RouteFormat::Point> points;
+
+public:
+  void add(double lat, double lon) {
+    RouteFormat::Point point;
+    point.latE7 = static_cast<int32_t>(lround(lat * 1e7));
+    point.lonE7 = static_cast<int32_t>(lround(lon * 1e7));
+    if (!points.empty() && points.back().latE7 == point.latE7 &&
+        points.back().lonE7 == point.lonE7) {
+      return;
+    }
+    points.push_back(point);
+  }
+
+  size_t size() const {
+    return points.size();
+  }
+
+  bool isValid() const {
+    return 2 <= points.size() && points.size() <= Config::Route::CAPACITY;
+  }
+
+  std::vector<uint8_t> build() const {
+    std::vector<uint8_t> out;
+    put32(out, RouteFormat::MAGIC);
+    put32(out, static_cast<uint32_t>(points.size()));
+    for (const RouteFormat::Point &point : points) {
+      put32(out, point.latE7);
+      put32(out, point.lonE7);
+    }
+    return out;
+  }
+
+private:
+  static void put32(std::vector<uint8_t> &out, uint32_t value) {
+    for (int shift = 0; shift < 32; shift += 8) out.push_back(static_cast<uint8_t>(value >> shift));
+  }
+};
@@ -0,0 +1,72 @@
+// CSV (lat,lon) の点列から Route のファイルを作る
+//   build_route route.csv route.bin
+// 空行と '#' で始まる行は読み飛ばす
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "RouteBuilder.h"
+
+namespace {
+
+bool parseLine(const std::string &line, double &lat, double &lon) {
+  std::istringstream in(line);
+  std::string        latText;
+  std::string        lonText;
+  if (!std::getline(in, latText, ',') || !std::getline(in, lonText, ',')) return false;
+
+  char *end = nullptr;
+  lat       = strtod(latText.c_str(), &end);
+  if (*end != '\0' || lat < -90.0 || 90.0 < lat) return false;
+  lon = strtod(lonText.c_str(), &end);
+  return *end == '\0' && -180.0 <= lon && lon <= 180.0;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  if (argc != 3) {
+    std::cerr << "usage: " << argv[0] << " <route.csv> <route.bin>" << std::endl;
+    return 2;
+  }
+
+  std::ifstream in(argv[1]);
+  if (!in) {
+    std::cerr << "cannot open " << argv[1] << std::endl;
+    return 1;
+  }
+
+  RouteBuilder builder;
+  std::string  line;
+  for (int lineNo = 1; std::getline(in, line); lineNo++) {
+    if (!line.empty() && line.back() == '\r') line.pop_back();
+    if (line.empty() || line[0] == '#') continue;
+
+    double lat;
+    double lon;
+    if (!parseLine(line, lat, lon)) {
+      std::cerr << argv[1] << ":" << lineNo << ": invalid line" << std::endl;
+      return 1;
+    }
+    builder.add(lat, lon);
+  }
+  if (!builder.isValid()) {
+    std::cerr << "route needs 2 to " << Config::Route::CAPACITY << " points, got "
+              << builder.size() << std::endl;
+    return 1;
+  }
+
+  const std::vector<uint8_t> image = builder.build();
+  std::ofstream              out(argv[2], std::ios::binary);
+  out.write(reinterpret_cast<const char *>(image.data()), image.size());
+  if (!out) {
+    std::cerr << "cannot write " << argv[2] << std::endl;
+    return 1;
+  }
+
+  std::cout << builder.size() << " points, " << image.size() << " bytes" << std::endl;
+  return 0;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+#include <vector>
+
+#include "hardware/Telemetry.h"
+
+// シリアルで受けたバイト列を 1 バイトずつ受け取り、Telemetry のフレームを取り出す (ホスト専用)
+// 途中から受け始めても、壊れたフレームがあっても、次の区切りから読み直す
+class TelemetryDecoder {
+public:
+  struct Stats {
+    unsigned long frames    = 0;
+    unsigned long corrupted = 0; // 長さ・COBS・CRC のいずれかが合わないフレーム
+    unsigned long lost      = 0; // sequence の欠け (送信側で捨てたか、壊れたフレーム)
+  };
+
+private:
+  std::vector<uint8_t> buffer;
+  bool                 isOverflowed = false;
+  bool                 hasSequence  = false;
+  uint16_t             lastSequence = 0;
+  Stats                stats;
+
+public:
+  // フレームが 1 つ揃ったら snapshot に入れて true を返す
+  bool feed(uint8_t byte, TelemetrySnapshot &snapshot) {
+    if (byte != 0) {
+      if (buffer.size() < Telemetry::FRAME) buffer.push_back(byte);
+      else isOverflowed = true;
+      return false;
+    }
+
+    const bool isValid = !isOverflowed && !buffer.empty() && decode(snapshot);
+    if (!buffer.empty() || isOverflowed) {
+      if (isValid) stats.frames++;
+      else stats.corrupted++;
+    }
+    buffer.clear();
+    isOverflowed = false;
+    if (!isValid) return false;
+
+    if (hasSequence) stats.lost += static_cast<uint16_t>(snapshot.sequence - lastSequence - 1);
+    hasSequence  = true;
+    lastSequence = snapshot.sequence;
+    return true;
+  }
+
+  const Stats &getStats() const {
+    return stats;
+  }
+
+private:
+  bool decode(TelemetrySnapshot &snapshot) const {
+    uint8_t payload[Telemetry::PAYLOAD];
+    size_t  length = 0;
+    if (!Cobs::decode(buffer.data(), buffer.size(), payload, sizeof(payload), length) ||
+        length != sizeof(payload)) {
+      return false;
+    }
+
+    uint32_t crc = 0;
+    memcpy(&snapshot, payload, sizeof(snapshot));
+    memcpy(&crc, payload + sizeof(snapshot), sizeof(crc));
+    return crc == Crc32::compute(&snapshot, sizeof(snapshot)) && snapshot.version == 1;
+  }
+};
@@ -0,0 +1,46 @@
+// シリアルから保存したバイト列 (Telemetry のフレーム) を CSV にする
+//   decode_telemetry capture.bin telemetry.csv
+// 途中から保存したものや、トレースの出力が混ざったものも読める
+
+#include <fstream>
+#include <iostream>
+
+#include "TelemetryDecoder.h"
+
+int main(int argc, char **argv) {
+  if (argc != 3) {
+    std::cerr << "usage: " << argv[0] << " <capture.bin> <telemetry.csv>" << std::endl;
+    return 2;
+  }
+
+  std::ifstream in(argv[1], std::ios::binary);
+  if (!in) {
+    std::cerr << "cannot open " << argv[1] << std::endl;
+    return 1;
+  }
+  std::ofstream out(argv[2]);
+  out.precision(10);
+  out << "sequence,uptime_ms,epoch,fix,satellites,lat,lon,altitude_m,speed_kmh,avg_kmh,max_kmh,"
+         "distance_m,moving_ms,elapsed_ms,gradient_percent\n";
+
+  TelemetryDecoder  decoder;
+  TelemetrySnapshot s;
+  char              byte;
+  while (in.get(byte)) {
+    if (!decoder.feed(static_cast<uint8_t>(byte), s)) continue;
+    out << s.sequence << ',' << s.uptimeMs << ',' << s.epoch << ',' << int(s.fixMode) << ','
+        << int(s.satellites) << ',' << s.latE7 / 1e7 << ',' << s.lonE7 / 1e7 << ',' << s.altitudeM
+        << ',' << s.speedCentiKmh / 100.0 << ',' << s.avgCentiKmh / 100.0 << ','
+        << s.maxCentiKmh / 100.0 << ',' << s.distanceM << ',' << s.movingTimeMs << ','
+        << s.elapsedTimeMs << ',' << s.gradientPermille / 10.0 << '\n';
+  }
+  if (!out) {
+    std::cerr << "cannot write " << argv[2] << std::endl;
+    return 1;
+  }
+
+  const TelemetryDecoder::Stats &stats = decoder.getStats();
+  std::cout << stats.frames << " frames, " << stats.corrupted << " corrupted, " << stats.lost
+            << " lost" << std::endl;
+  return 0;
+}
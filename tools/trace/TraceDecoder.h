@@ -0,0 +1,129 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <istream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "hardware/Trace.h"
+
+// シリアルの記録から Trace::dump() の出力を取り出し、Chrome の trace event にする (ホスト専用)
+// サイクルカウンタの桁あふれは、前の記録からの差を足し合わせて戻す
+class TraceDecoder {
+public:
+  struct Event {
+    uint8_t  event;
+    char     phase;
+    double   us; // 最初の記録からの時間
+    uint16_t arg;
+  };
+
+private:
+  std::vector<Event> events;
+  uint32_t           dropped = 0;
+
+public:
+  // 最後に見つかった完全な出力を読む。見つからなければ false
+  // テレメトリのフレームが同じ行の前に混ざっていても、見出しから読む
+  bool parse(std::istream &in) {
+    bool        isFound = false;
+    std::string line;
+    while (std::getline(in, line)) {
+      if (!line.empty() && line.back() == '\r') line.pop_back();
+      const size_t at = line.find("TRACE1 ");
+      if (at == std::string::npos) continue;
+      if (parseDump(line.substr(at), in)) isFound = true;
+    }
+    return isFound;
+  }
+
+  const std::vector<Event> &getEvents() const {
+    return events;
+  }
+
+  uint32_t getDropped() const {
+    return dropped;
+  }
+
+  std::string toJson() const {
+    std::ostringstream out;
+    out.setf(std::ios::fixed);
+    out.precision(3);
+    out << "{\"displayTimeUnit\":\"ms\",\"otherData\":{\"dropped\":" << dropped
+        << "},\"traceEvents\":[";
+    for (size_t i = 0; i < events.size(); i++) {
+      const Event &e = events[i];
+      out << (i == 0 ? "\n" : ",\n") << "{\"name\":\"" << nameOf(e.event) << "\",\"ph\":\""
+          << e.phase << "\",\"ts\":" << e.us << ",\"pid\":1,\"tid\":1";
+      if (e.phase == 'i') out << ",\"s\":\"t\"";
+      out << ",\"args\":{\"arg\":" << e.arg << "}}";
+    }
+    out << "\n]}\n";
+    return out.str();
+  }
+
+private:
+  static std::string nameOf(uint8_t event) {
+    const char *name = Trace::getName(event);
+    return name ? name : "EVENT_" + std::to_string(event);
+  }
+
+  bool parseDump(const std::string &header, std::istream &in) {
+    unsigned long ticksPerUs = 0;
+    unsigned long count      = 0;
+    unsigned long lost       = 0;
+
+    std::istringstream fields(header.substr(7));
+    if (!(fields >> ticksPerUs >> count >> lost) || ticksPerUs == 0) return false;
+
+    std::vector<Event> decoded;
+    std::vector<int>   depth(256, 0);
+    uint64_t           ticks    = 0;
+    uint32_t           previous = 0;
+    std::string        line;
+    for (unsigned long i = 0; i < count; i++) {
+      if (!std::getline(in, line)) return false;
+      if (!line.empty() && line.back() == '\r') line.pop_back();
+      TraceRecord record;
+      if (!parseRecord(line, record)) return false;
+
+      if (i != 0) ticks += static_cast<uint32_t>(record.ticks - previous);
+      previous = record.ticks;
+
+      // 開始が上書きで失われた区間の終了は捨てる
+      if (record.phase == 'B') depth[record.event]++;
+      if (record.phase == 'E' && depth[record.event]-- <= 0) {
+        depth[record.event] = 0;
+        continue;
+      }
+      Event event;
+      event.event = record.event;
+      event.phase = static_cast<char>(record.phase);
+      event.us    = static_cast<double>(ticks) / ticksPerUs;
+      event.arg   = record.arg;
+      decoded.push_back(event);
+    }
+    if (!std::getline(in, line) || line.compare(0, 3, "END") != 0) return false;
+
+    events.swap(decoded);
+    dropped = static_cast<uint32_t>(lost);
+    return true;
+  }
+
+  static bool parseRecord(const std::string &line, TraceRecord &record) {
+    if (line.size() != 16) return false;
+    char *end    = nullptr;
+    record.ticks = static_cast<uint32_t>(strtoul(line.substr(0, 8).c_str(), &end, 16));
+    if (*end != '\0') return false;
+    record.event = static_cast<uint8_t>(strtoul(line.substr(8, 2).c_str(), &end, 16));
+    if (*end != '\0') return false;
+    record.phase = static_cast<uint8_t>(strtoul(line.substr(10, 2).c_str(), &end, 16));
+    if (*end != '\0') return false;
+    record.arg = static_cast<uint16_t>(strtoul(line.substr(12, 4).c_str(), &end, 16));
+    return *end == '\0' &&
+           (record.phase == 'B' || record.phase == 'E' || record.phase == 'i');
+  }
+};
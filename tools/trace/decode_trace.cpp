@@ -0,0 +1,38 @@
+// シリアルの記録 (Trace::dump() の出力を含む) から Chrome の trace event (JSON) を作る
+//   decode_trace serial.log trace.json
+// 出力は chrome://tracing や Perfetto で開ける。記録に複数の出力があれば最後のものを使う
+
+#include <fstream>
+#include <iostream>
+
+#include "TraceDecoder.h"
+
+int main(int argc, char **argv) {
+  if (argc != 3) {
+    std::cerr << "usage: " << argv[0] << " <serial.log> <trace.json>" << std::endl;
+    return 2;
+  }
+
+  std::ifstream in(argv[1]);
+  if (!in) {
+    std::cerr << "cannot open " << argv[1] << std::endl;
+    return 1;
+  }
+
+  TraceDecoder decoder;
+  if (!decoder.parse(in)) {
+    std::cerr << argv[1] << ": no complete trace dump" << std::endl;
+    return 1;
+  }
+
+  std::ofstream out(argv[2]);
+  out << decoder.toJson();
+  if (!out) {
+    std::cerr << "cannot write " << argv[2] << std::endl;
+    return 1;
+  }
+
+  std::cout << decoder.getEvents().size() << " events, " << decoder.getDropped()
+            << " overwritten" << std::endl;
+  return 0;
+}
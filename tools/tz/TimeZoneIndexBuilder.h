@@ -0,0 +1,441 @@
+#pragma once
+
+#include <ctype.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "domain/TimeZoneIndex.h"
+
+// 時間帯ごとの境界の多角形から TimeZoneIndex のファイルを作る (ホスト専用)
+// 境界は Douglas-Peucker で間引く。隣り合う時間帯の境界は別々に間引くので、間に許容誤差ほどの
+// 隙間や重なりができる。隙間では海上の時差になり、境界のセルは一定間隔で引き直すので戻る
+class TimeZoneIndexBuilder {
+public:
+  struct Point {
+    double lat;
+    double lon;
+  };
+
+private:
+  static constexpr double M_PER_DEG = Config::Odometer::EARTH_RADIUS_M * PI / 180.0;
+
+  struct Ring {
+    uint16_t                      zone;
+    std::vector<TzFormat::Vertex> vertices;
+  };
+
+  std::vector<TzFormat::Zone> zones;
+  std::vector<Ring>           rings;
+  size_t                      inputVertices = 0;
+
+public:
+  // POSIX の TZ 文字列 ("CET-1CEST,M3.5.0,M10.5.0/3" など) を登録して番号を返す。
+  // 解釈できなければ -1
+  int addZone(const std::string &tz) {
+    TzFormat::Zone zone;
+    if (TzFormat::FULL <= zones.size() || !parsePosix(tz, zone)) return -1;
+    zones.push_back(zone);
+    return static_cast<int>(zones.size() - 1);
+  }
+
+  // 穴のない多角形を、形が toleranceM より変わらない範囲で間引いて加える
+  bool addPolygon(int zone, const std::vector<Point> &points, double toleranceM) {
+    if (zone < 0 || zones.size() <= static_cast<size_t>(zone) || points.size() < 3 ||
+        TzFormat::FULL <= rings.size()) {
+      return false;
+    }
+    Ring ring;
+    ring.zone = static_cast<uint16_t>(zone);
+    for (const Point &point : simplify(points, toleranceM)) {
+      const TzFormat::Vertex vertex = {toE7(point.lat), toE7(point.lon)};
+      ring.vertices.push_back(vertex);
+    }
+    rings.push_back(ring);
+    inputVertices += points.size();
+    return true;
+  }
+
+  size_t getZoneCount() const {
+    return zones.size();
+  }
+
+  size_t getPolygonCount() const {
+    return rings.size();
+  }
+
+  size_t getInputVertexCount() const {
+    return inputVertices;
+  }
+
+  size_t getVertexCount() const {
+    size_t count = 0;
+    for (const Ring &ring : rings) count += ring.vertices.size();
+    return count;
+  }
+
+  // cellDeg 四方のセルに分ける
+  std::vector<uint8_t> build(double cellDeg) const {
+    TzFormat::Header header = TzFormat::Header();
+    header.magic            = TzFormat::MAGIC;
+    header.zoneCount        = static_cast<uint16_t>(zones.size());
+    header.polygonCount     = static_cast<uint16_t>(rings.size());
+    header.vertexCount      = static_cast<uint32_t>(getVertexCount());
+    layout(header, cellDeg);
+
+    const size_t                       cells = static_cast<size_t>(header.rows) * header.cols;
+    std::vector<std::vector<uint16_t>> candidates(cells);
+    std::vector<int>                   fullZone(cells, -1);
+    for (size_t i = 0; i < rings.size(); i++) addToCells(header, i, candidates, fullZone);
+
+    std::vector<uint32_t> cellStart(cells + 1, 0);
+    std::vector<uint16_t> flat;
+    for (size_t i = 0; i < cells; i++) {
+      cellStart[i] = static_cast<uint32_t>(flat.size());
+      flat.insert(flat.end(), candidates[i].begin(), candidates[i].end());
+      if (0 <= fullZone[i]) flat.push_back(static_cast<uint16_t>(TzFormat::FULL | fullZone[i]));
+    }
+    cellStart[cells]      = static_cast<uint32_t>(flat.size());
+    header.candidateCount = static_cast<uint32_t>(flat.size());
+
+    std::vector<uint8_t> out;
+    put32(out, header.magic);
+    put16(out, header.zoneCount);
+    put16(out, header.polygonCount);
+    put32(out, header.vertexCount);
+    put32(out, header.candidateCount);
+    put32(out, header.originLatE7);
+    put32(out, header.originLonE7);
+    put32(out, header.cellLatE7);
+    put32(out, header.cellLonE7);
+    put16(out, header.rows);
+    put16(out, header.cols);
+    put32(out, header.reserved);
+    for (const TzFormat::Zone &zone : zones) {
+      put16(out, zone.stdOffsetMin);
+      put16(out, zone.dstSaveMin);
+      putRule(out, zone.start);
+      putRule(out, zone.end);
+    }
+
+    uint32_t first = 0;
+    for (const Ring &ring : rings) {
+      int32_t latMin;
+      int32_t latMax;
+      int32_t lonMin;
+      int32_t lonMax;
+      bounds(ring, latMin, latMax, lonMin, lonMax);
+      put16(out, ring.zone);
+      put16(out, 0);
+      put32(out, first);
+      put32(out, static_cast<uint32_t>(ring.vertices.size()));
+      put32(out, latMin);
+      put32(out, latMax);
+      put32(out, lonMin);
+      put32(out, lonMax);
+      first += static_cast<uint32_t>(ring.vertices.size());
+    }
+    for (const Ring &ring : rings) {
+      for (const TzFormat::Vertex &vertex : ring.vertices) {
+        put32(out, vertex.latE7);
+        put32(out, vertex.lonE7);
+      }
+    }
+    for (uint32_t start : cellStart) put32(out, start);
+    for (uint16_t candidate : flat) put16(out, candidate);
+    return out;
+  }
+
+  // 標準時の名前 + 差 [+ 夏時間の名前 [差] ,開始,終了]。規則は Mm.w.d[/時刻] だけを受け付ける。
+  // POSIX の差は西が正なので、符号を反転して東を正にする
+  static bool parsePosix(const std::string &tz, TzFormat::Zone &zone) {
+    zone      = TzFormat::Zone();
+    size_t at = 0;
+    int    offsetMin;
+    if (!skipName(tz, at) || !parseTime(tz, at, offsetMin)) return false;
+    zone.stdOffsetMin = static_cast<int16_t>(-offsetMin);
+    if (at == tz.size()) return true;
+
+    if (!skipName(tz, at)) return false;
+    int dstOffsetMin = offsetMin - 60;
+    if (at < tz.size() && tz[at] != ',' && !parseTime(tz, at, dstOffsetMin)) return false;
+    zone.dstSaveMin = static_cast<int16_t>(offsetMin - dstOffsetMin);
+    return zone.dstSaveMin != 0 && parseRule(tz, at, zone.start) &&
+           parseRule(tz, at, zone.end) && at == tz.size();
+  }
+
+  // 閉じた多角形を Douglas-Peucker で間引く。距離はその多角形の平均の緯度で平面に近似して測る
+  static std::vector<Point> simplify(const std::vector<Point> &points, double toleranceM) {
+    const size_t n = points.size();
+    if (n <= 3 || toleranceM <= 0.0) return points;
+
+    double meanLat = 0.0;
+    for (const Point &point : points) meanLat += point.lat;
+    const double kLon = M_PER_DEG * cos(meanLat / n * PI / 180.0);
+
+    // 最初の点から最も遠い点で 2 つに分け、両側をそれぞれ間引く
+    size_t far  = 0;
+    double best = -1.0;
+    for (size_t i = 1; i < n; i++) {
+      const double d = distanceM(points[0], points[i], points[0], kLon);
+      if (best < d) {
+        best = d;
+        far  = i;
+      }
+    }
+
+    std::vector<bool>                      keep(n + 1, false);
+    std::vector<std::pair<size_t, size_t>> stack = {{0, far}, {far, n}};
+    keep[0]   = true;
+    keep[far] = true;
+    while (!stack.empty()) {
+      const size_t a = stack.back().first;
+      const size_t b = stack.back().second;
+      stack.pop_back();
+
+      size_t worst = a;
+      double max   = toleranceM;
+      for (size_t i = a + 1; i < b; i++) {
+        const double d = distanceM(points[i], points[a], points[b % n], kLon);
+        if (max < d) {
+          max   = d;
+          worst = i;
+        }
+      }
+      if (worst == a) continue;
+      keep[worst] = true;
+      stack.push_back(std::make_pair(a, worst));
+      stack.push_back(std::make_pair(worst, b));
+    }
+
+    std::vector<Point> out;
+    for (size_t i = 0; i < n; i++) {
+      if (keep[i]) out.push_back(points[i]);
+    }
+    return 3 <= out.size() ? out : points;
+  }
+
+private:
+  void layout(TzFormat::Header &header, double cellDeg) const {
+    header.rows      = 1;
+    header.cols      = 1;
+    header.cellLatE7 = toE7(cellDeg);
+    header.cellLonE7 = header.cellLatE7;
+    if (rings.empty()) return;
+
+    int32_t latMin = rings[0].vertices[0].latE7;
+    int32_t latMax = latMin;
+    int32_t lonMin = rings[0].vertices[0].lonE7;
+    int32_t lonMax = lonMin;
+    for (const Ring &ring : rings) {
+      int32_t a;
+      int32_t b;
+      int32_t c;
+      int32_t d;
+      bounds(ring, a, b, c, d);
+      if (a < latMin) latMin = a;
+      if (latMax < b) latMax = b;
+      if (c < lonMin) lonMin = c;
+      if (lonMax < d) lonMax = d;
+    }
+    header.originLatE7 = latMin;
+    header.originLonE7 = lonMin;
+    header.rows        = static_cast<uint16_t>((latMax - latMin) / header.cellLatE7 + 1);
+    header.cols        = static_cast<uint16_t>(
+        (static_cast<int64_t>(lonMax) - lonMin) / header.cellLonE7 + 1);
+  }
+
+  // 境界が通るセルには多角形の番号を、境界が通らずに中心が内側にあるセルには時間帯を入れる
+  void addToCells(const TzFormat::Header &header, size_t index,
+                  std::vector<std::vector<uint16_t>> &candidates,
+                  std::vector<int>                   &fullZone) const {
+    const Ring &ring = rings[index];
+    int32_t     latMin;
+    int32_t     latMax;
+    int32_t     lonMin;
+    int32_t     lonMax;
+    bounds(ring, latMin, latMax, lonMin, lonMax);
+    const int row0 = (latMin - header.originLatE7) / header.cellLatE7;
+    const int row1 = (latMax - header.originLatE7) / header.cellLatE7;
+    const int col0 = static_cast<int>((static_cast<int64_t>(lonMin) - header.originLonE7) /
+                                      header.cellLonE7);
+    const int col1 = static_cast<int>((static_cast<int64_t>(lonMax) - header.originLonE7) /
+                                      header.cellLonE7);
+
+    for (int row = row0; row <= row1; row++) {
+      for (int col = col0; col <= col1; col++) {
+        const double south = header.originLatE7 + static_cast<double>(row) * header.cellLatE7;
+        const double west  = header.originLonE7 + static_cast<double>(col) * header.cellLonE7;
+        const double north = south + header.cellLatE7;
+        const double east  = west + header.cellLonE7;
+        const size_t cell  = static_cast<size_t>(row) * header.cols + col;
+        if (crossesBox(ring, south, west, north, east)) {
+          candidates[cell].push_back(static_cast<uint16_t>(index));
+        } else if (fullZone[cell] < 0 &&
+                   contains(ring, (south + north) / 2.0, (west + east) / 2.0)) {
+          fullZone[cell] = ring.zone;
+        }
+      }
+    }
+  }
+
+  static bool crossesBox(const Ring &ring, double south, double west, double north,
+                         double east) {
+    const size_t n = ring.vertices.size();
+    for (size_t i = 0; i < n; i++) {
+      const TzFormat::Vertex &a = ring.vertices[i];
+      const TzFormat::Vertex &b = ring.vertices[(i + 1) % n];
+      if (clips(a.lonE7, a.latE7, b.lonE7, b.latE7, west, south, east, north)) return true;
+    }
+    return false;
+  }
+
+  // 線分が矩形と交わるか (Liang-Barsky)
+  static bool clips(double x0, double y0, double x1, double y1, double left, double bottom,
+                    double right, double top) {
+    const double dx   = x1 - x0;
+    const double dy   = y1 - y0;
+    const double p[4] = {-dx, dx, -dy, dy};
+    const double q[4] = {x0 - left, right - x0, y0 - bottom, top - y0};
+    double       t0   = 0.0;
+    double       t1   = 1.0;
+    for (int k = 0; k < 4; k++) {
+      if (p[k] == 0.0) {
+        if (q[k] < 0.0) return false;
+        continue;
+      }
+      const double r = q[k] / p[k];
+      if (p[k] < 0.0) {
+        if (t1 < r) return false;
+        if (t0 < r) t0 = r;
+      } else {
+        if (r < t0) return false;
+        if (r < t1) t1 = r;
+      }
+    }
+    return true;
+  }
+
+  static bool contains(const Ring &ring, double latE7, double lonE7) {
+    bool         inside = false;
+    const size_t n      = ring.vertices.size();
+    for (size_t i = 0, j = n - 1; i < n; j = i++) {
+      const TzFormat::Vertex &a = ring.vertices[i];
+      const TzFormat::Vertex &b = ring.vertices[j];
+      if ((latE7 < a.latE7) == (latE7 < b.latE7)) continue;
+      const double dLon = static_cast<double>(a.lonE7) - b.lonE7;
+      const double lon  = b.lonE7 + (latE7 - b.latE7) * dLon / (a.latE7 - b.latE7);
+      if (lonE7 < lon) inside = !inside;
+    }
+    return inside;
+  }
+
+  static void bounds(const Ring &ring, int32_t &latMin, int32_t &latMax, int32_t &lonMin,
+                     int32_t &lonMax) {
+    latMin = latMax = ring.vertices[0].latE7;
+    lonMin = lonMax = ring.vertices[0].lonE7;
+    for (const TzFormat::Vertex &vertex : ring.vertices) {
+      if (vertex.latE7 < latMin) latMin = vertex.latE7;
+      if (latMax < vertex.latE7) latMax = vertex.latE7;
+      if (vertex.lonE7 < lonMin) lonMin = vertex.lonE7;
+      if (lonMax < vertex.lonE7) lonMax = vertex.lonE7;
+    }
+  }
+
+  // p から線分 ab までの距離 [m]
+  static double distanceM(const Point &p, const Point &a, const Point &b, double kLon) {
+    const double px = (p.lon - a.lon) * kLon;
+    const double py = (p.lat - a.lat) * M_PER_DEG;
+    const double bx = (b.lon - a.lon) * kLon;
+    const double by = (b.lat - a.lat) * M_PER_DEG;
+    const double l2 = bx * bx + by * by;
+    double       t  = l2 == 0.0 ? 0.0 : (px * bx + py * by) / l2;
+    if (t < 0.0) t = 0.0;
+    if (1.0 < t) t = 1.0;
+    return hypot(px - t * bx, py - t * by);
+  }
+
+  // "<+0545>" のような山括弧の名前か、3 文字以上の英字の名前
+  static bool skipName(const std::string &tz, size_t &at) {
+    if (at < tz.size() && tz[at] == '<') {
+      const size_t close = tz.find('>', at);
+      if (close == std::string::npos) return false;
+      at = close + 1;
+      return true;
+    }
+    const size_t start = at;
+    while (at < tz.size() && isalpha(static_cast<unsigned char>(tz[at]))) at++;
+    return 3 <= at - start;
+  }
+
+  // [+-]h[h][:mm[:ss]] を分にする。秒は切り捨てる
+  static bool parseTime(const std::string &tz, size_t &at, int &minutes) {
+    int sign = 1;
+    if (at < tz.size() && (tz[at] == '+' || tz[at] == '-')) sign = tz[at++] == '-' ? -1 : 1;
+    int parts[3] = {0, 0, 0};
+    for (int i = 0; i < 3; i++) {
+      if (i != 0 && (tz.size() <= at || tz[at] != ':')) break;
+      if (i != 0) at++;
+      const size_t start = at;
+      while (at < tz.size() && isdigit(static_cast<unsigned char>(tz[at]))) {
+        parts[i] = parts[i] * 10 + (tz[at++] - '0');
+      }
+      const size_t digits = at - start;
+      if (digits == 0 || (i == 0 ? 3u : 2u) < digits) return false;
+    }
+    if (167 < parts[0] || 59 < parts[1] || 59 < parts[2]) return false;
+    minutes = sign * (parts[0] * 60 + parts[1]);
+    return true;
+  }
+
+  // ,Mm.w.d[/時刻]。時刻を省くと 02:00
+  static bool parseRule(const std::string &tz, size_t &at, TzFormat::Rule &rule) {
+    if (tz.compare(at, 2, ",M") != 0) return false;
+    at += 2;
+    char       *end;
+    const char *text  = tz.c_str();
+    const long  month = strtol(text + at, &end, 10);
+    if (*end != '.') return false;
+    const long week = strtol(end + 1, &end, 10);
+    if (*end != '.') return false;
+    const long weekday = strtol(end + 1, &end, 10);
+    at                 = static_cast<size_t>(end - text);
+    if (month < 1 || 12 < month || week < 1 || 5 < week || weekday < 0 || 6 < weekday) {
+      return false;
+    }
+
+    int minute = 120;
+    if (at < tz.size() && tz[at] == '/' && !parseTime(tz, ++at, minute)) return false;
+    rule         = TzFormat::Rule();
+    rule.month   = static_cast<uint8_t>(month);
+    rule.week    = static_cast<uint8_t>(week);
+    rule.weekday = static_cast<uint8_t>(weekday);
+    rule.minute  = static_cast<int16_t>(minute);
+    return true;
+  }
+
+  static int32_t toE7(double degrees) {
+    return static_cast<int32_t>(lround(degrees * 1e7));
+  }
+
+  static void putRule(std::vector<uint8_t> &out, const TzFormat::Rule &rule) {
+    out.push_back(rule.month);
+    out.push_back(rule.week);
+    out.push_back(rule.weekday);
+    out.push_back(0);
+    put16(out, static_cast<uint16_t>(rule.minute));
+  }
+
+  static void put16(std::vector<uint8_t> &out, uint16_t value) {
+    out.push_back(static_cast<uint8_t>(value));
+    out.push_back(static_cast<uint8_t>(value >> 8));
+  }
+
+  static void put32(std::vector<uint8_t> &out, uint32_t value) {
+    for (int shift = 0; shift < 32; shift += 8) out.push_back(static_cast<uint8_t>(value >> shift));
+  }
+};
@@ -0,0 +1,105 @@
+// 時間帯の境界から TimeZoneIndex のファイルを作る
+//   build_tz_index zones.txt tz.bin [許容誤差 m (500)] [セルの大きさ 度 (1.0)]
+// "zone <名前> <POSIX の TZ 文字列>" で時間帯を、"ring" でその時間帯の多角形を始める。
+// 多角形の頂点は 1 行に 1 点で "緯度,経度"。名前は読み飛ばす。空行と '#' で始まる行も読み飛ばす
+//   zone Europe/Berlin CET-1CEST,M3.5.0,M10.5.0/3
+//   ring
+//   47.27,5.87
+//   ...
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "TimeZoneIndexBuilder.h"
+
+namespace {
+
+bool parsePoint(const std::string &line, TimeZoneIndexBuilder::Point &point) {
+  std::istringstream in(line);
+  std::string        latText;
+  std::string        lonText;
+  if (!std::getline(in, latText, ',') || !std::getline(in, lonText, ',')) return false;
+
+  char *end = nullptr;
+  point.lat = strtod(latText.c_str(), &end);
+  if (*end != '\0' || point.lat < -90.0 || 90.0 < point.lat) return false;
+  point.lon = strtod(lonText.c_str(), &end);
+  return *end == '\0' && -180.0 <= point.lon && point.lon <= 180.0;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  if (argc < 3 || 5 < argc) {
+    std::cerr << "usage: " << argv[0] << " <zones.txt> <tz.bin> [tolerance m] [cell deg]"
+              << std::endl;
+    return 2;
+  }
+  const double toleranceM = 4 <= argc ? atof(argv[3]) : 500.0;
+  const double cellDeg    = 5 <= argc ? atof(argv[4]) : 1.0;
+  if (toleranceM < 0.0 || cellDeg < 0.01 || 90.0 < cellDeg) {
+    std::cerr << "invalid tolerance or cell size" << std::endl;
+    return 2;
+  }
+
+  std::ifstream in(argv[1]);
+  if (!in) {
+    std::cerr << "cannot open " << argv[1] << std::endl;
+    return 1;
+  }
+
+  // 多角形は次の "ring" か "zone" の行、またはファイルの終わりで閉じる
+  TimeZoneIndexBuilder                     builder;
+  int                                      zone = -1;
+  std::vector<TimeZoneIndexBuilder::Point> ring;
+  bool                                     isOk = true;
+
+  auto flush = [&]() {
+    if (!ring.empty() && !builder.addPolygon(zone, ring, toleranceM)) isOk = false;
+    ring.clear();
+  };
+
+  std::string line;
+  for (int lineNo = 1; isOk && std::getline(in, line); lineNo++) {
+    if (!line.empty() && line.back() == '\r') line.pop_back();
+    if (line.empty() || line[0] == '#') continue;
+
+    std::istringstream words(line);
+    std::string        word;
+    words >> word;
+    if (word == "zone") {
+      flush();
+      std::string name;
+      std::string tz;
+      words >> name >> tz;
+      zone = builder.addZone(tz);
+      isOk = isOk && 0 <= zone;
+    } else if (word == "ring") {
+      flush();
+      isOk = 0 <= zone;
+    } else {
+      TimeZoneIndexBuilder::Point point;
+      isOk = parsePoint(line, point);
+      ring.push_back(point);
+    }
+    if (!isOk) std::cerr << argv[1] << ":" << lineNo << ": invalid line" << std::endl;
+  }
+  flush();
+  if (!isOk) return 1;
+
+  const std::vector<uint8_t> image = builder.build(cellDeg);
+  std::ofstream              out(argv[2], std::ios::binary);
+  out.write(reinterpret_cast<const char *>(image.data()), image.size());
+  if (!out) {
+    std::cerr << "cannot write " << argv[2] << std::endl;
+    return 1;
+  }
+
+  std::cout << builder.getZoneCount() << " zones, " << builder.getPolygonCount() << " polygons, "
+            << builder.getVertexCount() << " of " << builder.getInputVertexCount()
+            << " vertices, " << image.size() << " bytes" << std::endl;
+  return 0;
+}